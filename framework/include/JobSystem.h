@@ -0,0 +1,74 @@
+#ifndef __JOB_SYSTEM_H_
+#define __JOB_SYSTEM_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// a pool of worker threads that run jobs split in to chunks. every thread has its
+// own queue of chunks, a thread that runs out of work steals from the other queues
+class JobSystem
+{
+public:
+
+	// job for a range of items [a_begin, a_end), given the index of the thread running it
+	// so that it can use per thread scratch memory. thread 0 is the thread that called parallelFor
+	typedef std::function<void(unsigned int a_begin, unsigned int a_end, unsigned int a_threadIndex)> RangeJob;
+
+	// a_workerCount of 0 uses one worker for each hardware thread other than the calling thread
+	static JobSystem* Create(unsigned int a_workerCount = 0);
+	static void Destroy();
+
+	static JobSystem* Get();
+
+	// number of threads that run jobs, including the thread that calls parallelFor
+	unsigned int getThreadCount() const { return (unsigned int)m_queues.size(); }
+
+	// splits [0, a_count) in to chunks of a_chunkSize and runs them across every thread,
+	// returns once every chunk is done. chunk boundaries only depend on a_count and
+	// a_chunkSize so jobs that write to their own range give the same results on any
+	// number of threads. must only be called from the thread that created the job system
+	void parallelFor(unsigned int a_count, unsigned int a_chunkSize, const RangeJob& a_job);
+
+protected:
+	JobSystem(unsigned int a_workerCount);
+	~JobSystem();
+
+private:
+
+	struct Task
+	{
+		const RangeJob*				job;
+		unsigned int				begin;
+		unsigned int				end;
+		std::atomic<unsigned int>*	remaining;
+	};
+
+	// owners take from the front of their queue and thieves take from the back
+	struct TaskQueue
+	{
+		std::mutex			mutex;
+		std::deque<Task>	tasks;
+	};
+
+	void workerLoop(unsigned int a_threadIndex);
+	bool takeTask(unsigned int a_threadIndex, Task& a_task);
+	void runTask(const Task& a_task, unsigned int a_threadIndex);
+
+	std::vector<TaskQueue>		m_queues;
+	std::vector<std::thread>	m_workers;
+
+	// sleeping workers are woken when tasks are queued or the system is destroyed
+	std::mutex					m_wakeMutex;
+	std::condition_variable		m_wakeCondition;
+	std::atomic<unsigned int>	m_queuedTasks;
+	bool						m_quit;
+
+	static JobSystem* m_instance;
+};
+
+#endif // __JOB_SYSTEM_H_
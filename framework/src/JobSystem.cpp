@@ -0,0 +1,184 @@
+#include "JobSystem.h"
+
+JobSystem* JobSystem::m_instance = nullptr;
+
+JobSystem* JobSystem::Create(unsigned int a_workerCount)
+{
+	if (m_instance == nullptr)
+	{
+		if (a_workerCount == 0)
+		{
+			unsigned int hardwareThreads = std::thread::hardware_concurrency();
+			a_workerCount = (hardwareThreads > 1) ? hardwareThreads - 1 : 0;
+		}
+		m_instance = new JobSystem(a_workerCount);
+	}
+	return m_instance;
+}
+
+JobSystem* JobSystem::Get()
+{
+	return m_instance;
+}
+
+void JobSystem::Destroy()
+{
+	if (m_instance != nullptr)
+	{
+		delete m_instance;
+		m_instance = nullptr;
+	}
+}
+
+JobSystem::JobSystem(unsigned int a_workerCount) : m_queues(a_workerCount + 1), m_queuedTasks(0), m_quit(false)
+{
+	// queue 0 belongs to the thread that calls parallelFor, workers start from 1
+	for (unsigned int i = 1; i <= a_workerCount; ++i)
+	{
+		m_workers.push_back(std::thread(&JobSystem::workerLoop, this, i));
+	}
+}
+
+JobSystem::~JobSystem()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+		m_quit = true;
+	}
+	m_wakeCondition.notify_all();
+
+	for (std::thread& worker : m_workers)
+	{
+		worker.join();
+	}
+}
+
+void JobSystem::parallelFor(unsigned int a_count, unsigned int a_chunkSize, const RangeJob& a_job)
+{
+	if (a_count == 0)
+	{
+		return;
+	}
+	if (a_chunkSize == 0)
+	{
+		a_chunkSize = 1;
+	}
+
+	const unsigned int chunkCount = (a_count + a_chunkSize - 1) / a_chunkSize;
+	const unsigned int threadCount = getThreadCount();
+
+	// nothing to share out so run it here
+	if (chunkCount == 1 || threadCount == 1)
+	{
+		a_job(0, a_count, 0);
+		return;
+	}
+
+	// give each thread a run of neighbouring chunks so that threads which don't
+	// need to steal work through the items in order
+	std::atomic<unsigned int> remaining(chunkCount);
+	for (unsigned int thread = 0; thread < threadCount; ++thread)
+	{
+		const unsigned int firstChunk = (unsigned int)(((unsigned long long)chunkCount * thread) / threadCount);
+		const unsigned int lastChunk = (unsigned int)(((unsigned long long)chunkCount * (thread + 1)) / threadCount);
+
+		// count the tasks while holding the queue lock so no thread can take
+		// one and drop the count before it has been added
+		std::lock_guard<std::mutex> lock(m_queues[thread].mutex);
+		m_queuedTasks += lastChunk - firstChunk;
+		for (unsigned int chunk = firstChunk; chunk < lastChunk; ++chunk)
+		{
+			Task task;
+			task.job = &a_job;
+			task.begin = chunk * a_chunkSize;
+			task.end = (chunk == chunkCount - 1) ? a_count : task.begin + a_chunkSize;
+			task.remaining = &remaining;
+			m_queues[thread].tasks.push_back(task);
+		}
+	}
+
+	// take the wake lock before notifying so that a worker which saw no tasks
+	// is already waiting and can't miss the wake up
+	{
+		std::lock_guard<std::mutex> lock(m_wakeMutex);
+	}
+	m_wakeCondition.notify_all();
+
+	// help out until every chunk has finished, chunks still running on other
+	// threads are waited on by yielding
+	while (remaining.load() > 0)
+	{
+		Task task;
+		if (takeTask(0, task))
+		{
+			runTask(task, 0);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+void JobSystem::workerLoop(unsigned int a_threadIndex)
+{
+	while (true)
+	{
+		Task task;
+		if (takeTask(a_threadIndex, task))
+		{
+			runTask(task, a_threadIndex);
+			continue;
+		}
+
+		// out of work, sleep until more is queued
+		std::unique_lock<std::mutex> lock(m_wakeMutex);
+		m_wakeCondition.wait(lock, [this]() { return m_quit || m_queuedTasks.load() > 0; });
+		if (m_quit)
+		{
+			return;
+		}
+	}
+}
+
+bool JobSystem::takeTask(unsigned int a_threadIndex, Task& a_task)
+{
+	// our own queue first
+	{
+		TaskQueue& queue = m_queues[a_threadIndex];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty())
+		{
+			a_task = queue.tasks.front();
+			queue.tasks.pop_front();
+			--m_queuedTasks;
+			return true;
+		}
+	}
+
+	// then steal from the end of everyone else's, starting with the next thread
+	// along so that thieves spread out over the queues
+	const unsigned int threadCount = getThreadCount();
+	for (unsigned int i = 1; i < threadCount; ++i)
+	{
+		TaskQueue& queue = m_queues[(a_threadIndex + i) % threadCount];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (!queue.tasks.empty())
+		{
+			a_task = queue.tasks.back();
+			queue.tasks.pop_back();
+			--m_queuedTasks;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void JobSystem::runTask(const Task& a_task, unsigned int a_threadIndex)
+{
+	(*a_task.job)(a_task.begin, a_task.end, a_threadIndex);
+
+	// the thread waiting on the job reads the results once this reaches zero
+	a_task.remaining->fetch_sub(1);
+}
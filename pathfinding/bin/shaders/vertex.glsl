@@ -4,6 +4,13 @@ in vec4 Position;
 in vec4 Normal;
 in vec4 Colour;
 in vec2 Tex1;
+//Next keyframe, only read when the shader interpolates the frames
+in vec4 NextPosition;
+in vec4 NextNormal;
+//Frames each instance draws (current, next, interpolation) and where it is
+//placed, only read when the shader samples the animation textures
+in vec3 InstanceFrames;
+in vec3 InstanceOffset;
 
 
 out vec4 vNormal;
@@ -17,16 +24,98 @@ uniform vec4 lightDirection;
 uniform mat4 ProjectionView; 
 uniform mat4 Model;
 
+//How the normal attribute is packed, matches MD2_NORMAL_FORMAT
+uniform int NormalFormat;
+uniform float NormalInterp;
+uniform vec3 NormalTable[162];
+
+//Set when Position and Normal are the current keyframe and NextPosition and
+//NextNormal the next keyframe, the shader then interpolates between them
+uniform int InterpolateFrames;
+uniform float FrameInterp;
+
+//Set when every keyframe is baked in to textures with one row per frame and
+//one column per vertex, the vertex index picks the column
+uniform int SampleAnimationTextures;
+uniform sampler2D PositionTexture;
+uniform usampler2D NormalIndexTexture;
+
+//Unfolds an octahedral encoded normal, the lower half of the sphere is folded over the upper half
+vec3 UnpackOctahedral(vec2 packedNormal)
+{
+	vec2 e = clamp(packedNormal / 32767.0, -1.0, 1.0);
+	vec3 normal = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+	if (normal.z < 0.0) {
+		normal.xy = (1.0 - abs(normal.yx)) * vec2(normal.x >= 0.0 ? 1.0 : -1.0, normal.y >= 0.0 ? 1.0 : -1.0);
+	}
+	return normalize(normal);
+}
+
+//Unpacks the normal of a single keyframe
+vec3 UnpackKeyframeNormal(vec4 packedNormal)
+{
+	if (NormalFormat == 1) {
+		return NormalTable[int(packedNormal.x)];
+	}
+	if (NormalFormat == 2) {
+		return UnpackOctahedral(packedNormal.xy);
+	}
+	return packedNormal.xyz;
+}
+
+//Interpolates between two unit normals, opposite normals half way between
+//frames have no direction so keep the current one
+vec3 MixNormals(vec3 currentNormal, vec3 nextNormal, float interp)
+{
+	vec3 normal = mix(currentNormal, nextNormal, interp);
+	float lengthSquared = dot(normal, normal);
+	return lengthSquared > 1e-6 ? normal * inversesqrt(lengthSquared) : currentNormal;
+}
+
+//Unpacks the normal attribute in to a unit normal
+vec3 UnpackNormal()
+{
+	//Normal index in the current and next frame
+	if (NormalFormat == 1) {
+		return MixNormals(NormalTable[int(Normal.x)], NormalTable[int(Normal.y)], NormalInterp);
+	}
+
+	//Octahedral encoding
+	if (NormalFormat == 2) {
+		return UnpackOctahedral(Normal.xy);
+	}
+
+	return Normal.xyz;
+}
+
 
 void main() 
 { 
+	vec4 position = Position;
+	vec3 normal;
+	vec3 offset = vec3(0.0);
+	if (SampleAnimationTextures == 1) {
+		ivec2 currentTexel = ivec2(gl_VertexID, int(InstanceFrames.x));
+		ivec2 nextTexel = ivec2(gl_VertexID, int(InstanceFrames.y));
+		position = vec4(mix(texelFetch(PositionTexture, currentTexel, 0).xyz, texelFetch(PositionTexture, nextTexel, 0).xyz, InstanceFrames.z), 1.0);
+		normal = MixNormals(NormalTable[int(texelFetch(NormalIndexTexture, currentTexel, 0).r)], NormalTable[int(texelFetch(NormalIndexTexture, nextTexel, 0).r)], InstanceFrames.z);
+		offset = InstanceOffset;
+	}
+	else if (InterpolateFrames == 1) {
+		position = vec4(mix(Position.xyz, NextPosition.xyz, FrameInterp), 1.0);
+		normal = MixNormals(UnpackKeyframeNormal(Normal), UnpackKeyframeNormal(NextNormal), FrameInterp);
+	}
+	else {
+		normal = UnpackNormal();
+	}
+
 	//send outputs from vertex shader to fragment shader
-	vNormal = Normal;
+	vNormal = Model * vec4(normal, 0.0);
 	vColour = Colour;
 	vUV = Tex1;
 
 	vLightDir = lightDirection;
 
-	gl_Position = ProjectionView * Model * Position;
+	gl_Position = ProjectionView * ((Model * position) + vec4(offset, 0.0));
 
 }
\ No newline at end of file
@@ -0,0 +1,54 @@
+#ifndef __FLOW_FIELD_H__
+#define __FLOW_FIELD_H__
+
+//C Includes
+#include <vector>
+
+//Forward Declerations
+struct Position;
+
+/// <summary>
+/// Distance from every tile of a grid to the nearest of a set of goals, and
+/// the direction to step from each tile to get a tile closer. Built with one
+/// breadth first search out from the goals, so any number of agents heading
+/// to the same goals can find their next tile by reading their own tile
+/// </summary>
+class FlowField
+{
+public:
+	//Direction of tiles that are a goal or can't reach one
+	static const unsigned char NO_DIRECTION = 4;
+
+	FlowField();
+
+	bool Build(const bool* a_pWalls, unsigned int a_iWidth, unsigned int a_iHeight, const Position* a_pGoals, unsigned int a_iNumGoals);
+	void Clear();
+
+	bool GetNextTile(const Position& a_tile, Position& a_outNextTile) const;
+	int GetDistance(const Position& a_tile) const;
+	unsigned char GetDirection(const Position& a_tile) const;
+
+	//Getters
+	bool IsBuilt() const { return !m_distances.empty(); }
+	unsigned int GetWidth() const { return m_iWidth; }
+	unsigned int GetHeight() const { return m_iHeight; }
+	unsigned int GetNumTilesReached() const { return m_iNumTilesReached; }
+
+private:
+	bool IsInside(const Position& a_tile) const;
+
+	unsigned int m_iWidth;
+	unsigned int m_iHeight;
+
+	//Integration field, the distance to the nearest goal or -1 if none can
+	//be reached, and the direction (+x, -x, +y, -y) to step from each tile
+	std::vector<int> m_distances;
+	std::vector<unsigned char> m_directions;
+
+	//Tiles waiting to be visited by Build, kept to save reallocating
+	std::vector<unsigned int> m_queue;
+
+	unsigned int m_iNumTilesReached;
+};
+
+#endif // !__FLOW_FIELD_H__
@@ -0,0 +1,63 @@
+#ifndef __FLOW_FIELD_CACHE_H__
+#define __FLOW_FIELD_CACHE_H__
+
+//C Includes
+#include <unordered_map>
+#include <vector>
+
+//Project Includes
+#include "FlowField.h"
+
+/// <summary>
+/// Least recently used cache of flow fields, one for each goal tile. A field
+/// is built the first time its goal is asked for and kept until the walls
+/// change or it is the least recently used field when a new goal needs a slot.
+/// Slots are reused, so a field from Acquire is only valid until the next
+/// Acquire of a goal that isn't cached. Find looks a field up without
+/// building it or changing the order of use, for agents following a field
+/// every step
+/// </summary>
+class FlowFieldCache
+{
+public:
+	FlowFieldCache(unsigned int a_iNumSlots = 4);
+
+	void SetGrid(const bool* a_pWalls, unsigned int a_iWidth, unsigned int a_iHeight);
+	void Clear();
+
+	const FlowField* Acquire(const Position& a_goal, bool& a_bOutBuilt);
+	const FlowField* Find(const Position& a_goal) const;
+	void ResetCounters();
+
+	//Getters
+	unsigned int GetNumSlots() const { return (unsigned int)m_fields.size(); }
+	unsigned long long GetNumHits() const { return m_iNumHits; }
+	unsigned long long GetNumMisses() const { return m_iNumMisses; }
+
+private:
+	void MoveToFront(const int a_iSlot);
+
+	//Grid the fields are built over, the walls are owned by the caller
+	const bool* m_pWalls;
+	unsigned int m_iWidth;
+	unsigned int m_iHeight;
+
+	std::vector<FlowField> m_fields;
+
+	//Slot each goal tile is held in and the goal tile held in each slot, -1
+	//if none
+	std::unordered_map<unsigned int, int> m_goalSlots;
+	std::vector<int> m_slotGoals;
+
+	//Slots in order of use, from the most recently used at the head to the
+	//least recently used at the tail
+	std::vector<int> m_slotPrev;
+	std::vector<int> m_slotNext;
+	int m_iHead;
+	int m_iTail;
+
+	unsigned long long m_iNumHits;
+	unsigned long long m_iNumMisses;
+};
+
+#endif // !__FLOW_FIELD_CACHE_H__
@@ -0,0 +1,118 @@
+#ifndef __GRID_SEARCH_H__
+#define __GRID_SEARCH_H__
+
+//C Includes
+#include <vector>
+
+//Forward Declerations
+struct Position;
+
+//Estimate of the distance left to the end of a search, every heuristic
+//never overestimates the distance so A* finds the shortest path
+typedef enum {
+	GRID_HEURISTIC_NONE,		//No estimate, the search is Dijkstra's algorithm
+	GRID_HEURISTIC_MANHATTAN,	//dx + dy, exact on an open grid
+	GRID_HEURISTIC_OCTILE,		//max(dx, dy) + (sqrt(2) - 1) * min(dx, dy)
+	GRID_HEURISTIC_EUCLIDEAN,	//sqrt(dx * dx + dy * dy)
+
+	GRID_HEURISTIC_COUNT /*Total number of heuristics*/
+} GRID_HEURISTIC;
+
+/// <summary>
+/// Shortest path search over a grid of tiles that can be walked between
+/// horizontally and vertically. Every node's distance, parent and place in the
+/// open heap live in flat width * height arrays that are kept between searches.
+/// Each search stamps the nodes it touches with a new generation, so nothing
+/// has to be cleared before the next search. The open list is a binary heap
+/// indexed by node so a node's priority can be lowered in place.
+/// With a heuristic the search is A*, a weight above 1 makes it weighted A*
+/// which expands fewer nodes and finds a path at most weight times too long.
+/// FindJumpPath is Jump Point Search, it only puts tiles where a shortest path
+/// has to turn on the heap and jumps over the rest using a table of jump
+/// distances that is built once for each set of walls
+/// </summary>
+class GridSearch
+{
+public:
+	GridSearch();
+
+	void SetGrid(const bool* a_pWalls, unsigned int a_iWidth, unsigned int a_iHeight);
+	bool FindPath(const Position& a_start, const Position& a_end, std::vector<Position>& a_finalPath,
+		GRID_HEURISTIC a_eHeuristic = GRID_HEURISTIC_NONE, float a_fWeight = 1.f);
+
+	bool FindJumpPath(const Position& a_start, const Position& a_end, std::vector<Position>& a_finalPath);
+	void BuildJumpTable();
+
+	void FloodDistances(const Position& a_start);
+	int GetDistance(const Position& a_tile) const;
+
+	void SetBounds(unsigned int a_iX, unsigned int a_iY, unsigned int a_iWidth, unsigned int a_iHeight);
+	void ClearBounds();
+
+	static float GetHeuristic(GRID_HEURISTIC a_eHeuristic, int a_dx, int a_dy);
+
+	//Getters
+	unsigned int GetWidth() const { return m_iWidth; }
+	unsigned int GetHeight() const { return m_iHeight; }
+	unsigned int GetNumNodesExpanded() const { return m_iNumNodesExpanded; }
+	bool HasJumpTable() const { return !m_jumpDistances.empty(); }
+
+private:
+	static const unsigned int NO_NODE = 0xFFFFFFFF;
+	//Heap index of a node that has been taken off the heap
+	static const unsigned int CLOSED = 0xFFFFFFFE;
+	//Direction the start of a search was reached from
+	static const unsigned char NO_DIRECTION = 4;
+	//Largest width or height that jump distances can be stored for
+	static const unsigned int MAX_JUMP_DISTANCE = 0x7FFF;
+
+	bool IsWalkable(int a_x, int a_y) const;
+	unsigned int GetNeighbour(unsigned int a_iNode, unsigned int a_iDirection) const;
+	bool IsForcedHorizontal(int a_x, int a_y, int a_dx) const;
+	int GetJumpDistance(unsigned int a_iNode, unsigned int a_iDirection) const { return m_jumpDistances[(a_iNode * 4) + a_iDirection]; }
+	unsigned int Jump(unsigned int a_iNode, unsigned int a_iDirection, const Position& a_end) const;
+	bool TouchNode(unsigned int a_iNode, unsigned int a_iParent, int a_iDistance, float a_fEstimate);
+	void BeginSearch();
+	bool IsTouched(unsigned int a_iNode) const { return m_generations[a_iNode] == m_iGeneration; }
+
+	void HeapPush(unsigned int a_iNode);
+	unsigned int HeapPop();
+	void HeapSiftUp(unsigned int a_iHeapIndex);
+	void HeapSiftDown(unsigned int a_iHeapIndex);
+	bool HeapLess(unsigned int a_iNodeA, unsigned int a_iNodeB) const;
+	float GetPriority(unsigned int a_iNode) const;
+
+	//Grid being searched, tile (x, y) is node y * width + x. The walls are
+	//owned by the caller
+	const bool* m_pWalls;
+	unsigned int m_iWidth;
+	unsigned int m_iHeight;
+
+	//Searches don't leave the tiles from min up to but not including max
+	int m_iMinX;
+	int m_iMinY;
+	int m_iMaxX;
+	int m_iMaxY;
+
+	//Node state, only valid for nodes stamped with the current generation
+	std::vector<unsigned int> m_generations;
+	std::vector<int> m_distances;
+	std::vector<float> m_estimates;
+	std::vector<unsigned int> m_parents;
+	std::vector<unsigned int> m_heapIndices;
+	std::vector<unsigned char> m_directions;
+	unsigned int m_iGeneration;
+
+	//Four jump distances for each tile, one for each direction (+x, -x, +y, -y).
+	//A positive distance is the number of tiles to the next jump point, zero or
+	//less is minus the number of tiles that can be walked before a wall
+	std::vector<short> m_jumpDistances;
+
+	//Open nodes ordered by distance plus weighted estimate
+	std::vector<unsigned int> m_heap;
+	float m_fWeight;
+
+	unsigned int m_iNumNodesExpanded;
+};
+
+#endif // !__GRID_SEARCH_H__
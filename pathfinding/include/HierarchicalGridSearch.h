@@ -0,0 +1,118 @@
+#ifndef __HIERARCHICAL_GRID_SEARCH_H__
+#define __HIERARCHICAL_GRID_SEARCH_H__
+
+//C Includes
+#include <vector>
+
+//Project Includes
+#include "GridSearch.h"
+
+/*Edge of the abstract graph between entrances of the same cluster, the cost
+is the length of the shortest path between them inside the cluster*/
+typedef struct GridAbstractEdge {
+	unsigned int node;
+	int cost;
+}GridAbstractEdge;
+
+/*Entrance tile of a cluster, every entrance has a partner on the other side
+of the border it is on that it is a step away from*/
+typedef struct GridAbstractNode {
+	int x;
+	int y;
+	unsigned int cluster;
+	unsigned int partner;
+	bool active;
+	std::vector<GridAbstractEdge> edges;
+}GridAbstractNode;
+
+/// <summary>
+/// Hierarchical path finding (HPA*) over a grid of tiles. The grid is split
+/// in to square clusters, and where a cluster's border with its neighbour is
+/// open on both sides entrances are placed, one in the middle of short
+/// openings and one at each end of long ones. Entrances of the same cluster
+/// are joined by the length of the shortest path between them inside the
+/// cluster. Paths are found over this abstract graph as a list of entrances
+/// and each step between them is refined in to tiles when it is needed.
+/// The graph is kept between searches, only the clusters whose tiles have
+/// changed and their neighbours are rebuilt
+/// </summary>
+class HierarchicalGridSearch
+{
+public:
+	HierarchicalGridSearch(unsigned int a_iClusterSize = 16);
+
+	void SetGrid(const bool* a_pWalls, unsigned int a_iWidth, unsigned int a_iHeight);
+	void SetAllTilesChanged();
+	void SetTileChanged(int a_x, int a_y);
+	void Update();
+
+	bool FindAbstractPath(const Position& a_start, const Position& a_end, std::vector<Position>& a_waypoints);
+	bool RefineSegment(const Position& a_from, const Position& a_to, std::vector<Position>& a_segment);
+	bool RefinePath(const std::vector<Position>& a_waypoints, std::vector<Position>& a_finalPath);
+
+	//Getters
+	unsigned int GetClusterSize() const { return mc_iClusterSize; }
+	unsigned int GetNumClusters() const { return m_iNumClustersX * m_iNumClustersY; }
+	unsigned int GetNumAbstractNodes() const { return (unsigned int)(m_nodes.size() - m_freeNodes.size()); }
+	unsigned int GetNumClustersRebuilt() const { return m_iNumClustersRebuilt; }
+	unsigned int GetNumNodesExpanded() const { return m_iNumNodesExpanded; }
+
+private:
+	static const unsigned int NO_NODE = 0xFFFFFFFF;
+	//Openings along a border at least this wide get an entrance at each end
+	static const unsigned int MIN_WIDE_ENTRANCE = 6;
+
+	unsigned int GetCluster(int a_x, int a_y) const;
+	void SetSearchBounds(unsigned int a_iCluster);
+	bool IsWalkable(int a_x, int a_y) const;
+
+	unsigned int AddNode(int a_x, int a_y, unsigned int a_iCluster);
+	void RemoveNode(unsigned int a_iNode);
+	void RemoveEdge(unsigned int a_iFrom, unsigned int a_iTo);
+
+	void BuildBorder(unsigned int a_iCluster, bool a_bEast);
+	void ClearBorder(unsigned int a_iCluster, bool a_bEast);
+	void BuildClusterEdges(unsigned int a_iCluster);
+	void ConnectToCluster(unsigned int a_iNode);
+
+	bool SearchAbstractGraph(unsigned int a_iStart, unsigned int a_iEnd, std::vector<Position>& a_waypoints);
+
+	const unsigned int mc_iClusterSize;
+
+	//Grid being searched, the walls are owned by the caller
+	const bool* m_pWalls;
+	unsigned int m_iWidth;
+	unsigned int m_iHeight;
+	unsigned int m_iNumClustersX;
+	unsigned int m_iNumClustersY;
+
+	//Abstract graph, removed nodes are reused
+	std::vector<GridAbstractNode> m_nodes;
+	std::vector<unsigned int> m_freeNodes;
+
+	//Entrances in each cluster and on its east and south borders, which hold
+	//the entrances on both sides of the border
+	std::vector<std::vector<unsigned int>> m_clusterNodes;
+	std::vector<std::vector<unsigned int>> m_eastBorderNodes;
+	std::vector<std::vector<unsigned int>> m_southBorderNodes;
+
+	//Clusters waiting to be rebuilt by Update
+	std::vector<bool> m_dirtyClusters;
+	std::vector<unsigned int> m_dirtyClusterList;
+
+	//State of the abstract search, only valid for nodes stamped with the
+	//current generation
+	std::vector<unsigned int> m_generations;
+	std::vector<int> m_distances;
+	std::vector<unsigned int> m_parents;
+	std::vector<bool> m_closed;
+	unsigned int m_iGeneration;
+
+	//Searches inside a single cluster
+	GridSearch m_localSearch;
+
+	unsigned int m_iNumClustersRebuilt;
+	unsigned int m_iNumNodesExpanded;
+};
+
+#endif // !__HIERARCHICAL_GRID_SEARCH_H__
@@ -2,9 +2,11 @@
 #define __MD2Pathfinder_H__
 
 #include <glm/ext.hpp>
+#include <vector>
 
 //Project includes
 #include "md2_loader.h"
+#include "md2_animation_lod.h"
 #include "PathfindingObject.h"
 
 //Predefines
@@ -26,83 +28,133 @@ public:
 	MD2Pathfinder(const char* a_modelFilename);
 	MD2Pathfinder(const char* a_modelFilename, glm::vec3 a_pos);
 	MD2Pathfinder(const char* a_modelFilename, glm::vec3 a_pos, std::vector<Position>* a_path);
+	~MD2Pathfinder();
 
 	void Update(float a_fDeltaTime);
 
 	//Reset Function
 	void SetPosition(glm::vec3 a_pos);
+	glm::mat4 GetModelMatrix() const;
 	void StopPath();
 
 	void ChangeSkin(ATTRIBUTE_CHANGE_DIRECTION a_eChangeDirection);
 	void ChangeSkin(int a_iSkinID);
 
 	void ChangeAnimation(ATTRIBUTE_CHANGE_DIRECTION a_eChangeDirection);
-	void ChangeAnimation(int a_iSkinID);
+	void ChangeAnimation(int a_iAnimationID);
+	const char* GetAnimationName() const;
+	void SetAnimationBlendDuration(float a_fBlendDuration) { m_fAnimationBlendDuration = a_fBlendDuration; }
+	float GetAnimationBlendDuration() const { return m_fAnimationBlendDuration; }
 	
-	MD2Vertex* GetVertsData() const;
+	void SetVertexLayout(MD2_VERTEX_LAYOUT a_eVertexLayout);
+	MD2_VERTEX_LAYOUT GetVertexLayout() const;
+	void SetNormalFormat(MD2_NORMAL_FORMAT a_eNormalFormat);
+	MD2_NORMAL_FORMAT GetNormalFormat() const;
+	void SetAnimationLOD(MD2_ANIMATION_LOD a_eAnimationLOD);
+	MD2_ANIMATION_LOD GetAnimationLOD() const { return m_eAnimationLOD; }
+	void SetInterpolationMode(MD2_INTERPOLATION_MODE a_eInterpolationMode);
+	MD2_INTERPOLATION_MODE GetInterpolationMode() const { return m_eInterpolationMode; }
+
+	const MD2Vertex* GetVertsData() const;
+	const MD2StaticVertex* GetStaticVertsData() const;
+	const MD2DynamicVertex* GetDynamicVertsData() const;
+	const MD2PackedVertex* GetPackedVertsData() const;
+	float GetInterpolation() const;
+	unsigned int GetCurrentFrame() const { return (unsigned int)m_iVertexFrameIndex; }
+	unsigned int GetNextFrame() const { return (unsigned int)m_iVertexNextFrameIndex; }
 	float GetNumVerts() const;
+	unsigned int GetNumIndices() const;
+	const unsigned short* GetIndexData() const;
 	unsigned int GetTextureID() const;
+	const MD2Model* GetModel() const { return m_pModel; }
 
 private:
 
 	bool LoadModel(const char * a_modelFilename); //Function to load model
+	void CreateVertexBuffers(); //Function to size the buffers for the vertex layout
 	void Animate(float a_fDeltaTime);
+	static void AdvanceFrames(float a_fAmount, int a_iStartFrame, int a_iEndFrame, int& a_iCurrentFrame, int& a_iNextFrame, float& a_fInterpolation);
+	unsigned int FindAnimationClip(const char* a_name) const;
 
 
-	//Model to move around the world
-	MD2Model* m_pModel;
+	//Model to move around the world, shared with every other pathfinder
+	//using the same file so it is read only
+	const MD2Model* m_pModel = nullptr;
 	int m_iCurrentSkinIndex = 0;
 
 	//Scale of the model and offset so that it stits at 0,0,0
 	float m_fModelScale = 0.02f;
 	const glm::vec3 m_modelOffset = glm::vec3(-9.5f, 0.5f, -9.5f);
+	//Rotation about the y axis, in radians
+	float m_fHeading = 0.f;
+
+	//Keyframes decoded for this pathfinder only, the shared model is never
+	//written to. Most memory the decoded keyframes may take up
+	MD2KeyframeCache m_keyframeCache;
+	const size_t mc_iKeyframeCacheBudget = 1024 * 1024;
 
 	//Animation Vars
 
-	//ENUM FOR ANIMATION STATE
-	enum ANIMATION_STATE {
-		ANIMATION_STATE_IDLE = 0,
-		ANIMATION_STATE_IDLE_LOOK_AT_GUN,
-		ANIMATION_STATE_WALK,
-		ANIMATION_STATE_RUN,
-		ANIMATION_STATE_ATTACK_A,
-		ANIMATION_STATE_ATTACK_B,
-		ANIMATION_STATE_HURT_CROUCH,
-		ANIMATION_STATE_HURT_SHOT,
-		ANIMATION_STATE_DEAD,
-		ANIMATION_STATE_DUCK,
-
-		ANIMATION_STATE_COUNT
-	};
-
-	//Animation List
-	// {start frame , end frame}
-	MD2Animation m_aModelAnimationList[10]{
-		{0  , 29}, //IDLE
-		{30 , 68}, //IDLE, LOOK AT GUN
-		{69 , 92}, //WALK
-		{94 , 108}, //RUN
-		{110, 128}, //ATTACK A
-		{129, 158}, //ATTACK B
-		{159, 176}, //HURT CROUCH
-		{177, 189}, //HURT SHOT
-		{188, 200}, //DEAD
-		{201, 209}, //DUCK
-	};
+	//Animations come from the frame names of the model, the animation being
+	//played is the ID of a clip in the models animation table
+	unsigned int m_iAnimationClip = 0;
+	unsigned int m_iAnimationClipLastFrame = MD2AnimationTable::INVALID_CLIP;
+	unsigned int m_iPreWalkingAnimationClip = 0;
+
+	//Clips to start on and to walk with, found when the model is loaded.
+	//Models without them start on their first clip and keep their animation
+	//when walking
+	const char* mc_idleAnimationName = "stand";
+	const char* mc_walkAnimationName = "walk";
+	unsigned int m_iWalkAnimationClip = MD2AnimationTable::INVALID_CLIP;
 
 	int m_iCurrentFrameIndex = 0;
 	int m_iNextFrameIndex = 1;
 	float m_fInterpolation = 0;
 	int m_iStartFrame = 0;
-	int m_iEndFrame = 29;
+	int m_iEndFrame = 0;
 	const float mc_fAnimtationSpeed = 10.f;
 	const bool m_bForceWalkAnimationWhenMoving = true;
 	bool m_bAnimationLocked = false;
-	ANIMATION_STATE m_eAnimationState = ANIMATION_STATE_IDLE;
-	ANIMATION_STATE m_eAnimationStateLastFrame = ANIMATION_STATE_IDLE;
-	ANIMATION_STATE m_ePreWalkingAnimationState = ANIMATION_STATE_IDLE;
 
-	MD2Vertex* m_pCurrentVertexData;
+	//Changing clip cross fades from the clip that was playing over the blend
+	//duration, 0 cuts straight to the new clip. The clip being blended out
+	//keeps playing until the blend is over
+	float m_fAnimationBlendDuration = 0.2f;
+	float m_fAnimationBlendTime = 0.f;
+	bool m_bBlendingAnimation = false;
+	int m_iBlendCurrentFrameIndex = 0;
+	int m_iBlendNextFrameIndex = 0;
+	float m_fBlendInterpolation = 0.f;
+	int m_iBlendStartFrame = 0;
+	int m_iBlendEndFrame = 0;
+
+	//Animation level of detail, the clock always runs at full rate but the
+	//vertices are only made as often as the level allows. The frames and
+	//interpolation the vertices were last made with are kept so the
+	//interpolation handed to the shader matches them
+	MD2_ANIMATION_LOD m_eAnimationLOD = MD2_ANIMATION_LOD_FULL;
+	unsigned int m_iAnimationTick = 0;
+	bool m_bVertexDataStale = true;
+	int m_iVertexFrameIndex = 0;
+	int m_iVertexNextFrameIndex = 0;
+	float m_fVertexInterpolation = 0.f;
+
+	//When the GPU interpolates the keyframes, from vertex buffers or baked
+	//textures, no vertices are made here, only
+	//the frames and interpolation to draw with are kept. The shader can only
+	//read two frames so changes of animation are cut rather than blended
+	MD2_INTERPOLATION_MODE m_eInterpolationMode = MD2_INTERPOLATION_CPU;
+
+	//Interpolated vertices for the current frame, sized once when the model
+	//is loaded and refilled each update. Only the buffers used by the
+	//current vertex layout and normal format hold any data
+	MD2_VERTEX_LAYOUT m_eVertexLayout = MD2_VERTEX_LAYOUT_INTERLEAVED;
+	MD2_NORMAL_FORMAT m_eNormalFormat = MD2_NORMAL_FORMAT_FLOAT;
+	std::vector<MD2Vertex> m_currentVertexData;
+	std::vector<MD2StaticVertex> m_staticVertexData;
+	std::vector<MD2DynamicVertex> m_dynamicVertexData;
+	std::vector<MD2PackedVertex> m_packedVertexData;
 
 };
 
@@ -4,6 +4,10 @@
 #include <glm/glm.hpp>
 #include <vector>
 
+#include "GridSearch.h"
+#include "HierarchicalGridSearch.h"
+#include "FlowFieldCache.h"
+
 struct Position
 {
 
@@ -51,32 +55,6 @@ struct Position
 	}
 };
 
-/*
-	NODE FOR ATTEMPTED IMPLEMENTATION OF A*
-
-/// <summary>
-/// Node for a start pathfinding, stores parent, postion,
-/// g, h and f values
-/// </summary>
-struct AStarNode {
-	AStarNode(AStarNode* a_pParent, Position a_pos) {
-		parent = a_pParent;
-		position = a_pos;
-	}
-	AStarNode* parent;
-	Position position;
-
-	int g = 0; //Distance from start node
-	int h = 0; //Distance from end node
-	int f = 0; //G + F
-
-	//Comparision of if we are a certian node
-	bool operator==(AStarNode a_other) {
-		return position == a_other.position;
-	}
-};
-*/
-
 class Maze
 {
 public:
@@ -84,7 +62,19 @@ public:
 	~Maze();
 
 	bool PathfindingDijkstra(Position start, Position end, std::vector<Position> & finalPath);
-	//bool PathfindingAStar(Position start, Position end, std::vector<Position>& finalPath);
+	bool PathfindingDijkstraReference(Position start, Position end, std::vector<Position>& finalPath);
+	bool PathfindingAStar(Position start, Position end, std::vector<Position>& finalPath,
+		GRID_HEURISTIC heuristic = GRID_HEURISTIC_MANHATTAN, float weight = 1.f);
+	bool PathfindingJPS(Position start, Position end, std::vector<Position>& finalPath);
+	bool PathfindingHierarchical(Position start, Position end, std::vector<Position>& waypoints);
+	bool RefinePathSegment(Position from, Position to, std::vector<Position>& segment);
+	bool RefinePath(const std::vector<Position>& waypoints, std::vector<Position>& finalPath);
+	unsigned int UpdateHierarchy();
+	const FlowField* GetFlowField(Position goal);
+	const FlowField* FindFlowField(Position goal);
+	bool PathfindingFlowField(Position start, Position end, std::vector<Position>& finalPath);
+	FlowFieldCache& GetFlowFieldCache();
+	unsigned int GetNumNodesExpanded();
 
 	void DrawMaze();
 	void DrawPath(std::vector<Position> &path);
@@ -96,6 +86,7 @@ public:
 	unsigned int GetNumTilesHeight();
 
 	void RandomiseWalls();
+	void SetWall(int x, int y, bool wall);
 
 	glm::vec3 GetOffset();
 
@@ -106,7 +97,14 @@ private:
 	float m_fTileSize;
 	unsigned int m_iWidth;
 	unsigned int m_iHeight;
-	bool** m_Tiles;
+	//Tile (x, y) is at y * m_iWidth + x
+	bool* m_Tiles;
+	GridSearch m_search;
+	HierarchicalGridSearch m_hierarchy;
+	FlowFieldCache m_flowFields;
+	//Set when walls have changed since the jump table was built
+	bool m_bJumpTableStale;
+	unsigned int m_iNumNodesExpanded;
 	glm::vec3 GetVec3(int x, int y);
 	glm::vec3 GetVec3(Position pos);
 	Position* GetAdjacentPositions(Position currentTile);
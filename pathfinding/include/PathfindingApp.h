@@ -6,7 +6,21 @@
 #include "Maze.h"
 #include "md2_loader.h"
 #include "MD2Pathfinder.h"
+#include "md2_animation_lod.h"
+#include "md2_animation_texture.h"
 #include "LocationPicker.h"
+#include <future>
+#include <string>
+#include <vector>
+
+//How click to move finds a path
+typedef enum {
+	PATHFINDING_MODE_ASTAR,			//A* path found in full
+	PATHFINDING_MODE_FLOW_FIELD,	//Next tile read from the flow field to the target
+	PATHFINDING_MODE_HIERARCHICAL,	//HPA* waypoints refined one segment at a time
+
+	PATHFINDING_MODE_COUNT /*Total number of modes*/
+} PATHFINDING_MODE;
 
 // Derived application class that wraps up all globals neatly
 class PathfindingApp : public Application
@@ -41,7 +55,33 @@ protected:
 
 	unsigned int m_vao;
 	unsigned int m_vbo;
+	unsigned int m_staticVbo;
 	unsigned int m_ibo;
+	unsigned int m_keyframeVao;
+	unsigned int m_keyframeVbo;
+	unsigned int m_animationTextureVao;
+	unsigned int m_animationPositionTexture = 0;
+	unsigned int m_animationNormalTexture = 0;
+
+	//Split puts colour and UVs in m_staticVbo so only positions and normals
+	//are uploaded each frame
+	MD2_VERTEX_LAYOUT m_eVertexLayout = MD2_VERTEX_LAYOUT_SPLIT;
+	//Packing the normals shrinks the per frame vertex from 24 to 16 bytes
+	MD2_NORMAL_FORMAT m_eNormalFormat = MD2_NORMAL_FORMAT_OCTAHEDRAL;
+	//Interpolation between frames for the shader to use with MD2_NORMAL_FORMAT_INDEX
+	float m_fNormalInterpolation = 0.f;
+
+	//On the GPU every keyframe is uploaded once in to m_keyframeVbo and each
+	//draw only sends the two frames to interpolate and how far between them.
+	//Keyframe normals are always packed, float normals are swapped for octahedral
+	MD2_INTERPOLATION_MODE m_eInterpolationMode = MD2_INTERPOLATION_CPU;
+	MD2_NORMAL_FORMAT m_eKeyframeNormalFormat = MD2_NORMAL_FORMAT_OCTAHEDRAL;
+	unsigned int m_iNumKeyframeVerts = 0;
+	unsigned int m_iKeyframeCurrentFrame = 0;
+	unsigned int m_iKeyframeNextFrame = 0;
+	float m_fKeyframeInterpolation = 0.f;
+	//Set once the keyframes are baked in to textures that fit on the GPU
+	bool m_bHasAnimationTextures = false;
 
 	unsigned int glViewMinW;
 	unsigned int glViewMinH;
@@ -55,19 +95,39 @@ protected:
 	bool m_bLeftMousePressedLastFrame = false;
 	bool m_bSkinChangeKeyPressedLastFrame = false;
 	bool m_bAnimationChangeKeyPressedLastFrame = false;
+	bool m_bBenchmarkKeyPressedLastFrame = false;
+	bool m_bPathfindingBenchmarkKeyPressedLastFrame = false;
+	bool m_bInterpolationKeyPressedLastFrame = false;
+	bool m_bPathfindingModeKeyPressedLastFrame = false;
+
+	//How click to move finds the path for the model to follow
+	PATHFINDING_MODE m_ePathfindingMode = PATHFINDING_MODE_ASTAR;
+
+	//Lines of the pathfinding benchmark while it runs on its own thread
+	std::future<std::vector<std::string>> m_pathfindingBenchmark;
 
 	//Set if we should draw the path that the model is following
 	bool m_bDrawPath = false;
 
+	//Picks how often models are animated from where they are to the camera
+	MD2AnimationLODPolicy m_animationLODPolicy;
+
 private:
 	void InitBoilerplateGL();
 	void UpdateBoilerplateGL(float a_deltaTime);
 
 	void SetModelTextureID(unsigned int a_TextureID);
-	void SetModelDrawData(unsigned int a_numVertices, unsigned int a_vertexSize, void* a_vertexData);
+	void SetModelDrawData(unsigned int a_numVertices, unsigned int a_vertexSize, const void* a_vertexData);
+	void SetModelStaticDrawData(unsigned int a_numVertices, const MD2StaticVertex* a_vertexData);
+	void SetModelIndexData(unsigned int a_numIndices, const unsigned short* a_indexData);
+	void SetModelKeyframeData(unsigned int a_numVerticesPerFrame, unsigned int a_numFrames, const MD2PackedVertex* a_vertexData);
+	bool SetModelAnimationTextures(const MD2AnimationTexture& a_animationTexture);
+	void SetKeyframeAttributes(unsigned int a_currentFrame, unsigned int a_nextFrame);
+
+	void BenchmarkCrowd(unsigned int a_iNumAgents, unsigned int a_iNumUpdates, unsigned int a_iInterpolationSteps);
 
 	void PreDraw();
-	void DrawModel(unsigned int a_numVerts);
+	void DrawModel(unsigned int a_numIndices, const glm::mat4& a_modelMatrix);
 
 };
 
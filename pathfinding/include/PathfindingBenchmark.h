@@ -0,0 +1,58 @@
+#ifndef __PATHFINDING_BENCHMARK_H__
+#define __PATHFINDING_BENCHMARK_H__
+
+//C Includes
+#include <string>
+#include <vector>
+
+//Project Includes
+#include "Maze.h"
+
+//Random paths to find in a maze, and the paths Dijkstra finds for them that
+//every other search is checked against
+typedef struct PathfindingQueries {
+	std::vector<Position> starts;
+	std::vector<Position> ends;
+	std::vector<std::vector<Position>> paths;
+} PathfindingQueries;
+
+//Time taken to run one search over every query and how its paths compare
+//with Dijkstra's
+typedef struct PathfindingBenchmarkResult {
+	double elapsedMs;					//Time taken by every query together
+	unsigned long long numExpanded;		//Tiles, or entrances for a hierarchical search, expanded
+	size_t totalLength;					//Tiles in every path found
+	unsigned int numFound;				//Queries a path was found for
+	unsigned int numWrong;				//Queries whose path fails the check for the search
+	unsigned long long numCacheHits;	//Flow fields found in the maze's cache, 0 for other searches
+	unsigned long long numCacheMisses;	//Flow fields built for the maze's cache, 0 for other searches
+} PathfindingBenchmarkResult;
+
+/// <summary>
+/// Times each search in Maze over random queries and checks its paths
+/// against Dijkstra's. Nothing here draws or logs, so the checks can be run
+/// without the app, Run gives the lines for the app to log
+/// </summary>
+class PathfindingBenchmark
+{
+public:
+	static bool Run(unsigned int a_iNumQueries, std::vector<std::string>& a_outLines);
+
+	static PathfindingQueries CreateQueries(unsigned int a_iMazeSize, unsigned int a_iNumQueries);
+
+	static PathfindingBenchmarkResult RunDijkstra(Maze& a_maze, PathfindingQueries& a_queries);
+	static PathfindingBenchmarkResult RunDijkstraReference(Maze& a_maze, const PathfindingQueries& a_queries);
+	static PathfindingBenchmarkResult RunAStar(Maze& a_maze, const PathfindingQueries& a_queries, GRID_HEURISTIC a_eHeuristic, float a_fWeight);
+	static PathfindingBenchmarkResult RunJPS(Maze& a_maze, const PathfindingQueries& a_queries);
+	static PathfindingBenchmarkResult RunFlowField(Maze& a_maze, const PathfindingQueries& a_queries);
+	static PathfindingBenchmarkResult RunCrowdAStar(Maze& a_maze, const std::vector<Position>& a_agentTiles, Position a_goal);
+	static PathfindingBenchmarkResult RunCrowdFlowField(Maze& a_maze, const std::vector<Position>& a_agentTiles, Position a_goal);
+	static PathfindingBenchmarkResult RunHierarchical(Maze& a_maze, const PathfindingQueries& a_queries);
+	static double TimeHierarchyUpdate(Maze& a_maze, unsigned int& a_iOutNumClusters);
+
+private:
+	static double GetCacheReuseRate(const PathfindingBenchmarkResult& a_result);
+	static void AddLine(std::vector<std::string>& a_outLines, const char* a_szFormat, ...);
+};
+
+#endif // !__PATHFINDING_BENCHMARK_H__
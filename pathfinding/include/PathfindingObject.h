@@ -10,6 +10,8 @@ class PathfindingObject {
 public:
 
 	void StartPath(std::vector<Position>* a_path, glm::vec3 a_pathOffset);
+	void StartFlowField(Maze* a_pMaze, Position a_goal, glm::vec3 a_pathOffset = glm::vec3(0));
+	void StartHierarchicalPath(Maze* a_pMaze, const std::vector<Position>& a_waypoints, glm::vec3 a_pathOffset = glm::vec3(0));
 	glm::vec3 GetCurrentPosition();
 
 protected:
@@ -25,6 +27,18 @@ protected:
 	bool m_bFollowingPath = false;
 	std::vector<Position> m_path;
 
+	//Maze to read the flow field from and the goal it heads to, when set the
+	//next postion is read from the field rather than the path
+	Maze* m_pFlowFieldMaze = nullptr;
+	Position m_flowFieldGoal;
+
+	//Maze to refine the hierarchical path in and the waypoints of the path
+	//from the start to the end, when set the path only holds the segment up
+	//to the next waypoint and the segment after is refined once it is walked
+	Maze* m_pHierarchyMaze = nullptr;
+	std::vector<Position> m_waypoints;
+	unsigned int m_iNextWaypoint = 0;
+
 private:
 
 	unsigned int m_iCurrentIndexInPath = 0;
@@ -37,6 +51,7 @@ private:
 
 	//Changing next path position
 	bool IncrementNextPathPostion();
+	bool RefineNextSegment();
 
 };
 
@@ -0,0 +1,40 @@
+#pragma once
+
+#ifndef __MAPPED_FILE_H__
+#define __MAPPED_FILE_H__
+
+//C Includes
+#include <cstddef>
+
+/// <summary>
+/// Read only memory mapping of a whole file. The file is mapped with a
+/// single open and map call and released when the object is closed or
+/// destroyed
+/// </summary>
+class MappedFile
+{
+public:
+	//Constructors / Destructors
+	MappedFile();
+	~MappedFile();
+
+	//Open and Close functions
+	bool Open(const char* a_filename);
+	void Close();
+
+	//Getters
+	const unsigned char* GetData() const { return m_pData; }
+	size_t GetSize() const { return m_size; }
+	bool IsOpen() const { return m_pData != nullptr; }
+
+private:
+
+	//Mappings can not be copied as they own the view of the file
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	const unsigned char* m_pData;
+	size_t m_size;
+};
+
+#endif // !__MAPPED_FILE_H__
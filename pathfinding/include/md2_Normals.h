@@ -3,4 +3,9 @@
 #include <glm/glm.hpp>
 
 #define precalculated_normal_length 162
-extern const glm::vec3 precalculated_normals[162];
\ No newline at end of file
+extern const glm::vec3 precalculated_normals[162];
+
+//Packs a unit normal in to two 16 bit octahedral values, x in the low 16 bits
+unsigned int PackNormalOctahedral(const glm::vec3& a_normal);
+//Table of the precalculated normals already packed as octahedral values
+const unsigned int* GetPrecalculatedNormalsOctahedral();
@@ -0,0 +1,56 @@
+#pragma once
+
+#ifndef __MD2_ANIMATION_LOD_H__
+#define __MD2_ANIMATION_LOD_H__
+
+#include <glm/glm.hpp>
+
+//How much work goes in to animating an agent. The animation clock always
+//advances at full rate, the level only changes how often vertices are made
+typedef enum {
+	MD2_ANIMATION_LOD_FULL,			//Vertices are interpolated every update
+	MD2_ANIMATION_LOD_HALF,			//Vertices are interpolated every 2nd update
+	MD2_ANIMATION_LOD_QUARTER,		//Vertices are interpolated every 4th update
+	MD2_ANIMATION_LOD_EIGHTH,		//Vertices are interpolated every 8th update
+	MD2_ANIMATION_LOD_KEYFRAME,		//Vertices snap to the current keyframe with no interpolation
+	MD2_ANIMATION_LOD_CLOCK_ONLY,	//Agent can't be seen, no vertices are made
+
+	MD2_ANIMATION_LOD_COUNT /*Total number of levels*/
+} MD2_ANIMATION_LOD;
+
+/// <summary>
+/// Picks the animation level of detail for an agent from its distance to the
+/// camera and whether it is in the view frustum
+/// </summary>
+class MD2AnimationLODPolicy
+{
+public:
+	MD2AnimationLODPolicy();
+
+	void SetBandDistance(MD2_ANIMATION_LOD a_eLOD, float a_fMaxDistance);
+	float GetBandDistance(MD2_ANIMATION_LOD a_eLOD) const;
+	void SetBoundingRadius(float a_fRadius) { m_fBoundingRadius = a_fRadius; }
+	void SetFrustumCulling(bool a_bCullOutsideFrustum) { m_bCullOutsideFrustum = a_bCullOutsideFrustum; }
+
+	void SetCamera(const glm::vec3& a_cameraPosition, const glm::mat4& a_viewProjection);
+	MD2_ANIMATION_LOD GetLOD(const glm::vec3& a_position) const;
+
+	static unsigned int GetUpdateInterval(MD2_ANIMATION_LOD a_eLOD);
+
+private:
+	bool IsInFrustum(const glm::vec3& a_position) const;
+
+	//Furthest distance each interpolated level is used to, beyond the last
+	//band agents snap to keyframes
+	float m_fBandDistances[MD2_ANIMATION_LOD_KEYFRAME];
+
+	//Radius of a sphere around an agent's position that holds the whole model
+	float m_fBoundingRadius;
+	bool m_bCullOutsideFrustum;
+
+	glm::vec3 m_cameraPosition;
+	//Planes of the view frustum as (normal, distance), normals face inwards
+	glm::vec4 m_frustumPlanes[6];
+};
+
+#endif // !__MD2_ANIMATION_LOD_H__
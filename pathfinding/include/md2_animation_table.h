@@ -0,0 +1,61 @@
+#pragma once
+
+#ifndef __MD2_ANIMATION_TABLE_H__
+#define __MD2_ANIMATION_TABLE_H__
+
+//C Includes
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+//Forward Declerations
+struct MD2Frame;
+
+/*Length of a frame name in an MD2 file, names that fill the whole field are
+not null terminated*/
+#define MD2_FRAME_NAME_LENGTH 16
+
+/*Run of frames that make up one animation, the end frame is played*/
+typedef struct MD2Animation {
+	unsigned int start;
+	unsigned int end;
+}MD2Animation;
+
+/*Animation found in the frame names of a model, the name is the frame name
+without its frame number and is always null terminated*/
+typedef struct MD2AnimationClip {
+	char name[MD2_FRAME_NAME_LENGTH + 1];
+	MD2Animation frames;
+}MD2AnimationClip;
+
+/// <summary>
+/// Table of the animations in a model, built from the names of its frames.
+/// MD2 frames are named after their animation followed by a frame number
+/// (run1..run6, attak101..attak121), so each run of frames with the same name
+/// and consecutive numbers is one clip. Clips are found by ID or by name in
+/// constant time
+/// </summary>
+class MD2AnimationTable
+{
+public:
+	static const unsigned int INVALID_CLIP = 0xFFFFFFFF;
+
+	void Build(const MD2Frame* a_pFrames, const unsigned int a_iNumFrames);
+	void Clear();
+
+	//Getters
+	unsigned int GetNumClips() const { return (unsigned int)m_clips.size(); }
+	const MD2AnimationClip* GetClip(const unsigned int a_iClipID) const;
+	unsigned int FindClip(const char* a_name) const;
+
+private:
+	static void SplitFrameName(const char* a_frameName, std::string& a_outClipName, std::string& a_outBaseName, int& a_iOutFrameNumber);
+
+	std::vector<MD2AnimationClip> m_clips;
+
+	//Clip ID of each name, when a name is used by more than one run of
+	//frames the first run is found
+	std::unordered_map<std::string, unsigned int> m_clipLookup;
+};
+
+#endif // !__MD2_ANIMATION_TABLE_H__
@@ -0,0 +1,48 @@
+#pragma once
+
+#ifndef __MD2_ANIMATION_TEXTURE_H__
+#define __MD2_ANIMATION_TEXTURE_H__
+
+//C Includes
+#include <vector>
+
+//Project Includes
+#include "md2_loader.h"
+
+/// <summary>
+/// Every keyframe of a model baked in to two textures so the vertex shader can
+/// animate the model with no work on the CPU. Both textures have one row per
+/// frame and one column per welded vertex, so a vertex is found by its index
+/// and the frame it is in. The position texture holds model space positions as
+/// 3 floats and the normal texture holds the MD2 normal index as a byte.
+/// Sample interpolates the baked data the way MD2Model::GetInterpolatedData
+/// does, not the way the shader does, so CountMismatches can check the data
+/// bit for bit. The shader renormalises its blended normals, Sample doesn't
+/// </summary>
+class MD2AnimationTexture
+{
+public:
+	bool Bake(const MD2Model& a_model);
+	void Clear();
+
+	bool Sample(const unsigned int a_iCurrentFrame, const unsigned int a_iNextFrame, const float a_fInterpAmount, MD2DynamicVertex* a_pOutVertices, const unsigned int a_iNumOutVertices) const;
+	unsigned int CountMismatches(const MD2Model& a_model, const float* a_pInterpAmounts, const unsigned int a_iNumInterpAmounts) const;
+
+	//Getters
+	bool IsBaked() const { return !m_positions.empty(); }
+	unsigned int GetWidth() const { return m_iWidth; }
+	unsigned int GetHeight() const { return m_iHeight; }
+	const float* GetPositionData() const { return m_positions.data(); }
+	const unsigned char* GetNormalIndexData() const { return m_normalIndices.data(); }
+
+private:
+	//Width is the number of welded vertices, height the number of frames
+	unsigned int m_iWidth = 0;
+	unsigned int m_iHeight = 0;
+
+	//Texels in row order, 3 floats for each position and 1 byte for each normal
+	std::vector<float> m_positions;
+	std::vector<unsigned char> m_normalIndices;
+};
+
+#endif // !__MD2_ANIMATION_TEXTURE_H__
@@ -0,0 +1,161 @@
+#pragma once
+
+#ifndef __MD2_CROWD_H__
+#define __MD2_CROWD_H__
+
+//C Includes
+#include <unordered_map>
+#include <vector>
+
+//Project Includes
+#include "md2_loader.h"
+#include "md2_animation_lod.h"
+
+//Forward Declerations
+class JobSystem;
+
+/// <summary>
+/// Animates many agents that share one model. The animation state of every
+/// agent is held as a structure of arrays so it can be advanced in one loop,
+/// and the vertices for every agent are interpolated in one call in to a
+/// single buffer.
+/// Both can be split across the threads of a job system, each agent's
+/// results do not depend on the number of threads.
+/// Agents in the same pose (current frame, next frame and interpolation) share
+/// one set of vertices that is only interpolated once. Interpolation can be
+/// quantised so that agents that are nearly in step share a pose. Poses are
+/// kept between updates while any agent uses them, so agents animated at a
+/// lower level of detail keep their vertices without them being made again
+/// </summary>
+class MD2Crowd
+{
+public:
+	//Constructors / Destructors
+	MD2Crowd(const MD2Model* a_pModel, MD2_VERTEX_LAYOUT a_eVertexLayout = MD2_VERTEX_LAYOUT_INTERLEAVED, MD2_NORMAL_FORMAT a_eNormalFormat = MD2_NORMAL_FORMAT_FLOAT);
+	~MD2Crowd();
+
+	unsigned int AddAgent(const MD2Animation& a_animation, float a_fAnimationSpeed);
+	void SetAnimation(unsigned int a_iAgent, const MD2Animation& a_animation);
+	void SetFrame(unsigned int a_iAgent, unsigned int a_iFrame, float a_fInterpolation);
+	void SetInterpolationSteps(unsigned int a_iInterpolationSteps);
+	void SetLOD(unsigned int a_iAgent, MD2_ANIMATION_LOD a_eLOD) { m_agentLODs[a_iAgent] = a_eLOD; }
+	void UpdateLODs(const MD2AnimationLODPolicy& a_policy, const glm::vec3* a_pPositions);
+	void Clear();
+
+	void Update(float a_fDeltaTime, JobSystem* a_pJobSystem = nullptr);
+	void Interpolate(JobSystem* a_pJobSystem = nullptr);
+
+	//Getters
+	const MD2Model* GetModel() const { return m_pModel; }
+	unsigned int GetNumAgents() const { return (unsigned int)m_currentFrames.size(); }
+	unsigned int GetNumVertsPerAgent() const { return m_iNumVertsPerAgent; }
+	unsigned int GetCurrentFrame(unsigned int a_iAgent) const { return m_currentFrames[a_iAgent]; }
+	unsigned int GetNextFrame(unsigned int a_iAgent) const { return m_nextFrames[a_iAgent]; }
+	float GetInterpolation(unsigned int a_iAgent) const { return m_interpolations[a_iAgent]; }
+	unsigned int GetInterpolationSteps() const { return m_iInterpolationSteps; }
+	MD2_ANIMATION_LOD GetLOD(unsigned int a_iAgent) const { return m_agentLODs[a_iAgent]; }
+
+	//Vertices of an agent, agents in the same pose return the same vertices.
+	//Agents with no pose, such as those outside the view, return nullptr
+	const MD2Vertex* GetVertsData(unsigned int a_iAgent) const { return GetPoseVertsData(m_agentPoses[a_iAgent]); }
+	const MD2DynamicVertex* GetDynamicVertsData(unsigned int a_iAgent) const { return GetPoseDynamicVertsData(m_agentPoses[a_iAgent]); }
+	const MD2PackedVertex* GetPackedVertsData(unsigned int a_iAgent) const { return GetPosePackedVertsData(m_agentPoses[a_iAgent]); }
+
+	//Poses used by the agents after the last call to Interpolate, pose
+	//numbers are not contiguous and are NO_POSE for agents without one
+	static const unsigned int NO_POSE = 0xFFFFFFFF;
+	unsigned int GetNumPoses() const { return (unsigned int)m_poseLookup.size(); }
+	unsigned int GetAgentPose(unsigned int a_iAgent) const { return m_agentPoses[a_iAgent]; }
+	float GetPoseInterpolation(unsigned int a_iPose) const { return m_poseInterpolations[a_iPose]; }
+	const MD2Vertex* GetPoseVertsData(unsigned int a_iPose) const;
+	const MD2DynamicVertex* GetPoseDynamicVertsData(unsigned int a_iPose) const;
+	const MD2PackedVertex* GetPosePackedVertsData(unsigned int a_iPose) const;
+
+	//Pose sharing stats since the counters were last reset, a pose is
+	//requested for each agent with a pose on each update
+	unsigned long long GetNumPosesRequested() const { return m_iNumPosesRequested; }
+	unsigned long long GetNumPosesInterpolated() const { return m_iNumPosesInterpolated; }
+	float GetPoseSharingRate() const;
+	void ResetPoseCounters();
+
+	unsigned long long GetNumKeyframeCacheHits() const;
+	unsigned long long GetNumKeyframeCacheMisses() const;
+
+private:
+
+	//The crowd owns its keyframe caches so can not be copied
+	MD2Crowd(const MD2Crowd&) = delete;
+	MD2Crowd& operator=(const MD2Crowd&) = delete;
+
+	void UpdateAgents(unsigned int a_iBegin, unsigned int a_iEnd, float a_fDeltaTime);
+	void InterpolatePoses(unsigned int a_iBegin, unsigned int a_iEnd, MD2KeyframeCache* a_pKeyframeCache);
+	void CreateKeyframeCaches(unsigned int a_iNumThreads);
+	void BuildPoses();
+	void ReleasePoses();
+	bool IsAgentDue(unsigned int a_iAgent) const;
+	unsigned long long GetPoseKey(unsigned int a_iAgent) const;
+	unsigned int GetInterpolationKey(float a_fInterpolation) const;
+
+	//Model shared by every agent
+	const MD2Model* m_pModel;
+	unsigned int m_iNumVertsPerAgent;
+
+	//Animation state, one entry per agent
+	std::vector<unsigned int> m_currentFrames;
+	std::vector<unsigned int> m_nextFrames;
+	std::vector<float> m_interpolations;
+	std::vector<float> m_animationSpeeds;
+	std::vector<unsigned int> m_startFrames;
+	std::vector<unsigned int> m_endFrames;
+
+	//Level of detail of each agent and the number of times the crowd has been
+	//interpolated, agents at reduced rates are spread over the updates by index
+	std::vector<MD2_ANIMATION_LOD> m_agentLODs;
+	unsigned int m_iInterpolationTick;
+
+	//Number of steps interpolation is rounded to when finding agents in the
+	//same pose, 0 only shares poses between agents exactly in step
+	unsigned int m_iInterpolationSteps;
+
+	//Pose shown by each agent, the key only changes when the agent is due
+	//to have its vertices made
+	std::vector<unsigned long long> m_agentPoseKeys;
+	std::vector<unsigned int> m_agentPoses;
+
+	//Pose slots, there is never more than one slot for each agent. Slots
+	//not used by any agent are on the free list
+	std::unordered_map<unsigned long long, unsigned int> m_poseLookup;
+	std::vector<unsigned long long> m_poseKeys;
+	std::vector<unsigned int> m_poseCurrentFrames;
+	std::vector<unsigned int> m_poseNextFrames;
+	std::vector<float> m_poseInterpolations;
+	std::vector<unsigned char> m_poseInUse;
+	std::vector<unsigned int> m_freePoses;
+
+	//Poses made this update, in frame order so poses on the same frame hit
+	//the keyframe cache
+	std::vector<unsigned int> m_posesToInterpolate;
+	unsigned long long m_iNumPosesRequested;
+	unsigned long long m_iNumPosesInterpolated;
+
+	//One keyframe cache for each thread interpolating the crowd so threads
+	//never share a cache, the models own cache is left for single agents
+	MD2KeyframeCache* m_pKeyframeCaches;
+	unsigned int m_iNumKeyframeCaches;
+	const size_t mc_iKeyframeCacheBudget = 1024 * 1024;
+
+	//Number of agents or poses in each job
+	const unsigned int mc_iUpdateChunkSize = 1024;
+	const unsigned int mc_iInterpolateChunkSize = 8;
+
+	//Interpolated vertices for every pose, pose i's vertices start at
+	//i * GetNumVertsPerAgent(). Only the buffer used by the vertex layout
+	//and normal format holds any data
+	MD2_VERTEX_LAYOUT m_eVertexLayout;
+	MD2_NORMAL_FORMAT m_eNormalFormat;
+	std::vector<MD2Vertex> m_vertexData;
+	std::vector<MD2DynamicVertex> m_dynamicVertexData;
+	std::vector<MD2PackedVertex> m_packedVertexData;
+};
+
+#endif // !__MD2_CROWD_H__
@@ -0,0 +1,70 @@
+#pragma once
+
+#ifndef __MD2_INTERPOLATOR_H__
+#define __MD2_INTERPOLATOR_H__
+
+#include <glm/glm.hpp>
+
+/*Structure of arrays view of a decoded keyframe, each stream holds one value
+per output vertex in model space*/
+typedef struct MD2KeyframeSoA {
+	const float* px;
+	const float* py;
+	const float* pz;
+	const float* nx;
+	const float* ny;
+	const float* nz;
+}MD2KeyframeSoA;
+
+/*Order of the keyframes in a blend between two animations, each animation
+is interpolated between its pair and the results are then blended*/
+typedef enum {
+	MD2_BLEND_FRAME_FROM_CURRENT,	//Current frame of the animation being blended out
+	MD2_BLEND_FRAME_FROM_NEXT,		//Next frame of the animation being blended out
+	MD2_BLEND_FRAME_TO_CURRENT,		//Current frame of the animation being blended in
+	MD2_BLEND_FRAME_TO_NEXT,		//Next frame of the animation being blended in
+
+	MD2_BLEND_FRAME_COUNT /*Total number of frames in a blend*/
+} MD2_BLEND_FRAME;
+
+/*Where interpolated vertices are written to, the x, y and z of the position
+and normal are written at each vertex and every other float is left untouched*/
+typedef struct MD2VertexStream {
+	float* position;		//First positon to write
+	float* normal;			//First normal to write, nullptr if normals are written some other way
+	unsigned int stride;	//Number of floats from one vertex to the next
+}MD2VertexStream;
+
+/// <summary>
+/// Vectorised keyframe interpolation. The instruction set is picked at runtime
+/// from what the CPU supports and every instruction set gives bit for bit the
+/// same output as the scalar path
+/// </summary>
+class MD2Interpolator
+{
+public:
+
+	//Instruction sets that interpolation can be run with
+	typedef enum {
+		MD2_ISA_SCALAR,	//Plain C++, one vertex at a time
+		MD2_ISA_SSE2,	//4 vertices at a time
+		MD2_ISA_AVX2,	//8 vertices at a time
+
+		MD2_ISA_COUNT /*Total number of instruction sets*/
+	} MD2_ISA;
+
+	static MD2_ISA GetSupportedISA();
+	static MD2_ISA GetActiveISA();
+	static bool SetActiveISA(MD2_ISA a_eISA);
+	static const char* GetISAName(MD2_ISA a_eISA);
+
+	static void Interpolate(const MD2KeyframeSoA& a_currentFrame, const MD2KeyframeSoA& a_nextFrame, const float a_fInterpAmount,
+		const MD2VertexStream& a_out, const unsigned int a_iNumVertices);
+	static void Blend(const MD2KeyframeSoA (&a_frames)[MD2_BLEND_FRAME_COUNT], const float a_fFromInterpAmount, const float a_fToInterpAmount, const float a_fBlendAmount,
+		const MD2VertexStream& a_out, const unsigned int a_iNumVertices);
+
+private:
+	static MD2_ISA m_eActiveISA;
+};
+
+#endif // !__MD2_INTERPOLATOR_H__
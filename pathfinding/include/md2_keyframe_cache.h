@@ -0,0 +1,72 @@
+#pragma once
+
+#ifndef __MD2_KEYFRAME_CACHE_H__
+#define __MD2_KEYFRAME_CACHE_H__
+
+//C Includes
+#include <cstddef>
+#include <vector>
+
+//Project Includes
+#include "md2_interpolator.h"
+
+/// <summary>
+/// Least recently used cache of decoded keyframes. Each slot holds one
+/// keyframe as a structure of arrays and the number of slots is bounded by a
+/// byte budget. The cache only manages the slots, whoever owns it decodes
+/// frames in to them on a miss
+/// </summary>
+class MD2KeyframeCache
+{
+public:
+	//Constructors / Destructors
+	MD2KeyframeCache();
+	~MD2KeyframeCache();
+
+	//Create and Destroy functions
+	bool Create(const unsigned int a_iNumVertices, const unsigned int a_iNumFrames, const size_t a_iBudgetBytes);
+	void Destroy();
+
+	float* Acquire(const unsigned int a_iFrame, bool& a_bOutNeedsDecode);
+	MD2KeyframeSoA GetKeyframe(const float* a_pSlot) const;
+	float* GetStream(float* a_pSlot, const unsigned int a_iStream) const;
+	void ResetCounters();
+
+	//Getters
+	bool IsCreated() const { return m_pSlots != nullptr; }
+	unsigned int GetNumSlots() const { return m_iNumSlots; }
+	size_t GetMemoryUsed() const { return m_iSlotLength * sizeof(float) * m_iNumSlots; }
+	unsigned long long GetNumHits() const { return m_iNumHits; }
+	unsigned long long GetNumMisses() const { return m_iNumMisses; }
+
+	static size_t GetFrameSize(const unsigned int a_iNumVertices);
+
+private:
+
+	//The cache owns its slots so can not be copied
+	MD2KeyframeCache(const MD2KeyframeCache&) = delete;
+	MD2KeyframeCache& operator=(const MD2KeyframeCache&) = delete;
+
+	void MoveToFront(const int a_iSlot);
+
+	float* m_pSlots;
+	size_t m_iStreamLength;
+	size_t m_iSlotLength;
+	unsigned int m_iNumSlots;
+
+	//Slot each frame is held in and the frame held in each slot, -1 if none
+	std::vector<int> m_frameSlots;
+	std::vector<int> m_slotFrames;
+
+	//Slots in order of use, from the most recently used at the head to the
+	//least recently used at the tail
+	std::vector<int> m_slotPrev;
+	std::vector<int> m_slotNext;
+	int m_iHead;
+	int m_iTail;
+
+	unsigned long long m_iNumHits;
+	unsigned long long m_iNumMisses;
+};
+
+#endif // !__MD2_KEYFRAME_CACHE_H__
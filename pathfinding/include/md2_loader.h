@@ -2,6 +2,11 @@
 
 #include <glm/glm.hpp>
 
+#include "mapped_file.h"
+#include "md2_animation_table.h"
+#include "md2_interpolator.h"
+#include "md2_keyframe_cache.h"
+
 #ifndef __MD2_LOADER_H__
 #define __MD2_LOADER_H__
 
@@ -36,6 +41,79 @@ public:
 
 inline MD2Vertex::MD2Vertex() : position(0, 0, 0, 1), normal(0, 0, 0, 0), colour(1, 1, 1, 1), texCoord1(0, 0) {}
 inline MD2Vertex::~MD2Vertex() {}
+
+/*Attributes of a vertex that are the same in every frame, these are written
+once and do not need to be uploaded again*/
+class MD2StaticVertex
+{
+public:
+
+	enum Offsets
+	{
+		ColourOffset = 0,
+		TexCoord1Offset = ColourOffset + sizeof(glm::vec4),
+	};
+
+	glm::vec4	colour;
+	glm::vec2	texCoord1;
+};
+
+/*Attributes of a vertex that change every frame of animation*/
+class MD2DynamicVertex
+{
+public:
+
+	enum Offsets
+	{
+		PositionOffset = 0,
+		NormalOffset = PositionOffset + sizeof(glm::vec3),
+	};
+
+	glm::vec3	position;
+	glm::vec3	normal;
+};
+
+/*Attributes of a vertex that change every frame of animation with the normal
+packed in to 4 bytes, how it is packed depends on the MD2_NORMAL_FORMAT*/
+class MD2PackedVertex
+{
+public:
+
+	enum Offsets
+	{
+		PositionOffset = 0,
+		NormalOffset = PositionOffset + sizeof(glm::vec3),
+	};
+
+	glm::vec3		position;
+	unsigned int	normal;
+};
+
+//How vertex attributes are laid out in the buffers given to the GPU
+typedef enum {
+	MD2_VERTEX_LAYOUT_INTERLEAVED,	//Every attribute in one MD2Vertex buffer
+	MD2_VERTEX_LAYOUT_SPLIT,		//Static attributes and per frame attributes in seperate buffers
+
+	MD2_VERTEX_LAYOUT_COUNT /*Total number of layouts*/
+} MD2_VERTEX_LAYOUT;
+
+//How normals are held in the per frame stream of the split vertex layout
+typedef enum {
+	MD2_NORMAL_FORMAT_FLOAT,		//Interpolated normal as 3 floats in an MD2DynamicVertex
+	MD2_NORMAL_FORMAT_INDEX,		//MD2 normal index of the current and next frame in the low 2 bytes, interpolated by the shader
+	MD2_NORMAL_FORMAT_OCTAHEDRAL,	//Interpolated and renormalised normal as 2 octahedral 16 bit values
+
+	MD2_NORMAL_FORMAT_COUNT /*Total number of formats*/
+} MD2_NORMAL_FORMAT;
+
+//Where a model's vertices are interpolated between keyframes
+typedef enum {
+	MD2_INTERPOLATION_CPU,	//Vertices are interpolated on the CPU and given to the GPU every frame
+	MD2_INTERPOLATION_GPU,	//Every keyframe is given to the GPU once and the vertex shader interpolates them
+	MD2_INTERPOLATION_TEXTURE,	//Every keyframe is baked in to textures that the vertex shader samples
+
+	MD2_INTERPOLATION_COUNT /*Total number of modes*/
+} MD2_INTERPOLATION_MODE;
 typedef struct MD2Header
 {
 	int ident;				//Magic Number must be equal to "IDP2" 
@@ -79,12 +157,36 @@ typedef struct MD2CompressedVertex {
 	unsigned char normalIndex;
 }MD2CompressedVertex;
 
+/*Frame header as it is stored in the file, followed by num_vertices
+compressed vertices*/
+typedef struct MD2FileFrame {
+	glm::vec3 scale;
+	glm::vec3 translate;
+	char name[MD2_FRAME_NAME_LENGTH];
+}MD2FileFrame;
+
+/*Model space volumes that hold every vertex of a frame*/
+typedef struct MD2FrameBounds {
+	glm::vec3 min;
+	glm::vec3 max;
+	glm::vec3 centre;
+	float radius;
+}MD2FrameBounds;
+
 typedef struct MD2Frame {
 	glm::vec3 scale;
 	glm::vec3 translate;
-	char* name[16];
-	MD2CompressedVertex* verts;
-};
+	char name[MD2_FRAME_NAME_LENGTH];
+	const MD2CompressedVertex* verts;
+	MD2FrameBounds bounds;
+}MD2Frame;
+
+/*Unique pairing of a frame vertex and a texture coordinate, triangles
+that share a pair share the same output vertex*/
+typedef struct MD2WeldedVertex {
+	unsigned short vertex;
+	unsigned short st;
+}MD2WeldedVertex;
 
 typedef struct MD2GLCmd {
 	float s;
@@ -92,21 +194,41 @@ typedef struct MD2GLCmd {
 	int index;
 }MD2GLCmd;
 
+/*Section pointers either point in to the models arena or are views in to a
+mapping of the file, depending on how the model was loaded*/
 typedef struct MD2Mesh{
-	MD2Header		m_header;
-	MD2Skin*		m_pSkins;
-	MD2TextCoord*	m_pTextcoords;
-	MD2Triangle*	m_pTriangles;
-	MD2Frame*		m_pFrames;
-	int*			m_glcmds;
-	unsigned int*	m_textureID;
+	MD2Header				m_header;
+	const MD2Skin*			m_pSkins;
+	const MD2TextCoord*		m_pTextcoords;
+	const MD2Triangle*		m_pTriangles;
+	MD2Frame*				m_pFrames;
+	const int*				m_glcmds;
+	unsigned int*			m_textureID;
+
+	const MD2WeldedVertex*	m_pWeldedVerts;		//Unique vertex/texture coordinate pairs
+	const unsigned short*	m_pIndices;			//Welded vertex used by each triangle corner
+	int						m_iNumWeldedVerts;
 
 }MD2Mesh;
 
-typedef struct MD2Animation {
-	unsigned int start;
-	unsigned int end;
-}MD2Animation;
+/*Frames an animation is between and how far it is from the current frame to
+the next, one side of a blend between two animations*/
+typedef struct MD2AnimationPose {
+	unsigned int currentFrame;
+	unsigned int nextFrame;
+	float interpolation;
+}MD2AnimationPose;
+
+//Layout of the single block of memory a model is held in
+struct MD2ArenaLayout;
+
+//How the model file is brought in to memory
+typedef enum {
+	MD2_LOAD_MODE_READ,		//Sections are read in to the models arena
+	MD2_LOAD_MODE_MAPPED,	//File is mapped read only and sections are views in to the mapping
+
+	MD2_LOAD_MODE_COUNT /*Total number of modes*/
+} MD2_LOAD_MODE;
 
 class MD2Model
 {
@@ -114,18 +236,81 @@ public:
 	MD2Model();
 	~MD2Model();
 
-	bool Load(const char* a_filename, float a_scale);
-	MD2Vertex* GetVertexBufferData(const unsigned int a_frame,const glm::vec3 a_pos);
-	MD2Vertex* GetInterpolatedData(const unsigned int a_iCurrentFrameID, const unsigned int a_iNextFrameID, const float a_fInterpAmounnt, const glm::vec3 a_pos);
-	unsigned int GetNumVerts();
-	unsigned int GetTextureID(int a_iSkinID);
+	bool Load(const char* a_filename, float a_scale, MD2_LOAD_MODE a_eLoadMode = MD2_LOAD_MODE_READ);
+	MD2Vertex* GetVertexBufferData(const unsigned int a_frame) const;
+	bool GetVertexBufferData(const unsigned int a_frame, MD2Vertex* a_pOutVertices, const unsigned int a_iNumOutVertices) const;
+	MD2Vertex* GetInterpolatedData(const unsigned int a_iCurrentFrameID, const unsigned int a_iNextFrameID, const float a_fInterpAmounnt) const;
+	bool GetInterpolatedData(const unsigned int a_iCurrentFrameID, const unsigned int a_iNextFrameID, const float a_fInterpAmount, MD2Vertex* a_pOutVertices, const unsigned int a_iNumOutVertices, MD2KeyframeCache* a_pKeyframeCache = nullptr) const;
+	bool GetInterpolatedData(const unsigned int a_iCurrentFrameID, const unsigned int a_iNextFrameID, const float a_fInterpAmount, MD2DynamicVertex* a_pOutVertices, const unsigned int a_iNumOutVertices, MD2KeyframeCache* a_pKeyframeCache = nullptr) const;
+	bool GetInterpolatedData(const unsigned int a_iCurrentFrameID, const unsigned int a_iNextFrameID, const float a_fInterpAmount, MD2PackedVertex* a_pOutVertices, const unsigned int a_iNumOutVertices, MD2_NORMAL_FORMAT a_eNormalFormat, MD2KeyframeCache* a_pKeyframeCache = nullptr) const;
+	bool GetBlendedData(const MD2AnimationPose& a_from, const MD2AnimationPose& a_to, const float a_fBlendAmount, MD2Vertex* a_pOutVertices, const unsigned int a_iNumOutVertices, MD2KeyframeCache* a_pKeyframeCache = nullptr) const;
+	bool GetBlendedData(const MD2AnimationPose& a_from, const MD2AnimationPose& a_to, const float a_fBlendAmount, MD2DynamicVertex* a_pOutVertices, const unsigned int a_iNumOutVertices, MD2KeyframeCache* a_pKeyframeCache = nullptr) const;
+	bool GetBlendedData(const MD2AnimationPose& a_from, const MD2AnimationPose& a_to, const float a_fBlendAmount, MD2PackedVertex* a_pOutVertices, const unsigned int a_iNumOutVertices, MD2_NORMAL_FORMAT a_eNormalFormat, MD2KeyframeCache* a_pKeyframeCache = nullptr) const;
+	bool GetKeyframeData(MD2PackedVertex* a_pOutVertices, const unsigned int a_iNumOutVertices, MD2_NORMAL_FORMAT a_eNormalFormat) const;
+	bool InitialiseVertexBuffer(MD2Vertex* a_pOutVertices, const unsigned int a_iNumOutVertices) const;
+	bool InitialiseStaticVertexBuffer(MD2StaticVertex* a_pOutVertices, const unsigned int a_iNumOutVertices) const;
+	bool CreateKeyframeCache(const size_t a_iBudgetBytes);
+	bool CreateKeyframeCache(MD2KeyframeCache& a_keyframeCache, const size_t a_iBudgetBytes) const;
+	unsigned int CountISAMismatches(MD2Interpolator::MD2_ISA a_eISA, const float* a_pInterpAmounts, const unsigned int a_iNumInterpAmounts) const;
+	bool HasKeyframeCache() const { return m_keyframeCache.IsCreated(); }
+	const MD2KeyframeCache& GetKeyframeCache() const { return m_keyframeCache; }
+	void ResetKeyframeCacheCounters() const { m_keyframeCache.ResetCounters(); }
+	unsigned int GetNumVerts() const;
+	unsigned int GetNumFrames() const;
+	unsigned int GetNumUniqueVerts() const;
+	unsigned int GetNumIndices() const;
+	const unsigned short* GetIndices() const;
+	unsigned int GetTextureID(int a_iSkinID) const;
+	const MD2AnimationTable& GetAnimationTable() const { return m_animationTable; }
+	bool GetFrameBounds(const unsigned int a_frame, MD2FrameBounds& a_outBounds) const;
+	bool GetInterpolatedBounds(const unsigned int a_iCurrentFrameID, const unsigned int a_iNextFrameID, const float a_fInterpAmount, MD2FrameBounds& a_outBounds) const;
+	const MD2FrameBounds& GetAnimationBounds() const { return m_animationBounds; }
 
 private:
+	bool LoadFromStream(const char* a_filename);
+	bool LoadFromMapping(const char* a_filename);
+	void LoadSkinTextures(const char* a_filename);
+	bool WeldVertices(const MD2ArenaLayout& a_layout);
+	void CalculateFrameBounds();
+	MD2ArenaLayout CreateArena(const MD2Header& a_header, bool a_bCopySections);
+	void Unload();
+
+	const MD2Frame* GetFrame(const unsigned int a_frame) const;
+	void InterpolateFrames(const MD2Frame* a_pCurrentFrame, const MD2Frame* a_pNextFrame, const float a_fInterpAmount, const MD2VertexStream& a_out) const;
+	void PackNormals(const MD2Frame* a_pCurrentFrame, const MD2Frame* a_pNextFrame, const float a_fInterpAmount, MD2_NORMAL_FORMAT a_eNormalFormat, MD2PackedVertex* a_pOutVertices) const;
+	void BlendFrames(const MD2Frame* (&a_pFrames)[MD2_BLEND_FRAME_COUNT], const float a_fFromInterpAmount, const float a_fToInterpAmount, const float a_fBlendAmount, const MD2VertexStream& a_out) const;
+	void PackBlendedNormals(const MD2Frame* (&a_pFrames)[MD2_BLEND_FRAME_COUNT], const float a_fFromInterpAmount, const float a_fToInterpAmount, const float a_fBlendAmount, MD2_NORMAL_FORMAT a_eNormalFormat, MD2PackedVertex* a_pOutVertices) const;
+	void BlendToStream(const MD2AnimationPose& a_from, const MD2AnimationPose& a_to, const float a_fBlendAmount, const MD2VertexStream& a_out, MD2KeyframeCache* a_pKeyframeCache) const;
+	void InterpolateToStream(const unsigned int a_iCurrentFrameID, const unsigned int a_iNextFrameID, const float a_fInterpAmount, const MD2VertexStream& a_out, MD2KeyframeCache* a_pKeyframeCache) const;
+	MD2KeyframeSoA GetCachedKeyframe(const unsigned int a_frame, MD2KeyframeCache& a_keyframeCache) const;
+	void DecodeKeyframe(const MD2Frame* a_pFrame, float* a_pSlot, const MD2KeyframeCache& a_keyframeCache) const;
+	MD2Vertex GetVertex(const MD2Frame* a_pFrame, const int a_iTriangle, const int a_iCorner) const;
+
+	static bool ValidateHeader(const MD2Header& a_header, size_t a_fileLength);
+	static bool ValidateTriangles(const MD2Header& a_header, const MD2Triangle* a_pTriangles);
+	static bool ValidateFrames(const MD2Header& a_header, const MD2Frame* a_pFrames);
+	static bool IsMappingAligned(const MD2Header& a_header);
+
 	glm::mat4 m_globalTransform;
 	float m_fScale;
 	char* m_pmd2Filename;
 	MD2Mesh* m_pModel;
 	bool m_bHasAnimation;
+	unsigned char* m_pArena;
+
+	//Recently used keyframes decoded in to model space, the cache is only a
+	//record of work already done so is updated from const functions. Threads
+	//animating a shared model at the same time must pass their own caches
+	mutable MD2KeyframeCache m_keyframeCache;
+
+	//Animations found in the frame names when the model was loaded
+	MD2AnimationTable m_animationTable;
+
+	//Bounds that hold every frame, each frame's own bounds are kept with it.
+	//Interpolated bounds are grown by a fraction of the models size
+	MD2FrameBounds m_animationBounds;
+	const float mc_fBoundsPadding = 1e-5f;
+	MappedFile m_mappedFile;
 };
 
 
@@ -0,0 +1,51 @@
+#pragma once
+
+#ifndef __MD2_MODEL_MANAGER_H__
+#define __MD2_MODEL_MANAGER_H__
+
+//Project Includes
+#include "Manager.h"
+
+//C Includes
+#include <map>
+#include <string>
+#include <utility>
+
+//Forward Declerations
+class MD2Model;
+
+/// <summary>
+/// Loads each MD2 model once and shares it between everything that uses it.
+/// Models are handed out read only and ref counted, the model is unloaded once
+/// the last user releases it
+/// </summary>
+class MD2ModelManager : public Manager<MD2ModelManager> {
+	friend class Manager<MD2ModelManager>;
+public:
+
+	const MD2Model* AcquireModel(const char* a_pFilename, float a_fScale);
+	void ReleaseModel(const MD2Model* a_pModel);
+	unsigned int GetNumModels() const;
+
+protected:
+	//Constructor and Destructor
+	MD2ModelManager();
+	~MD2ModelManager();
+
+private:
+
+	//Model Ref counts the number of users of a model, when this count falls
+	//to zero the model is unloaded from memory
+	struct ModelRef {
+		MD2Model* pModel;
+		unsigned int refCount;
+	};
+
+	//The scale is baked in to a models decoded vertices so the same file at
+	//two scales is two models
+	typedef std::pair<std::string, float> ModelKey;
+
+	std::map<ModelKey, ModelRef> m_pModelDictonary;
+};
+
+#endif // ! __MD2_MODEL_MANAGER_H__
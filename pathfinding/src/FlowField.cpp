@@ -0,0 +1,144 @@
+#include "FlowField.h"
+
+#include "Maze.h"
+
+const unsigned char FlowField::NO_DIRECTION;
+
+//Neighbours are visited in the same order as Maze::GetAdjacentPositions
+static const int s_iDirectionX[4] = { 1, -1, 0, 0 };
+static const int s_iDirectionY[4] = { 0, 0, 1, -1 };
+
+/// <summary>
+/// Create an empty field
+/// </summary>
+FlowField::FlowField()
+{
+	m_iWidth = 0;
+	m_iHeight = 0;
+	m_iNumTilesReached = 0;
+}
+
+/// <summary>
+/// Builds the field with a breadth first search out from every goal at once.
+/// Each tile steps towards the tile it was first reached from
+/// </summary>
+/// <param name="a_pWalls">Tiles that can't be walked on, tile (x, y) is at y * width + x</param>
+/// <param name="a_iWidth">Number of tiles across</param>
+/// <param name="a_iHeight">Number of tiles down</param>
+/// <param name="a_pGoals">Tiles to head towards, goals in walls or outside the grid are skipped</param>
+/// <param name="a_iNumGoals">Number of goals</param>
+/// <returns>If any goal could be used</returns>
+bool FlowField::Build(const bool* a_pWalls, unsigned int a_iWidth, unsigned int a_iHeight, const Position* a_pGoals, unsigned int a_iNumGoals)
+{
+	m_iWidth = a_iWidth;
+	m_iHeight = a_iHeight;
+	m_iNumTilesReached = 0;
+	m_distances.assign((size_t)a_iWidth * a_iHeight, -1);
+	m_directions.assign((size_t)a_iWidth * a_iHeight, NO_DIRECTION);
+	m_queue.clear();
+
+	if (a_pWalls == nullptr || a_pGoals == nullptr) {
+		return false;
+	}
+
+	for (unsigned int i = 0; i < a_iNumGoals; ++i) {
+		if (!IsInside(a_pGoals[i])) {
+			continue;
+		}
+		const unsigned int iGoal = (a_pGoals[i].y * m_iWidth) + a_pGoals[i].x;
+		if (a_pWalls[iGoal] || m_distances[iGoal] == 0) {
+			continue;
+		}
+		m_distances[iGoal] = 0;
+		m_queue.push_back(iGoal);
+	}
+
+	for (size_t iHead = 0; iHead < m_queue.size(); ++iHead) {
+		const unsigned int iCurrent = m_queue[iHead];
+		const int x = (int)(iCurrent % m_iWidth);
+		const int y = (int)(iCurrent / m_iWidth);
+		const int iNeighbourDistance = m_distances[iCurrent] + 1;
+		for (unsigned int i = 0; i < 4; ++i) {
+			const int iNeighbourX = x + s_iDirectionX[i];
+			const int iNeighbourY = y + s_iDirectionY[i];
+			if (iNeighbourX < 0 || iNeighbourY < 0 || iNeighbourX >= (int)m_iWidth || iNeighbourY >= (int)m_iHeight) {
+				continue;
+			}
+			const unsigned int iNeighbour = (iNeighbourY * m_iWidth) + iNeighbourX;
+			if (a_pWalls[iNeighbour] || m_distances[iNeighbour] >= 0) {
+				continue;
+			}
+
+			//Stepping back the other way, direction i ^ 1, leads here
+			m_distances[iNeighbour] = iNeighbourDistance;
+			m_directions[iNeighbour] = (unsigned char)(i ^ 1u);
+			m_queue.push_back(iNeighbour);
+		}
+	}
+
+	m_iNumTilesReached = (unsigned int)m_queue.size();
+	m_queue.clear();
+	return m_iNumTilesReached > 0;
+}
+
+/// <summary>
+/// Frees the field
+/// </summary>
+void FlowField::Clear()
+{
+	m_iWidth = 0;
+	m_iHeight = 0;
+	m_iNumTilesReached = 0;
+	m_distances.clear();
+	m_directions.clear();
+	m_queue.clear();
+}
+
+/// <summary>
+/// Gets the tile to step to from a tile to get closer to the nearest goal
+/// </summary>
+/// <param name="a_tile">Tile to step from</param>
+/// <param name="a_outNextTile">Tile to step to</param>
+/// <returns>If there is a step to take, false at a goal or where no goal can be reached</returns>
+bool FlowField::GetNextTile(const Position& a_tile, Position& a_outNextTile) const
+{
+	const unsigned char iDirection = GetDirection(a_tile);
+	if (iDirection == NO_DIRECTION) {
+		return false;
+	}
+
+	a_outNextTile = Position(a_tile.x + s_iDirectionX[iDirection], a_tile.y + s_iDirectionY[iDirection]);
+	return true;
+}
+
+/// <summary>
+/// Gets the distance from a tile to the nearest goal
+/// </summary>
+/// <returns>Distance to the nearest goal, -1 if none can be reached</returns>
+int FlowField::GetDistance(const Position& a_tile) const
+{
+	if (!IsBuilt() || !IsInside(a_tile)) {
+		return -1;
+	}
+	return m_distances[(a_tile.y * m_iWidth) + a_tile.x];
+}
+
+/// <summary>
+/// Gets the direction to step from a tile to get closer to the nearest goal
+/// </summary>
+/// <returns>Direction (+x, -x, +y, -y), NO_DIRECTION at a goal or where no goal can be reached</returns>
+unsigned char FlowField::GetDirection(const Position& a_tile) const
+{
+	if (!IsBuilt() || !IsInside(a_tile)) {
+		return NO_DIRECTION;
+	}
+	return m_directions[(a_tile.y * m_iWidth) + a_tile.x];
+}
+
+/// <summary>
+/// Checks if a tile is inside the field
+/// </summary>
+bool FlowField::IsInside(const Position& a_tile) const
+{
+	return a_tile.x >= 0 && a_tile.y >= 0 && a_tile.x < (int)m_iWidth && a_tile.y < (int)m_iHeight;
+}
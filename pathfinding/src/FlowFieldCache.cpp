@@ -0,0 +1,151 @@
+#include "FlowFieldCache.h"
+
+#include "Maze.h"
+
+/// <summary>
+/// Create a cache with a number of slots, a slot only allocates its field
+/// when it is first used
+/// </summary>
+/// <param name="a_iNumSlots">Most fields to keep at once, at least 1</param>
+FlowFieldCache::FlowFieldCache(unsigned int a_iNumSlots)
+{
+	m_pWalls = nullptr;
+	m_iWidth = 0;
+	m_iHeight = 0;
+	m_fields.resize(a_iNumSlots > 0 ? a_iNumSlots : 1);
+	m_iHead = -1;
+	m_iTail = -1;
+	ResetCounters();
+	Clear();
+}
+
+/// <summary>
+/// Sets the grid the fields are built over and empties the cache
+/// </summary>
+/// <param name="a_pWalls">Tiles that can't be walked on, tile (x, y) is at y * width + x</param>
+/// <param name="a_iWidth">Number of tiles across</param>
+/// <param name="a_iHeight">Number of tiles down</param>
+void FlowFieldCache::SetGrid(const bool* a_pWalls, unsigned int a_iWidth, unsigned int a_iHeight)
+{
+	m_pWalls = a_pWalls;
+	m_iWidth = a_iWidth;
+	m_iHeight = a_iHeight;
+	Clear();
+}
+
+/// <summary>
+/// Empties the cache, this needs calling whenever the walls change. The
+/// slots keep their memory to be rebuilt in to
+/// </summary>
+void FlowFieldCache::Clear()
+{
+	const unsigned int iNumSlots = GetNumSlots();
+	m_goalSlots.clear();
+	m_slotGoals.assign(iNumSlots, -1);
+	m_slotPrev.resize(iNumSlots);
+	m_slotNext.resize(iNumSlots);
+	for (unsigned int i = 0; i < iNumSlots; ++i) {
+		m_slotPrev[i] = (int)i - 1;
+		m_slotNext[i] = (i + 1 < iNumSlots) ? (int)i + 1 : -1;
+	}
+	m_iHead = 0;
+	m_iTail = (int)iNumSlots - 1;
+}
+
+/// <summary>
+/// Gets the field heading to a goal and marks it as the most recently used.
+/// If the goal is not in the cache the least recently used slot is rebuilt
+/// for it
+/// </summary>
+/// <param name="a_goal">Tile to head to</param>
+/// <param name="a_bOutBuilt">Set if the field had to be built</param>
+/// <returns>Field for the goal, nullptr if the goal is a wall or outside the grid</returns>
+const FlowField* FlowFieldCache::Acquire(const Position& a_goal, bool& a_bOutBuilt)
+{
+	a_bOutBuilt = false;
+	if (m_pWalls == nullptr || a_goal.x < 0 || a_goal.y < 0 || a_goal.x >= (int)m_iWidth || a_goal.y >= (int)m_iHeight) {
+		return nullptr;
+	}
+
+	const unsigned int iGoal = (a_goal.y * m_iWidth) + a_goal.x;
+	if (m_pWalls[iGoal]) {
+		return nullptr;
+	}
+
+	int iSlot;
+	std::unordered_map<unsigned int, int>::const_iterator it = m_goalSlots.find(iGoal);
+	if (it == m_goalSlots.end()) {
+		++m_iNumMisses;
+
+		//Take the least recently used slot from whichever goal had it
+		iSlot = m_iTail;
+		if (m_slotGoals[iSlot] != -1) {
+			m_goalSlots.erase((unsigned int)m_slotGoals[iSlot]);
+		}
+		m_slotGoals[iSlot] = (int)iGoal;
+		m_goalSlots[iGoal] = iSlot;
+
+		m_fields[iSlot].Build(m_pWalls, m_iWidth, m_iHeight, &a_goal, 1);
+		a_bOutBuilt = true;
+	}
+	else {
+		++m_iNumHits;
+		iSlot = it->second;
+	}
+
+	MoveToFront(iSlot);
+	return &m_fields[iSlot];
+}
+
+/// <summary>
+/// Gets the field heading to a goal if it is cached, nothing is built and the
+/// counters and order of use are left as they are
+/// </summary>
+/// <param name="a_goal">Tile to head to</param>
+/// <returns>Field for the goal, nullptr if it isn't cached</returns>
+const FlowField* FlowFieldCache::Find(const Position& a_goal) const
+{
+	if (m_pWalls == nullptr || a_goal.x < 0 || a_goal.y < 0 || a_goal.x >= (int)m_iWidth || a_goal.y >= (int)m_iHeight) {
+		return nullptr;
+	}
+
+	std::unordered_map<unsigned int, int>::const_iterator it = m_goalSlots.find((a_goal.y * m_iWidth) + a_goal.x);
+	return (it != m_goalSlots.end()) ? &m_fields[it->second] : nullptr;
+}
+
+/// <summary>
+/// Sets the hit and miss counters back to zero
+/// </summary>
+void FlowFieldCache::ResetCounters()
+{
+	m_iNumHits = 0;
+	m_iNumMisses = 0;
+}
+
+/// <summary>
+/// Moves a slot to the head of the use list
+/// </summary>
+/// <param name="a_iSlot">Slot that has just been used</param>
+void FlowFieldCache::MoveToFront(const int a_iSlot)
+{
+	if (a_iSlot == m_iHead) {
+		return;
+	}
+
+	//Unlink the slot, it can't be the head so always has a previous slot
+	const int iPrev = m_slotPrev[a_iSlot];
+	const int iNext = m_slotNext[a_iSlot];
+	m_slotNext[iPrev] = iNext;
+	if (iNext != -1) {
+		m_slotPrev[iNext] = iPrev;
+	}
+	else {
+		m_iTail = iPrev;
+	}
+
+	//Link it back in at the head
+	m_slotPrev[a_iSlot] = -1;
+	m_slotNext[a_iSlot] = m_iHead;
+	m_slotPrev[m_iHead] = a_iSlot;
+	m_iHead = a_iSlot;
+}
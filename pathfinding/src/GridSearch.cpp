@@ -0,0 +1,640 @@
+#include "GridSearch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "Maze.h"
+
+//Neighbours are visited in the same order as Maze::GetAdjacentPositions
+static const int s_iDirectionX[4] = { 1, -1, 0, 0 };
+static const int s_iDirectionY[4] = { 0, 0, 1, -1 };
+
+/// <summary>
+/// Create a search with no grid
+/// </summary>
+GridSearch::GridSearch()
+{
+	m_pWalls = nullptr;
+	m_iWidth = 0;
+	m_iHeight = 0;
+	m_iMinX = 0;
+	m_iMinY = 0;
+	m_iMaxX = 0;
+	m_iMaxY = 0;
+	m_iGeneration = 0;
+	m_fWeight = 1.f;
+	m_iNumNodesExpanded = 0;
+}
+
+/// <summary>
+/// Sets the grid to search, the node arrays are only reallocated when the
+/// number of tiles changes. Any jump table and bounds are removed
+/// </summary>
+/// <param name="a_pWalls">Tiles that can't be walked on, tile (x, y) is at y * width + x</param>
+/// <param name="a_iWidth">Number of tiles across</param>
+/// <param name="a_iHeight">Number of tiles down</param>
+void GridSearch::SetGrid(const bool* a_pWalls, unsigned int a_iWidth, unsigned int a_iHeight)
+{
+	m_pWalls = a_pWalls;
+	m_iWidth = a_iWidth;
+	m_iHeight = a_iHeight;
+	ClearBounds();
+
+	const size_t iNumNodes = (size_t)a_iWidth * a_iHeight;
+	if (m_generations.size() != iNumNodes) {
+		m_generations.assign(iNumNodes, 0);
+		m_distances.resize(iNumNodes);
+		m_estimates.resize(iNumNodes);
+		m_parents.resize(iNumNodes);
+		m_heapIndices.resize(iNumNodes);
+		m_directions.resize(iNumNodes);
+		m_iGeneration = 0;
+	}
+	m_jumpDistances.clear();
+}
+
+/// <summary>
+/// Finds the shortest path between two tiles with Dijkstra's algorithm, or
+/// A* when given a heuristic. Where there is more than one shortest path,
+/// each tile on the path steps to the first neighbour (+x, -x, +y, -y) that
+/// is a step closer to the start out of those the search reached, so
+/// Dijkstra finds the same path the map based search found
+/// </summary>
+/// <param name="a_start">Tile to start at</param>
+/// <param name="a_end">Tile to finish at</param>
+/// <param name="a_finalPath">Path from the end back to the start, empty if there is no path</param>
+/// <param name="a_eHeuristic">Estimate of the distance left to the end</param>
+/// <param name="a_fWeight">Amount to scale the estimate by, at least 1. Paths are at most this many times longer than the shortest</param>
+/// <returns>If a path was found</returns>
+bool GridSearch::FindPath(const Position& a_start, const Position& a_end, std::vector<Position>& a_finalPath,
+	GRID_HEURISTIC a_eHeuristic, float a_fWeight)
+{
+	a_finalPath.clear();
+	m_iNumNodesExpanded = 0;
+
+	//Make sure that the path doesn't end or start in a wall
+	if (!IsWalkable(a_start.x, a_start.y) || !IsWalkable(a_end.x, a_end.y)) {
+		return false;
+	}
+
+	m_fWeight = (a_fWeight > 1.f) ? a_fWeight : 1.f;
+	BeginSearch();
+
+	const unsigned int iStart = (a_start.y * m_iWidth) + a_start.x;
+	const unsigned int iEnd = (a_end.y * m_iWidth) + a_end.x;
+	m_generations[iStart] = m_iGeneration;
+	m_distances[iStart] = 0;
+	m_estimates[iStart] = GetHeuristic(a_eHeuristic, a_end.x - a_start.x, a_end.y - a_start.y);
+	m_parents[iStart] = NO_NODE;
+	HeapPush(iStart);
+
+	bool bFound = false;
+	while (!m_heap.empty()) {
+		const unsigned int iCurrent = HeapPop();
+		++m_iNumNodesExpanded;
+
+		if (iCurrent == iEnd) {
+			bFound = true;
+			break;
+		}
+
+		const int iNeighbourDistance = m_distances[iCurrent] + 1;
+		for (unsigned int i = 0; i < 4; ++i) {
+			const unsigned int iNeighbour = GetNeighbour(iCurrent, i);
+			if (iNeighbour == NO_NODE) {
+				continue;
+			}
+
+			if (!IsTouched(iNeighbour)) {
+				m_generations[iNeighbour] = m_iGeneration;
+				m_distances[iNeighbour] = iNeighbourDistance;
+				m_estimates[iNeighbour] = GetHeuristic(a_eHeuristic,
+					a_end.x - (int)(iNeighbour % m_iWidth), a_end.y - (int)(iNeighbour / m_iWidth));
+				m_parents[iNeighbour] = iCurrent;
+				HeapPush(iNeighbour);
+				continue;
+			}
+
+			//Closed nodes are never reopened, with a weight above 1 this
+			//can only lengthen the path within the weight's bound
+			if (m_heapIndices[iNeighbour] == CLOSED) {
+				continue;
+			}
+
+			//The neighbour steps back along its first direction that is a
+			//step closer, so keep whichever parent it reaches first
+			if (iNeighbourDistance < m_distances[iNeighbour]) {
+				m_distances[iNeighbour] = iNeighbourDistance;
+				m_parents[iNeighbour] = iCurrent;
+				HeapSiftUp(m_heapIndices[iNeighbour]);
+			}
+			else if (iNeighbourDistance == m_distances[iNeighbour]) {
+				const unsigned int iParent = m_parents[iNeighbour];
+				for (unsigned int j = 0; j < 4; ++j) {
+					const unsigned int iCandidate = GetNeighbour(iNeighbour, j);
+					if (iCandidate == iCurrent || iCandidate == iParent) {
+						m_parents[iNeighbour] = iCandidate;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	if (!bFound) {
+		return false;
+	}
+
+	//Walk back from the end to the start
+	for (unsigned int iNode = iEnd; iNode != NO_NODE; iNode = m_parents[iNode]) {
+		a_finalPath.push_back(Position((int)(iNode % m_iWidth), (int)(iNode / m_iWidth)));
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Finds the shortest path between two tiles with Jump Point Search. Every
+/// shortest path on a grid without diagonals can be reordered so it only
+/// turns from moving across to moving up or down where a wall stops it
+/// turning a tile earlier, these are the jump points. Moving up or down it
+/// stops where moving across would reach a jump point, or on the end's row.
+/// The path is the same length as the one Dijkstra finds but may take a
+/// different route when there is more than one. Falls back to A* when there
+/// is no jump table or the search has bounds
+/// </summary>
+/// <param name="a_start">Tile to start at</param>
+/// <param name="a_end">Tile to finish at</param>
+/// <param name="a_finalPath">Path from the end back to the start, empty if there is no path</param>
+/// <returns>If a path was found</returns>
+bool GridSearch::FindJumpPath(const Position& a_start, const Position& a_end, std::vector<Position>& a_finalPath)
+{
+	//The jump distances run to the edge of the grid, not the bounds
+	const bool bHasBounds = m_iMinX != 0 || m_iMinY != 0 || m_iMaxX != (int)m_iWidth || m_iMaxY != (int)m_iHeight;
+	if (!HasJumpTable() || bHasBounds) {
+		return FindPath(a_start, a_end, a_finalPath, GRID_HEURISTIC_MANHATTAN);
+	}
+
+	a_finalPath.clear();
+	m_iNumNodesExpanded = 0;
+
+	//Make sure that the path doesn't end or start in a wall
+	if (!IsWalkable(a_start.x, a_start.y) || !IsWalkable(a_end.x, a_end.y)) {
+		return false;
+	}
+
+	m_fWeight = 1.f;
+	BeginSearch();
+
+	const unsigned int iStart = (a_start.y * m_iWidth) + a_start.x;
+	const unsigned int iEnd = (a_end.y * m_iWidth) + a_end.x;
+	TouchNode(iStart, NO_NODE, 0, GetHeuristic(GRID_HEURISTIC_MANHATTAN, a_end.x - a_start.x, a_end.y - a_start.y));
+	m_directions[iStart] = NO_DIRECTION;
+
+	bool bFound = false;
+	while (!m_heap.empty()) {
+		const unsigned int iCurrent = HeapPop();
+		++m_iNumNodesExpanded;
+
+		if (iCurrent == iEnd) {
+			bFound = true;
+			break;
+		}
+
+		//Jump every way but back the way we came, a shortest path never
+		//doubles back
+		const unsigned char iArrivedFrom = m_directions[iCurrent];
+		for (unsigned int i = 0; i < 4; ++i) {
+			if (iArrivedFrom != NO_DIRECTION && i == (iArrivedFrom ^ 1u)) {
+				continue;
+			}
+
+			const unsigned int iJumpPoint = Jump(iCurrent, i, a_end);
+			if (iJumpPoint == NO_NODE) {
+				continue;
+			}
+
+			const int x = (int)(iJumpPoint % m_iWidth);
+			const int y = (int)(iJumpPoint / m_iWidth);
+			const int iSteps = std::abs(x - (int)(iCurrent % m_iWidth)) + std::abs(y - (int)(iCurrent / m_iWidth));
+			if (TouchNode(iJumpPoint, iCurrent, m_distances[iCurrent] + iSteps,
+				GetHeuristic(GRID_HEURISTIC_MANHATTAN, a_end.x - x, a_end.y - y))) {
+				m_directions[iJumpPoint] = (unsigned char)i;
+			}
+		}
+	}
+
+	if (!bFound) {
+		return false;
+	}
+
+	//Walk back from the end to the start, filling in the tiles jumped over
+	a_finalPath.push_back(a_end);
+	for (unsigned int iNode = iEnd; m_parents[iNode] != NO_NODE; iNode = m_parents[iNode]) {
+		const unsigned int iParent = m_parents[iNode];
+		const unsigned int iDirection = m_directions[iNode] ^ 1u;
+		Position tile((int)(iNode % m_iWidth), (int)(iNode / m_iWidth));
+		const Position parentTile((int)(iParent % m_iWidth), (int)(iParent / m_iWidth));
+		while (!(tile == parentTile)) {
+			tile.x += s_iDirectionX[iDirection];
+			tile.y += s_iDirectionY[iDirection];
+			a_finalPath.push_back(tile);
+		}
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Builds the jump distances used by FindJumpPath, this needs calling again
+/// whenever the walls change. Grids too large for the distances to be stored
+/// are left without a table. The table covers the whole grid so any bounds
+/// are cleared
+/// </summary>
+void GridSearch::BuildJumpTable()
+{
+	m_jumpDistances.clear();
+	ClearBounds();
+	if (m_pWalls == nullptr || m_iWidth == 0 || m_iHeight == 0 ||
+		m_iWidth > MAX_JUMP_DISTANCE || m_iHeight > MAX_JUMP_DISTANCE) {
+		return;
+	}
+
+	m_jumpDistances.assign((size_t)m_iWidth * m_iHeight * 4, 0);
+	const int iWidth = (int)m_iWidth;
+	const int iHeight = (int)m_iHeight;
+
+	//Across, each tile takes its distance from the next tile along. The next
+	//tile is a jump point when there is a wall beside this tile that stops the
+	//path turning here instead
+	for (int y = 0; y < iHeight; ++y) {
+		for (unsigned int iDirection = 0; iDirection < 2; ++iDirection) {
+			const int dx = s_iDirectionX[iDirection];
+			for (int i = 0; i < iWidth; ++i) {
+				const int x = (dx > 0) ? (iWidth - 1 - i) : i;
+				if (!IsWalkable(x, y) || !IsWalkable(x + dx, y)) {
+					continue;
+				}
+				const unsigned int iNext = (y * m_iWidth) + (x + dx);
+				const int iNextDistance = GetJumpDistance(iNext, iDirection);
+				short& iDistance = m_jumpDistances[(((y * m_iWidth) + x) * 4) + iDirection];
+				if (IsForcedHorizontal(x + dx, y, dx)) {
+					iDistance = 1;
+				}
+				else {
+					iDistance = (short)((iNextDistance > 0) ? iNextDistance + 1 : iNextDistance - 1);
+				}
+			}
+		}
+	}
+
+	//Up and down, the next tile is a jump point when moving across from it
+	//reaches one
+	for (int x = 0; x < iWidth; ++x) {
+		for (unsigned int iDirection = 2; iDirection < 4; ++iDirection) {
+			const int dy = s_iDirectionY[iDirection];
+			for (int i = 0; i < iHeight; ++i) {
+				const int y = (dy > 0) ? (iHeight - 1 - i) : i;
+				if (!IsWalkable(x, y) || !IsWalkable(x, y + dy)) {
+					continue;
+				}
+				const unsigned int iNext = ((y + dy) * m_iWidth) + x;
+				const int iNextDistance = GetJumpDistance(iNext, iDirection);
+				short& iDistance = m_jumpDistances[(((y * m_iWidth) + x) * 4) + iDirection];
+				if (GetJumpDistance(iNext, 0) > 0 || GetJumpDistance(iNext, 1) > 0) {
+					iDistance = 1;
+				}
+				else {
+					iDistance = (short)((iNextDistance > 0) ? iNextDistance + 1 : iNextDistance - 1);
+				}
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Checks if a path moving across on to a tile can have to turn up or down
+/// there, which is when it could not have turned a tile earlier
+/// </summary>
+/// <param name="a_x">Tile moved on to</param>
+/// <param name="a_y">Tile moved on to</param>
+/// <param name="a_dx">Direction moved in, 1 or -1</param>
+/// <returns>If the tile is a jump point</returns>
+bool GridSearch::IsForcedHorizontal(int a_x, int a_y, int a_dx) const
+{
+	return (IsWalkable(a_x, a_y + 1) && !IsWalkable(a_x - a_dx, a_y + 1)) ||
+		(IsWalkable(a_x, a_y - 1) && !IsWalkable(a_x - a_dx, a_y - 1));
+}
+
+/// <summary>
+/// Jumps from a tile in a direction using the jump table. The end is a jump
+/// point when it is in line with the tile, and moving up or down also stops
+/// on the end's row so the end can be reached by moving across
+/// </summary>
+/// <param name="a_iNode">Tile to jump from</param>
+/// <param name="a_iDirection">Direction to jump in, (+x, -x, +y, -y)</param>
+/// <param name="a_end">Tile the search is finishing at</param>
+/// <returns>Jump point reached, NO_NODE if a wall is reached first</returns>
+unsigned int GridSearch::Jump(unsigned int a_iNode, unsigned int a_iDirection, const Position& a_end) const
+{
+	const int x = (int)(a_iNode % m_iWidth);
+	const int y = (int)(a_iNode / m_iWidth);
+	const int iDistance = GetJumpDistance(a_iNode, a_iDirection);
+	const int iRange = (iDistance > 0) ? iDistance : -iDistance;
+
+	int iSteps = (iDistance > 0) ? iDistance : 0;
+	if (a_iDirection < 2) {
+		const int iToEnd = (a_end.x - x) * s_iDirectionX[a_iDirection];
+		if (a_end.y == y && iToEnd > 0 && iToEnd <= iRange) {
+			iSteps = iToEnd;
+		}
+	}
+	else {
+		const int iToEnd = (a_end.y - y) * s_iDirectionY[a_iDirection];
+		if (iToEnd > 0 && iToEnd <= iRange) {
+			iSteps = iToEnd;
+		}
+	}
+
+	if (iSteps == 0) {
+		return NO_NODE;
+	}
+	return ((y + (s_iDirectionY[a_iDirection] * iSteps)) * m_iWidth) + (x + (s_iDirectionX[a_iDirection] * iSteps));
+}
+
+/// <summary>
+/// Reaches a node from a parent, adding it to the heap the first time it is
+/// reached and moving it up the heap when a shorter way to it is found
+/// </summary>
+/// <param name="a_iNode">Node reached</param>
+/// <param name="a_iParent">Node it was reached from</param>
+/// <param name="a_iDistance">Distance from the start through the parent</param>
+/// <param name="a_fEstimate">Estimated distance left to the end</param>
+/// <returns>If the node's parent was set</returns>
+bool GridSearch::TouchNode(unsigned int a_iNode, unsigned int a_iParent, int a_iDistance, float a_fEstimate)
+{
+	if (!IsTouched(a_iNode)) {
+		m_generations[a_iNode] = m_iGeneration;
+		m_distances[a_iNode] = a_iDistance;
+		m_estimates[a_iNode] = a_fEstimate;
+		m_parents[a_iNode] = a_iParent;
+		HeapPush(a_iNode);
+		return true;
+	}
+
+	if (m_heapIndices[a_iNode] == CLOSED || a_iDistance >= m_distances[a_iNode]) {
+		return false;
+	}
+
+	m_distances[a_iNode] = a_iDistance;
+	m_parents[a_iNode] = a_iParent;
+	HeapSiftUp(m_heapIndices[a_iNode]);
+	return true;
+}
+
+/// <summary>
+/// Estimates the distance between two tiles
+/// </summary>
+/// <param name="a_eHeuristic">Estimate to use</param>
+/// <param name="a_dx">Number of tiles across between the tiles</param>
+/// <param name="a_dy">Number of tiles down between the tiles</param>
+/// <returns>Estimated distance, never more than the shortest path on the grid</returns>
+float GridSearch::GetHeuristic(GRID_HEURISTIC a_eHeuristic, int a_dx, int a_dy)
+{
+	const float fDx = (float)std::abs(a_dx);
+	const float fDy = (float)std::abs(a_dy);
+	switch (a_eHeuristic) {
+	case GRID_HEURISTIC_MANHATTAN:
+		return fDx + fDy;
+	case GRID_HEURISTIC_OCTILE:
+		return std::max(fDx, fDy) + (0.41421356f * std::min(fDx, fDy));
+	case GRID_HEURISTIC_EUCLIDEAN:
+		return std::sqrt((fDx * fDx) + (fDy * fDy));
+	default:
+		return 0.f;
+	}
+}
+
+/// <summary>
+/// Finds the distance from a tile to every tile that can be reached from it
+/// within the bounds, read back with GetDistance. Every step costs the same
+/// so this is a breadth first search with the heap used as a queue
+/// </summary>
+/// <param name="a_start">Tile to find distances from</param>
+void GridSearch::FloodDistances(const Position& a_start)
+{
+	m_iNumNodesExpanded = 0;
+	BeginSearch();
+	if (!IsWalkable(a_start.x, a_start.y)) {
+		return;
+	}
+
+	const unsigned int iStart = (a_start.y * m_iWidth) + a_start.x;
+	m_generations[iStart] = m_iGeneration;
+	m_distances[iStart] = 0;
+	m_heap.push_back(iStart);
+
+	for (size_t iHead = 0; iHead < m_heap.size(); ++iHead) {
+		const unsigned int iCurrent = m_heap[iHead];
+		const int x = (int)(iCurrent % m_iWidth);
+		const int y = (int)(iCurrent / m_iWidth);
+		const int iNeighbourDistance = m_distances[iCurrent] + 1;
+		for (unsigned int i = 0; i < 4; ++i) {
+			if (!IsWalkable(x + s_iDirectionX[i], y + s_iDirectionY[i])) {
+				continue;
+			}
+			const unsigned int iNeighbour = ((y + s_iDirectionY[i]) * m_iWidth) + (x + s_iDirectionX[i]);
+			if (!IsTouched(iNeighbour)) {
+				m_generations[iNeighbour] = m_iGeneration;
+				m_distances[iNeighbour] = iNeighbourDistance;
+				m_heap.push_back(iNeighbour);
+			}
+		}
+	}
+
+	m_iNumNodesExpanded = (unsigned int)m_heap.size();
+	m_heap.clear();
+}
+
+/// <summary>
+/// Gets the distance to a tile found by the last FloodDistances
+/// </summary>
+/// <param name="a_tile">Tile to get the distance to</param>
+/// <returns>Distance to the tile, -1 if it wasn't reached</returns>
+int GridSearch::GetDistance(const Position& a_tile) const
+{
+	if (a_tile.x < 0 || a_tile.y < 0 || a_tile.x >= (int)m_iWidth || a_tile.y >= (int)m_iHeight) {
+		return -1;
+	}
+	const unsigned int iNode = (a_tile.y * m_iWidth) + a_tile.x;
+	return IsTouched(iNode) ? m_distances[iNode] : -1;
+}
+
+/// <summary>
+/// Keeps searches inside a rectangle of tiles, tiles outside it are treated
+/// as walls
+/// </summary>
+/// <param name="a_iX">First tile across</param>
+/// <param name="a_iY">First tile down</param>
+/// <param name="a_iWidth">Number of tiles across</param>
+/// <param name="a_iHeight">Number of tiles down</param>
+void GridSearch::SetBounds(unsigned int a_iX, unsigned int a_iY, unsigned int a_iWidth, unsigned int a_iHeight)
+{
+	m_iMinX = (int)std::min(a_iX, m_iWidth);
+	m_iMinY = (int)std::min(a_iY, m_iHeight);
+	m_iMaxX = (int)std::min(a_iX + a_iWidth, m_iWidth);
+	m_iMaxY = (int)std::min(a_iY + a_iHeight, m_iHeight);
+}
+
+/// <summary>
+/// Lets searches use the whole grid
+/// </summary>
+void GridSearch::ClearBounds()
+{
+	m_iMinX = 0;
+	m_iMinY = 0;
+	m_iMaxX = (int)m_iWidth;
+	m_iMaxY = (int)m_iHeight;
+}
+
+/// <summary>
+/// Checks if a tile is inside the grid and its bounds and not a wall
+/// </summary>
+bool GridSearch::IsWalkable(int a_x, int a_y) const
+{
+	if (m_pWalls == nullptr || a_x < m_iMinX || a_y < m_iMinY || a_x >= m_iMaxX || a_y >= m_iMaxY) {
+		return false;
+	}
+	return !m_pWalls[(a_y * m_iWidth) + a_x];
+}
+
+/// <summary>
+/// Gets the neighbour of a node in a direction
+/// </summary>
+/// <param name="a_iNode">Node to get the neighbour of</param>
+/// <param name="a_iDirection">Direction to step in, (+x, -x, +y, -y)</param>
+/// <returns>Neighbouring node, NO_NODE if it is a wall or off the grid</returns>
+unsigned int GridSearch::GetNeighbour(unsigned int a_iNode, unsigned int a_iDirection) const
+{
+	const int x = (int)(a_iNode % m_iWidth) + s_iDirectionX[a_iDirection];
+	const int y = (int)(a_iNode / m_iWidth) + s_iDirectionY[a_iDirection];
+	if (!IsWalkable(x, y)) {
+		return NO_NODE;
+	}
+	return (y * m_iWidth) + x;
+}
+
+/// <summary>
+/// Moves on to a new generation so every node is untouched, the stamps only
+/// need clearing when the generation wraps around
+/// </summary>
+void GridSearch::BeginSearch()
+{
+	++m_iGeneration;
+	if (m_iGeneration == 0) {
+		std::fill(m_generations.begin(), m_generations.end(), 0);
+		m_iGeneration = 1;
+	}
+	m_heap.clear();
+}
+
+/// <summary>
+/// Adds a touched node to the heap
+/// </summary>
+void GridSearch::HeapPush(unsigned int a_iNode)
+{
+	m_heapIndices[a_iNode] = (unsigned int)m_heap.size();
+	m_heap.push_back(a_iNode);
+	HeapSiftUp((unsigned int)m_heap.size() - 1);
+}
+
+/// <summary>
+/// Takes the closest node off the heap and closes it
+/// </summary>
+/// <returns>Closest node</returns>
+unsigned int GridSearch::HeapPop()
+{
+	const unsigned int iTop = m_heap[0];
+	m_heapIndices[iTop] = CLOSED;
+
+	const unsigned int iLast = m_heap.back();
+	m_heap.pop_back();
+	if (!m_heap.empty()) {
+		m_heap[0] = iLast;
+		m_heapIndices[iLast] = 0;
+		HeapSiftDown(0);
+	}
+
+	return iTop;
+}
+
+/// <summary>
+/// Moves a node up the heap until its parent is no further away
+/// </summary>
+void GridSearch::HeapSiftUp(unsigned int a_iHeapIndex)
+{
+	const unsigned int iNode = m_heap[a_iHeapIndex];
+	while (a_iHeapIndex > 0) {
+		const unsigned int iParentIndex = (a_iHeapIndex - 1) / 2;
+		const unsigned int iParent = m_heap[iParentIndex];
+		if (!HeapLess(iNode, iParent)) {
+			break;
+		}
+		m_heap[a_iHeapIndex] = iParent;
+		m_heapIndices[iParent] = a_iHeapIndex;
+		a_iHeapIndex = iParentIndex;
+	}
+	m_heap[a_iHeapIndex] = iNode;
+	m_heapIndices[iNode] = a_iHeapIndex;
+}
+
+/// <summary>
+/// Moves a node down the heap until both children are no closer
+/// </summary>
+void GridSearch::HeapSiftDown(unsigned int a_iHeapIndex)
+{
+	const unsigned int iSize = (unsigned int)m_heap.size();
+	const unsigned int iNode = m_heap[a_iHeapIndex];
+	while (true) {
+		unsigned int iChildIndex = (a_iHeapIndex * 2) + 1;
+		if (iChildIndex >= iSize) {
+			break;
+		}
+		if (iChildIndex + 1 < iSize && HeapLess(m_heap[iChildIndex + 1], m_heap[iChildIndex])) {
+			++iChildIndex;
+		}
+		const unsigned int iChild = m_heap[iChildIndex];
+		if (!HeapLess(iChild, iNode)) {
+			break;
+		}
+		m_heap[a_iHeapIndex] = iChild;
+		m_heapIndices[iChild] = a_iHeapIndex;
+		a_iHeapIndex = iChildIndex;
+	}
+	m_heap[a_iHeapIndex] = iNode;
+	m_heapIndices[iNode] = a_iHeapIndex;
+}
+
+/// <summary>
+/// Orders the heap by priority, nodes with the same priority are ordered by
+/// the closest to the end first so A* heads straight along a run of equal
+/// cost paths rather than opening all of them
+/// </summary>
+bool GridSearch::HeapLess(unsigned int a_iNodeA, unsigned int a_iNodeB) const
+{
+	const float fPriorityA = GetPriority(a_iNodeA);
+	const float fPriorityB = GetPriority(a_iNodeB);
+	if (fPriorityA != fPriorityB) {
+		return fPriorityA < fPriorityB;
+	}
+	return m_estimates[a_iNodeA] < m_estimates[a_iNodeB];
+}
+
+/// <summary>
+/// Gets the distance from the start plus the weighted estimate to the end
+/// </summary>
+float GridSearch::GetPriority(unsigned int a_iNode) const
+{
+	return (float)m_distances[a_iNode] + (m_fWeight * m_estimates[a_iNode]);
+}
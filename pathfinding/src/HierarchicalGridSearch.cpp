@@ -0,0 +1,576 @@
+#include "HierarchicalGridSearch.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <queue>
+#include <tuple>
+
+#include "Maze.h"
+
+/// <summary>
+/// Create a search with no grid
+/// </summary>
+/// <param name="a_iClusterSize">Number of tiles across and down each cluster</param>
+HierarchicalGridSearch::HierarchicalGridSearch(unsigned int a_iClusterSize) : mc_iClusterSize(a_iClusterSize > 0 ? a_iClusterSize : 1)
+{
+	m_pWalls = nullptr;
+	m_iWidth = 0;
+	m_iHeight = 0;
+	m_iNumClustersX = 0;
+	m_iNumClustersY = 0;
+	m_iGeneration = 0;
+	m_iNumClustersRebuilt = 0;
+	m_iNumNodesExpanded = 0;
+}
+
+/// <summary>
+/// Sets the grid to search, the abstract graph is built by the next Update
+/// </summary>
+/// <param name="a_pWalls">Tiles that can't be walked on, tile (x, y) is at y * width + x</param>
+/// <param name="a_iWidth">Number of tiles across</param>
+/// <param name="a_iHeight">Number of tiles down</param>
+void HierarchicalGridSearch::SetGrid(const bool* a_pWalls, unsigned int a_iWidth, unsigned int a_iHeight)
+{
+	m_pWalls = a_pWalls;
+	m_iWidth = a_iWidth;
+	m_iHeight = a_iHeight;
+	m_iNumClustersX = (a_iWidth + mc_iClusterSize - 1) / mc_iClusterSize;
+	m_iNumClustersY = (a_iHeight + mc_iClusterSize - 1) / mc_iClusterSize;
+	m_localSearch.SetGrid(a_pWalls, a_iWidth, a_iHeight);
+
+	SetAllTilesChanged();
+}
+
+/// <summary>
+/// Throws away the abstract graph so the next Update builds all of it
+/// </summary>
+void HierarchicalGridSearch::SetAllTilesChanged()
+{
+	const unsigned int iNumClusters = GetNumClusters();
+	m_nodes.clear();
+	m_freeNodes.clear();
+	m_clusterNodes.assign(iNumClusters, std::vector<unsigned int>());
+	m_eastBorderNodes.assign(iNumClusters, std::vector<unsigned int>());
+	m_southBorderNodes.assign(iNumClusters, std::vector<unsigned int>());
+
+	m_dirtyClusters.assign(iNumClusters, true);
+	m_dirtyClusterList.resize(iNumClusters);
+	for (unsigned int i = 0; i < iNumClusters; ++i) {
+		m_dirtyClusterList[i] = i;
+	}
+}
+
+/// <summary>
+/// Marks the cluster a tile is in to be rebuilt by the next Update, this
+/// needs calling whenever a tile becomes or stops being a wall
+/// </summary>
+/// <param name="a_x">Tile that changed</param>
+/// <param name="a_y">Tile that changed</param>
+void HierarchicalGridSearch::SetTileChanged(int a_x, int a_y)
+{
+	if (a_x < 0 || a_y < 0 || a_x >= (int)m_iWidth || a_y >= (int)m_iHeight) {
+		return;
+	}
+
+	const unsigned int iCluster = GetCluster(a_x, a_y);
+	if (!m_dirtyClusters[iCluster]) {
+		m_dirtyClusters[iCluster] = true;
+		m_dirtyClusterList.push_back(iCluster);
+	}
+}
+
+/// <summary>
+/// Rebuilds the entrances on every border of the changed clusters and the
+/// paths between entrances in them and their neighbours, whose entrances
+/// may have moved
+/// </summary>
+void HierarchicalGridSearch::Update()
+{
+	m_iNumClustersRebuilt = 0;
+	if (m_dirtyClusterList.empty()) {
+		return;
+	}
+
+	const unsigned int iNumClusters = GetNumClusters();
+	std::vector<bool> eastBordersBuilt(iNumClusters, false);
+	std::vector<bool> southBordersBuilt(iNumClusters, false);
+	std::vector<bool> clustersAffected(iNumClusters, false);
+	std::vector<unsigned int> affectedClusters;
+
+	for (unsigned int iCluster : m_dirtyClusterList) {
+		m_dirtyClusters[iCluster] = false;
+		const unsigned int cx = iCluster % m_iNumClustersX;
+		const unsigned int cy = iCluster / m_iNumClustersX;
+
+		//Borders are held by the cluster to their west or north
+		const unsigned int aiEastBorders[2] = { iCluster, iCluster - 1 };
+		const bool abHasEastBorder[2] = { cx + 1 < m_iNumClustersX, cx > 0 };
+		const unsigned int aiSouthBorders[2] = { iCluster, iCluster - m_iNumClustersX };
+		const bool abHasSouthBorder[2] = { cy + 1 < m_iNumClustersY, cy > 0 };
+		for (unsigned int i = 0; i < 2; ++i) {
+			if (abHasEastBorder[i] && !eastBordersBuilt[aiEastBorders[i]]) {
+				eastBordersBuilt[aiEastBorders[i]] = true;
+				ClearBorder(aiEastBorders[i], true);
+				BuildBorder(aiEastBorders[i], true);
+			}
+			if (abHasSouthBorder[i] && !southBordersBuilt[aiSouthBorders[i]]) {
+				southBordersBuilt[aiSouthBorders[i]] = true;
+				ClearBorder(aiSouthBorders[i], false);
+				BuildBorder(aiSouthBorders[i], false);
+			}
+		}
+
+		const unsigned int aiAffected[5] = { iCluster, iCluster + 1, iCluster - 1, iCluster + m_iNumClustersX, iCluster - m_iNumClustersX };
+		const bool abHasAffected[5] = { true, abHasEastBorder[0], abHasEastBorder[1], abHasSouthBorder[0], abHasSouthBorder[1] };
+		for (unsigned int i = 0; i < 5; ++i) {
+			if (abHasAffected[i] && !clustersAffected[aiAffected[i]]) {
+				clustersAffected[aiAffected[i]] = true;
+				affectedClusters.push_back(aiAffected[i]);
+			}
+		}
+	}
+	m_dirtyClusterList.clear();
+
+	for (unsigned int iCluster : affectedClusters) {
+		BuildClusterEdges(iCluster);
+	}
+	m_iNumClustersRebuilt = (unsigned int)affectedClusters.size();
+}
+
+/// <summary>
+/// Finds a path between two tiles as the entrances it passes through.
+/// Tiles in the same cluster that can reach each other inside it are joined
+/// directly. Otherwise the start and end are joined to the entrances of
+/// their clusters for the search and removed after it
+/// </summary>
+/// <param name="a_start">Tile to start at</param>
+/// <param name="a_end">Tile to finish at</param>
+/// <param name="a_waypoints">Tiles from the end back to the start, each a RefineSegment from the next</param>
+/// <returns>If a path was found</returns>
+bool HierarchicalGridSearch::FindAbstractPath(const Position& a_start, const Position& a_end, std::vector<Position>& a_waypoints)
+{
+	a_waypoints.clear();
+	m_iNumNodesExpanded = 0;
+
+	//Make sure that the path doesn't end or start in a wall
+	if (!IsWalkable(a_start.x, a_start.y) || !IsWalkable(a_end.x, a_end.y)) {
+		return false;
+	}
+
+	Update();
+
+	if (a_start == a_end) {
+		a_waypoints.push_back(a_end);
+		return true;
+	}
+
+	const unsigned int iStartCluster = GetCluster(a_start.x, a_start.y);
+	const unsigned int iEndCluster = GetCluster(a_end.x, a_end.y);
+	if (iStartCluster == iEndCluster) {
+		SetSearchBounds(iStartCluster);
+		m_localSearch.FloodDistances(a_start);
+		m_iNumNodesExpanded += m_localSearch.GetNumNodesExpanded();
+		if (m_localSearch.GetDistance(a_end) >= 0) {
+			a_waypoints.push_back(a_end);
+			a_waypoints.push_back(a_start);
+			return true;
+		}
+	}
+
+	const unsigned int iStart = AddNode(a_start.x, a_start.y, iStartCluster);
+	ConnectToCluster(iStart);
+	const unsigned int iEnd = AddNode(a_end.x, a_end.y, iEndCluster);
+	ConnectToCluster(iEnd);
+
+	const bool bFound = SearchAbstractGraph(iStart, iEnd, a_waypoints);
+
+	//The start and end only belong to this search
+	const unsigned int aiTemporary[2] = { iEnd, iStart };
+	for (unsigned int iNode : aiTemporary) {
+		for (const GridAbstractEdge& edge : m_nodes[iNode].edges) {
+			RemoveEdge(edge.node, iNode);
+		}
+		RemoveNode(iNode);
+	}
+
+	return bFound;
+}
+
+/// <summary>
+/// Refines a step between two waypoints of an abstract path in to tiles.
+/// Steps inside a cluster are searched for inside it, steps across a border
+/// are a single move
+/// </summary>
+/// <param name="a_from">Waypoint to start at</param>
+/// <param name="a_to">Waypoint to finish at</param>
+/// <param name="a_segment">Tiles from a_to back to a_from</param>
+/// <returns>If the step could be refined</returns>
+bool HierarchicalGridSearch::RefineSegment(const Position& a_from, const Position& a_to, std::vector<Position>& a_segment)
+{
+	a_segment.clear();
+	if (!IsWalkable(a_from.x, a_from.y) || !IsWalkable(a_to.x, a_to.y)) {
+		return false;
+	}
+
+	if (std::abs(a_to.x - a_from.x) + std::abs(a_to.y - a_from.y) <= 1) {
+		a_segment.push_back(a_to);
+		if (!(a_to == a_from)) {
+			a_segment.push_back(a_from);
+		}
+		return true;
+	}
+
+	const unsigned int iCluster = GetCluster(a_from.x, a_from.y);
+	if (iCluster == GetCluster(a_to.x, a_to.y)) {
+		SetSearchBounds(iCluster);
+		if (m_localSearch.FindPath(a_from, a_to, a_segment, GRID_HEURISTIC_MANHATTAN)) {
+			return true;
+		}
+	}
+
+	//Only reached when the grid has changed since the abstract path was found
+	m_localSearch.ClearBounds();
+	return m_localSearch.FindPath(a_from, a_to, a_segment, GRID_HEURISTIC_MANHATTAN);
+}
+
+/// <summary>
+/// Refines every step of an abstract path at once
+/// </summary>
+/// <param name="a_waypoints">Abstract path from FindAbstractPath</param>
+/// <param name="a_finalPath">Tiles from the end back to the start</param>
+/// <returns>If every step could be refined</returns>
+bool HierarchicalGridSearch::RefinePath(const std::vector<Position>& a_waypoints, std::vector<Position>& a_finalPath)
+{
+	a_finalPath.clear();
+	if (a_waypoints.empty()) {
+		return false;
+	}
+
+	//Each segment runs backwards, so build the path from the end
+	a_finalPath.push_back(a_waypoints[0]);
+	std::vector<Position> segment;
+	for (size_t i = 1; i < a_waypoints.size(); ++i) {
+		if (!RefineSegment(a_waypoints[i], a_waypoints[i - 1], segment)) {
+			a_finalPath.clear();
+			return false;
+		}
+		a_finalPath.insert(a_finalPath.end(), segment.begin() + 1, segment.end());
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Gets the cluster a tile is in
+/// </summary>
+unsigned int HierarchicalGridSearch::GetCluster(int a_x, int a_y) const
+{
+	return ((a_y / mc_iClusterSize) * m_iNumClustersX) + (a_x / mc_iClusterSize);
+}
+
+/// <summary>
+/// Keeps the local search inside a cluster
+/// </summary>
+void HierarchicalGridSearch::SetSearchBounds(unsigned int a_iCluster)
+{
+	m_localSearch.SetBounds((a_iCluster % m_iNumClustersX) * mc_iClusterSize, (a_iCluster / m_iNumClustersX) * mc_iClusterSize,
+		mc_iClusterSize, mc_iClusterSize);
+}
+
+/// <summary>
+/// Checks if a tile is inside the grid and not a wall
+/// </summary>
+bool HierarchicalGridSearch::IsWalkable(int a_x, int a_y) const
+{
+	if (m_pWalls == nullptr || a_x < 0 || a_y < 0 || a_x >= (int)m_iWidth || a_y >= (int)m_iHeight) {
+		return false;
+	}
+	return !m_pWalls[(a_y * m_iWidth) + a_x];
+}
+
+/// <summary>
+/// Adds a node to the abstract graph with no edges, it isn't added to its
+/// cluster's entrances
+/// </summary>
+/// <returns>Index of the node</returns>
+unsigned int HierarchicalGridSearch::AddNode(int a_x, int a_y, unsigned int a_iCluster)
+{
+	unsigned int iNode;
+	if (!m_freeNodes.empty()) {
+		iNode = m_freeNodes.back();
+		m_freeNodes.pop_back();
+	}
+	else {
+		iNode = (unsigned int)m_nodes.size();
+		m_nodes.push_back(GridAbstractNode());
+	}
+
+	GridAbstractNode& node = m_nodes[iNode];
+	node.x = a_x;
+	node.y = a_y;
+	node.cluster = a_iCluster;
+	node.partner = NO_NODE;
+	node.active = true;
+	node.edges.clear();
+	return iNode;
+}
+
+/// <summary>
+/// Removes a node from the abstract graph and its cluster's entrances, edges
+/// to it from other nodes are left for the caller to remove
+/// </summary>
+void HierarchicalGridSearch::RemoveNode(unsigned int a_iNode)
+{
+	GridAbstractNode& node = m_nodes[a_iNode];
+	std::vector<unsigned int>& clusterNodes = m_clusterNodes[node.cluster];
+	std::vector<unsigned int>::iterator it = std::find(clusterNodes.begin(), clusterNodes.end(), a_iNode);
+	if (it != clusterNodes.end()) {
+		*it = clusterNodes.back();
+		clusterNodes.pop_back();
+	}
+
+	node.active = false;
+	node.partner = NO_NODE;
+	node.edges.clear();
+	m_freeNodes.push_back(a_iNode);
+}
+
+/// <summary>
+/// Removes the edge between two nodes
+/// </summary>
+void HierarchicalGridSearch::RemoveEdge(unsigned int a_iFrom, unsigned int a_iTo)
+{
+	std::vector<GridAbstractEdge>& edges = m_nodes[a_iFrom].edges;
+	for (size_t i = 0; i < edges.size(); ++i) {
+		if (edges[i].node == a_iTo) {
+			edges[i] = edges.back();
+			edges.pop_back();
+			return;
+		}
+	}
+}
+
+/// <summary>
+/// Places entrances along the border between a cluster and its east or
+/// south neighbour. Each run of tiles that are open on both sides gets an
+/// entrance in the middle, or one at each end when it is wide
+/// </summary>
+/// <param name="a_iCluster">Cluster to the west or north of the border</param>
+/// <param name="a_bEast">If the border is on the cluster's east side, otherwise its south side</param>
+void HierarchicalGridSearch::BuildBorder(unsigned int a_iCluster, bool a_bEast)
+{
+	const int cx = (int)(a_iCluster % m_iNumClustersX);
+	const int cy = (int)(a_iCluster / m_iNumClustersX);
+	const unsigned int iNeighbour = a_bEast ? a_iCluster + 1 : a_iCluster + m_iNumClustersX;
+	std::vector<unsigned int>& borderNodes = a_bEast ? m_eastBorderNodes[a_iCluster] : m_southBorderNodes[a_iCluster];
+
+	//Border tiles on this side run along the border from its first tile, the
+	//neighbour's tiles are a step across
+	const int iFirstX = a_bEast ? ((cx + 1) * (int)mc_iClusterSize) - 1 : cx * (int)mc_iClusterSize;
+	const int iFirstY = a_bEast ? cy * (int)mc_iClusterSize : ((cy + 1) * (int)mc_iClusterSize) - 1;
+	const int iAlongX = a_bEast ? 0 : 1;
+	const int iAlongY = a_bEast ? 1 : 0;
+	const int iAcrossX = a_bEast ? 1 : 0;
+	const int iAcrossY = a_bEast ? 0 : 1;
+	const int iLength = a_bEast ? std::min((int)mc_iClusterSize, (int)m_iHeight - iFirstY) : std::min((int)mc_iClusterSize, (int)m_iWidth - iFirstX);
+
+	int iRunStart = -1;
+	for (int i = 0; i <= iLength; ++i) {
+		const int x = iFirstX + (i * iAlongX);
+		const int y = iFirstY + (i * iAlongY);
+		const bool bOpen = i < iLength && IsWalkable(x, y) && IsWalkable(x + iAcrossX, y + iAcrossY);
+		if (bOpen) {
+			if (iRunStart < 0) {
+				iRunStart = i;
+			}
+			continue;
+		}
+		if (iRunStart < 0) {
+			continue;
+		}
+
+		//Close the run that ended on the last tile
+		const int iRunLength = i - iRunStart;
+		int aiEntrances[2] = { iRunStart + (iRunLength / 2), -1 };
+		if (iRunLength >= (int)MIN_WIDE_ENTRANCE) {
+			aiEntrances[0] = iRunStart;
+			aiEntrances[1] = i - 1;
+		}
+		for (int iEntrance : aiEntrances) {
+			if (iEntrance < 0) {
+				continue;
+			}
+			const int iEntranceX = iFirstX + (iEntrance * iAlongX);
+			const int iEntranceY = iFirstY + (iEntrance * iAlongY);
+			const unsigned int iNode = AddNode(iEntranceX, iEntranceY, a_iCluster);
+			const unsigned int iPartner = AddNode(iEntranceX + iAcrossX, iEntranceY + iAcrossY, iNeighbour);
+			m_nodes[iNode].partner = iPartner;
+			m_nodes[iPartner].partner = iNode;
+			m_clusterNodes[a_iCluster].push_back(iNode);
+			m_clusterNodes[iNeighbour].push_back(iPartner);
+			borderNodes.push_back(iNode);
+			borderNodes.push_back(iPartner);
+		}
+		iRunStart = -1;
+	}
+}
+
+/// <summary>
+/// Removes the entrances on both sides of a cluster's east or south border,
+/// the edges between the entrances of both clusters need rebuilding after
+/// </summary>
+/// <param name="a_iCluster">Cluster to the west or north of the border</param>
+/// <param name="a_bEast">If the border is on the cluster's east side, otherwise its south side</param>
+void HierarchicalGridSearch::ClearBorder(unsigned int a_iCluster, bool a_bEast)
+{
+	std::vector<unsigned int>& borderNodes = a_bEast ? m_eastBorderNodes[a_iCluster] : m_southBorderNodes[a_iCluster];
+	for (unsigned int iNode : borderNodes) {
+		RemoveNode(iNode);
+	}
+	borderNodes.clear();
+}
+
+/// <summary>
+/// Joins every pair of entrances in a cluster that can reach each other
+/// inside it by the length of the shortest path between them
+/// </summary>
+void HierarchicalGridSearch::BuildClusterEdges(unsigned int a_iCluster)
+{
+	const std::vector<unsigned int>& clusterNodes = m_clusterNodes[a_iCluster];
+	for (unsigned int iNode : clusterNodes) {
+		m_nodes[iNode].edges.clear();
+	}
+
+	//Paths are the same length both ways so each entrance only floods to the
+	//entrances after it
+	SetSearchBounds(a_iCluster);
+	for (size_t i = 0; i + 1 < clusterNodes.size(); ++i) {
+		const unsigned int iNode = clusterNodes[i];
+		m_localSearch.FloodDistances(Position(m_nodes[iNode].x, m_nodes[iNode].y));
+		for (size_t j = i + 1; j < clusterNodes.size(); ++j) {
+			const unsigned int iOther = clusterNodes[j];
+			const int iDistance = m_localSearch.GetDistance(Position(m_nodes[iOther].x, m_nodes[iOther].y));
+			if (iDistance >= 0) {
+				GridAbstractEdge toOther = { iOther, iDistance };
+				GridAbstractEdge fromOther = { iNode, iDistance };
+				m_nodes[iNode].edges.push_back(toOther);
+				m_nodes[iOther].edges.push_back(fromOther);
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Joins a node that isn't an entrance to every entrance of its cluster it
+/// can reach inside the cluster, in both directions
+/// </summary>
+void HierarchicalGridSearch::ConnectToCluster(unsigned int a_iNode)
+{
+	const unsigned int iCluster = m_nodes[a_iNode].cluster;
+	SetSearchBounds(iCluster);
+	m_localSearch.FloodDistances(Position(m_nodes[a_iNode].x, m_nodes[a_iNode].y));
+	m_iNumNodesExpanded += m_localSearch.GetNumNodesExpanded();
+
+	for (unsigned int iEntrance : m_clusterNodes[iCluster]) {
+		const int iDistance = m_localSearch.GetDistance(Position(m_nodes[iEntrance].x, m_nodes[iEntrance].y));
+		if (iDistance >= 0) {
+			GridAbstractEdge toEntrance = { iEntrance, iDistance };
+			GridAbstractEdge fromEntrance = { a_iNode, iDistance };
+			m_nodes[a_iNode].edges.push_back(toEntrance);
+			m_nodes[iEntrance].edges.push_back(fromEntrance);
+		}
+	}
+}
+
+/// <summary>
+/// A* over the abstract graph using the Manhattan distance between nodes
+/// </summary>
+/// <param name="a_iStart">Node to start at</param>
+/// <param name="a_iEnd">Node to finish at</param>
+/// <param name="a_waypoints">Tiles of the nodes from the end back to the start</param>
+/// <returns>If a path was found</returns>
+bool HierarchicalGridSearch::SearchAbstractGraph(unsigned int a_iStart, unsigned int a_iEnd, std::vector<Position>& a_waypoints)
+{
+	const size_t iNumNodes = m_nodes.size();
+	if (m_generations.size() < iNumNodes) {
+		m_generations.resize(iNumNodes, 0);
+		m_distances.resize(iNumNodes);
+		m_parents.resize(iNumNodes);
+		m_closed.resize(iNumNodes);
+	}
+	++m_iGeneration;
+	if (m_iGeneration == 0) {
+		std::fill(m_generations.begin(), m_generations.end(), 0);
+		m_iGeneration = 1;
+	}
+
+	const GridAbstractNode& end = m_nodes[a_iEnd];
+	//Open nodes by estimated path length, then furthest from the start
+	typedef std::tuple<int, int, unsigned int> OpenNode;
+	std::priority_queue<OpenNode, std::vector<OpenNode>, std::greater<OpenNode>> open;
+
+	m_generations[a_iStart] = m_iGeneration;
+	m_distances[a_iStart] = 0;
+	m_parents[a_iStart] = NO_NODE;
+	m_closed[a_iStart] = false;
+	open.push(OpenNode(std::abs(end.x - m_nodes[a_iStart].x) + std::abs(end.y - m_nodes[a_iStart].y), 0, a_iStart));
+
+	bool bFound = false;
+	while (!open.empty()) {
+		const unsigned int iCurrent = std::get<2>(open.top());
+		open.pop();
+		//Nodes are pushed again when a shorter way is found, skip the old ones
+		if (m_closed[iCurrent]) {
+			continue;
+		}
+		m_closed[iCurrent] = true;
+		++m_iNumNodesExpanded;
+
+		if (iCurrent == a_iEnd) {
+			bFound = true;
+			break;
+		}
+
+		const GridAbstractNode& current = m_nodes[iCurrent];
+		const size_t iNumEdges = current.edges.size();
+		for (size_t i = 0; i <= iNumEdges; ++i) {
+			//The partner across the border is one step away
+			const unsigned int iNeighbour = (i < iNumEdges) ? current.edges[i].node : current.partner;
+			if (iNeighbour == NO_NODE) {
+				continue;
+			}
+			const int iDistance = m_distances[iCurrent] + ((i < iNumEdges) ? current.edges[i].cost : 1);
+
+			if (m_generations[iNeighbour] == m_iGeneration) {
+				if (m_closed[iNeighbour] || iDistance >= m_distances[iNeighbour]) {
+					continue;
+				}
+			}
+			else {
+				m_generations[iNeighbour] = m_iGeneration;
+				m_closed[iNeighbour] = false;
+			}
+
+			m_distances[iNeighbour] = iDistance;
+			m_parents[iNeighbour] = iCurrent;
+			const GridAbstractNode& neighbour = m_nodes[iNeighbour];
+			open.push(OpenNode(iDistance + std::abs(end.x - neighbour.x) + std::abs(end.y - neighbour.y), -iDistance, iNeighbour));
+		}
+	}
+
+	if (!bFound) {
+		return false;
+	}
+
+	//Walk back from the end to the start, an entrance can share a tile with
+	//the start or end
+	for (unsigned int iNode = a_iEnd; iNode != NO_NODE; iNode = m_parents[iNode]) {
+		const Position tile(m_nodes[iNode].x, m_nodes[iNode].y);
+		if (a_waypoints.empty() || !(a_waypoints.back() == tile)) {
+			a_waypoints.push_back(tile);
+		}
+	}
+
+	return true;
+}
@@ -1,9 +1,11 @@
 #include "MD2Pathfinder.h"
 
 #include "md2_loader.h"
+#include "md2_model_manager.h"
 #include "Application.h"
 #include <GLFW/glfw3.h>
 #include "Application_Log.h"
+#include <iostream>
 
 /// <summary>
 /// Construct just model at 0,0,0
@@ -35,27 +37,46 @@ MD2Pathfinder::MD2Pathfinder(const char * a_modelFilename, glm::vec3 a_pos, std:
 	LoadModel(a_modelFilename);
 }
 
+/// <summary>
+/// Destructor, release our refrence to the shared model
+/// </summary>
+MD2Pathfinder::~MD2Pathfinder()
+{
+	MD2ModelManager* pModelManager = MD2ModelManager::GetInstance();
+	if (pModelManager != nullptr) {
+		pModelManager->ReleaseModel(m_pModel);
+	}
+	m_pModel = nullptr;
+}
+
 /// <summary>
 /// Update Update Postion and frame data
 /// </summary>
 /// <param name="a_fDeltaTime"></param>
 void MD2Pathfinder::Update(float a_fDeltaTime)
 {
+	const glm::vec3 lastPosition = m_currentPostion;
 	FollowPath(a_fDeltaTime);
 	Animate(a_fDeltaTime);
 
+	//Face the way we are moving, MD2 models face along +x
+	const glm::vec3 movement = m_currentPostion - lastPosition;
+	if (movement.x != 0.f || movement.z != 0.f) {
+		m_fHeading = atan2f(-movement.z, movement.x);
+	}
+
 	//Change in to walking animation when walking and change back when 
 	//we stop walking
 	if (m_bForceWalkAnimationWhenMoving) {
-		if (m_bFollowingPath && !m_bAnimationLocked) {
+		if (m_bFollowingPath && !m_bAnimationLocked && m_iWalkAnimationClip != MD2AnimationTable::INVALID_CLIP) {
 			//Store previous animation, change animation and set locked
-			m_ePreWalkingAnimationState = m_eAnimationState;
-			m_eAnimationState = ANIMATION_STATE_WALK;
+			m_iPreWalkingAnimationClip = m_iAnimationClip;
+			m_iAnimationClip = m_iWalkAnimationClip;
 			m_bAnimationLocked = true;
 		}
 		else if (!m_bFollowingPath && m_bAnimationLocked) {
 			//If we have stopped walking unlock the animation
-			m_eAnimationState = m_ePreWalkingAnimationState;
+			m_iAnimationClip = m_iPreWalkingAnimationClip;
 			m_bAnimationLocked = false;
 		}
 	}
@@ -70,6 +91,17 @@ void MD2Pathfinder::SetPosition(glm::vec3 a_pos)
 	m_currentPostion = a_pos;
 }
 
+/// <summary>
+/// Gets the matrix that places the model in the world, the vertex data is in
+/// model space so this must be given to the shader when drawing
+/// </summary>
+/// <returns>Model matrix for this object</returns>
+glm::mat4 MD2Pathfinder::GetModelMatrix() const
+{
+	const glm::mat4 translation = glm::translate(glm::mat4(1.f), m_currentPostion + m_modelOffset);
+	return glm::rotate(translation, m_fHeading, glm::vec3(0.f, 1.f, 0.f));
+}
+
 /// <summary>
 /// Stops the current path
 /// </summary>
@@ -77,6 +109,8 @@ void MD2Pathfinder::StopPath()
 {
 	m_bFollowingPath = false;
 	m_path.clear(); //Empty the path
+	m_pFlowFieldMaze = nullptr;
+	m_pHierarchyMaze = nullptr;
 }
 
 /// <summary>
@@ -102,7 +136,7 @@ void MD2Pathfinder::ChangeSkin(ATTRIBUTE_CHANGE_DIRECTION a_eChangeDirection)
 /// <param name="a_iSkinID"></param>
 void MD2Pathfinder::ChangeSkin(int a_iSkinID)
 {
-	if (m_pModel = nullptr) {
+	if (m_pModel == nullptr) {
 		return;
 	}
 
@@ -111,21 +145,160 @@ void MD2Pathfinder::ChangeSkin(int a_iSkinID)
 }
 
 /// <summary>
-/// Gets the verticies data for drawing the model
+/// Changes how the vertex data for drawing the model is laid out
+/// </summary>
+/// <param name="a_eVertexLayout">Layout to use</param>
+void MD2Pathfinder::SetVertexLayout(MD2_VERTEX_LAYOUT a_eVertexLayout)
+{
+	if (a_eVertexLayout == m_eVertexLayout || a_eVertexLayout >= MD2_VERTEX_LAYOUT_COUNT) {
+		return;
+	}
+
+	m_eVertexLayout = a_eVertexLayout;
+	CreateVertexBuffers();
+}
+
+/// <summary>
+/// Gets how the vertex data for drawing the model is laid out
 /// </summary>
 /// <returns></returns>
-MD2Vertex * MD2Pathfinder::GetVertsData() const
+MD2_VERTEX_LAYOUT MD2Pathfinder::GetVertexLayout() const
 {
-	return m_pCurrentVertexData;
+	return m_eVertexLayout;
 }
 
 /// <summary>
-/// Gets the number of verticiles for drawing the model
+/// Changes how normals are held in the per frame vertex data, this only
+/// applies to the split layout as the interleaved layout always has float normals
+/// </summary>
+/// <param name="a_eNormalFormat">Normal format to use</param>
+void MD2Pathfinder::SetNormalFormat(MD2_NORMAL_FORMAT a_eNormalFormat)
+{
+	if (a_eNormalFormat == m_eNormalFormat || a_eNormalFormat >= MD2_NORMAL_FORMAT_COUNT) {
+		return;
+	}
+
+	m_eNormalFormat = a_eNormalFormat;
+	CreateVertexBuffers();
+}
+
+/// <summary>
+/// Gets how normals are held in the per frame vertex data
+/// </summary>
+/// <returns></returns>
+MD2_NORMAL_FORMAT MD2Pathfinder::GetNormalFormat() const
+{
+	return m_eNormalFormat;
+}
+
+/// <summary>
+/// Changes how often the vertices are made as the model animates
+/// </summary>
+/// <param name="a_eAnimationLOD">Level of detail to animate at</param>
+void MD2Pathfinder::SetAnimationLOD(MD2_ANIMATION_LOD a_eAnimationLOD)
+{
+	if (a_eAnimationLOD == m_eAnimationLOD || a_eAnimationLOD >= MD2_ANIMATION_LOD_COUNT) {
+		return;
+	}
+
+	//Make the vertices at the new level straight away
+	m_eAnimationLOD = a_eAnimationLOD;
+	m_bVertexDataStale = true;
+}
+
+/// <summary>
+/// Changes where the model is interpolated between keyframes. On the GPU the
+/// vertex data is left alone and only the frames to draw are worked out
+/// </summary>
+/// <param name="a_eInterpolationMode">Where to interpolate</param>
+void MD2Pathfinder::SetInterpolationMode(MD2_INTERPOLATION_MODE a_eInterpolationMode)
+{
+	if (a_eInterpolationMode == m_eInterpolationMode || a_eInterpolationMode >= MD2_INTERPOLATION_COUNT) {
+		return;
+	}
+
+	//Vertices have not been kept up to date on the GPU so make them straight away
+	m_eInterpolationMode = a_eInterpolationMode;
+	m_bVertexDataStale = true;
+}
+
+/// <summary>
+/// Gets the verticies data for drawing the model with the interleaved layout
+/// </summary>
+/// <returns></returns>
+const MD2Vertex * MD2Pathfinder::GetVertsData() const
+{
+	return m_currentVertexData.data();
+}
+
+/// <summary>
+/// Gets the colours and UVs for drawing the model with the split layout,
+/// these don't change as the model animates
+/// </summary>
+/// <returns></returns>
+const MD2StaticVertex * MD2Pathfinder::GetStaticVertsData() const
+{
+	return m_staticVertexData.data();
+}
+
+/// <summary>
+/// Gets the positions and normals for drawing the model with the split layout
+/// </summary>
+/// <returns></returns>
+const MD2DynamicVertex * MD2Pathfinder::GetDynamicVertsData() const
+{
+	return m_dynamicVertexData.data();
+}
+
+/// <summary>
+/// Gets the positions and packed normals for drawing the model with the split
+/// layout when the normals are not held as floats
+/// </summary>
+/// <returns></returns>
+const MD2PackedVertex * MD2Pathfinder::GetPackedVertsData() const
+{
+	return m_packedVertexData.data();
+}
+
+/// <summary>
+/// Gets how far the model is between its current and next frame, needed to
+/// interpolate normals held as MD2_NORMAL_FORMAT_INDEX
+/// </summary>
+/// <returns></returns>
+float MD2Pathfinder::GetInterpolation() const
+{
+	return m_fVertexInterpolation;
+}
+
+/// <summary>
+/// Gets the number of unique verticies in the vertex data for drawing the model
 /// </summary>
 /// <returns></returns>
 float MD2Pathfinder::GetNumVerts() const
 {
-	return m_pModel->GetNumVerts();
+	if (m_pModel == nullptr) {
+		return 0.f;
+	}
+	return (float)m_pModel->GetNumUniqueVerts();
+}
+
+/// <summary>
+/// Gets the number of indices for drawing the model
+/// </summary>
+/// <returns></returns>
+unsigned int MD2Pathfinder::GetNumIndices() const
+{
+	return m_pModel->GetNumIndices();
+}
+
+/// <summary>
+/// Gets the index data for drawing the vertex data as triangles, this doesn't
+/// change as the model animates
+/// </summary>
+/// <returns></returns>
+const unsigned short * MD2Pathfinder::GetIndexData() const
+{
+	return m_pModel->GetIndices();
 }
 
 /// <summary>
@@ -144,14 +317,31 @@ unsigned int MD2Pathfinder::GetTextureID() const
 /// <returns></returns>
 bool MD2Pathfinder::LoadModel(const char * a_modelFilename)
 {
-	//Null check model and delete if model exists
+	MD2ModelManager* pModelManager = MD2ModelManager::GetInstance();
+	if (pModelManager == nullptr) {
+		std::cout << "Model manager has not been created" << std::endl;
+		return false;
+	}
+
+	//Release the model we are currently using
 	if (m_pModel != nullptr) {
-		delete m_pModel;
+		pModelManager->ReleaseModel(m_pModel);
+		m_pModel = nullptr;
 	}
 
-	//Load Model
-	m_pModel = new MD2Model();
-	if (m_pModel->Load(a_modelFilename, m_fModelScale)) {
+	//Get the model, this is only loaded from file the first time it is used
+	m_pModel = pModelManager->AcquireModel(a_modelFilename, m_fModelScale);
+	if (m_pModel != nullptr) {
+		//Cache decoded keyframes so that animating can use the vectorised interpolation
+		m_pModel->CreateKeyframeCache(m_keyframeCache, mc_iKeyframeCacheBudget);
+		CreateVertexBuffers();
+
+		//Start on the idle animation if the model has one
+		const unsigned int iIdleClip = FindAnimationClip(mc_idleAnimationName);
+		m_iAnimationClip = (iIdleClip != MD2AnimationTable::INVALID_CLIP) ? iIdleClip : 0;
+		m_iWalkAnimationClip = FindAnimationClip(mc_walkAnimationName);
+		m_iAnimationClipLastFrame = MD2AnimationTable::INVALID_CLIP;
+		m_bAnimationLocked = false;
 		return true;
 	}
 	else {
@@ -159,6 +349,40 @@ bool MD2Pathfinder::LoadModel(const char * a_modelFilename)
 	}
 }
 
+/// <summary>
+/// Size the vertex buffers for the current layout and fill in the attributes
+/// that never change once, so animating doesn't allocate
+/// </summary>
+void MD2Pathfinder::CreateVertexBuffers()
+{
+	m_currentVertexData.clear();
+	m_staticVertexData.clear();
+	m_dynamicVertexData.clear();
+	m_packedVertexData.clear();
+
+	if (m_pModel == nullptr) {
+		return;
+	}
+
+	const unsigned int iNumVerts = m_pModel->GetNumUniqueVerts();
+	if (m_eVertexLayout == MD2_VERTEX_LAYOUT_SPLIT) {
+		m_staticVertexData.resize(iNumVerts);
+		if (m_eNormalFormat == MD2_NORMAL_FORMAT_FLOAT) {
+			m_dynamicVertexData.resize(iNumVerts);
+		}
+		else {
+			m_packedVertexData.resize(iNumVerts);
+		}
+		m_pModel->InitialiseStaticVertexBuffer(m_staticVertexData.data(), iNumVerts);
+	}
+	else {
+		m_currentVertexData.resize(iNumVerts);
+		m_pModel->InitialiseVertexBuffer(m_currentVertexData.data(), iNumVerts);
+	}
+
+	m_bVertexDataStale = true;
+}
+
 /// <summary>
 /// Changes the animation relative to its current state in a given direction
 /// </summary>
@@ -171,40 +395,83 @@ void MD2Pathfinder::ChangeAnimation(ATTRIBUTE_CHANGE_DIRECTION a_eChangeDirectio
 		return;
 	}
 
-	int iNewAnimationState = m_eAnimationState;
+	if (m_pModel == nullptr) {
+		return;
+	}
+
+	const int iNumClips = (int)m_pModel->GetAnimationTable().GetNumClips();
+	int iNewAnimationClip = (int)m_iAnimationClip;
 
 	//Change the current skin ID ++ or -- based on func parameters
 	if (a_eChangeDirection == ATTRIBUTE_CHANGE_DIRECTION_INCREASE) {
-		iNewAnimationState++;
+		iNewAnimationClip++;
 	}
 	else if (a_eChangeDirection == ATTRIBUTE_CHANGE_DIRECTION_DECREASE) {
-		iNewAnimationState--;
+		iNewAnimationClip--;
 	}
 
 	//Make sure that animation number is within bounds
-	if (iNewAnimationState < 0) {
-		iNewAnimationState = ANIMATION_STATE_COUNT - 1;
+	if (iNewAnimationClip < 0) {
+		iNewAnimationClip = iNumClips - 1;
 	}
-	else if (iNewAnimationState > ANIMATION_STATE_COUNT - 1) {
-		iNewAnimationState = 0;
+	else if (iNewAnimationClip > iNumClips - 1) {
+		iNewAnimationClip = 0;
 	}
 
-	ChangeAnimation(iNewAnimationState);
+	ChangeAnimation(iNewAnimationClip);
 }
 
 /// <summary>
 /// Changes animation to given ID
 /// </summary>
-/// <param name="a_iAnimationID"></param>
+/// <param name="a_iAnimationID">ID of a clip in the models animation table</param>
 void MD2Pathfinder::ChangeAnimation(int a_iAnimationID)
 {
 	//Check if we are walking and animation is forced when walking,
 	//If so then don't change the animation
-	if (m_bAnimationLocked) {
+	if (m_bAnimationLocked || m_pModel == nullptr) {
 		return;
 	}
 
-	m_eAnimationState = (ANIMATION_STATE)a_iAnimationID;
+	if (a_iAnimationID < 0 || a_iAnimationID >= (int)m_pModel->GetAnimationTable().GetNumClips()) {
+		return;
+	}
+
+	m_iAnimationClip = (unsigned int)a_iAnimationID;
+}
+
+/// <summary>
+/// Gets the name of the animation being played
+/// </summary>
+/// <returns>Name of the clip, an empty string if there is no model</returns>
+const char* MD2Pathfinder::GetAnimationName() const
+{
+	if (m_pModel == nullptr) {
+		return "";
+	}
+
+	const MD2AnimationClip* pClip = m_pModel->GetAnimationTable().GetClip(m_iAnimationClip);
+	return (pClip != nullptr) ? pClip->name : "";
+}
+
+/// <summary>
+/// Finds an animation of the model by name, models with more than one take
+/// of an animation (walk1, walk2) use the first one
+/// </summary>
+/// <param name="a_name">Name of the clip</param>
+/// <returns>ID of the clip, MD2AnimationTable::INVALID_CLIP if the model has no clip with the name</returns>
+unsigned int MD2Pathfinder::FindAnimationClip(const char* a_name) const
+{
+	if (m_pModel == nullptr) {
+		return MD2AnimationTable::INVALID_CLIP;
+	}
+
+	const MD2AnimationTable& animationTable = m_pModel->GetAnimationTable();
+	const unsigned int iClip = animationTable.FindClip(a_name);
+	if (iClip != MD2AnimationTable::INVALID_CLIP) {
+		return iClip;
+	}
+	return animationTable.FindClip((std::string(a_name) + "1").c_str());
 }
 
 /// <summary>
@@ -212,43 +479,146 @@ void MD2Pathfinder::ChangeAnimation(int a_iAnimationID)
 /// </summary>
 void MD2Pathfinder::Animate(float a_fDeltaTime)
 {
-	//Check if the animation state has changed
-	if (m_eAnimationState != m_eAnimationStateLastFrame) {
+	if (m_pModel == nullptr) {
+		return;
+	}
+
+	//Check if the animation clip has changed
+	if (m_iAnimationClip != m_iAnimationClipLastFrame) {
+		//Blend out of the clip that was playing, the first clip is cut straight to
+		if (m_fAnimationBlendDuration > 0.f && m_iAnimationClipLastFrame != MD2AnimationTable::INVALID_CLIP) {
+			m_iBlendCurrentFrameIndex = m_iCurrentFrameIndex;
+			m_iBlendNextFrameIndex = m_iNextFrameIndex;
+			m_fBlendInterpolation = m_fInterpolation;
+			m_iBlendStartFrame = m_iStartFrame;
+			m_iBlendEndFrame = m_iEndFrame;
+			m_fAnimationBlendTime = 0.f;
+			m_bBlendingAnimation = true;
+		}
+
 		//Change start and end frames
-		m_iStartFrame = m_aModelAnimationList[m_eAnimationState].start;
-		m_iEndFrame = m_aModelAnimationList[m_eAnimationState].end;
+		const MD2AnimationClip* pClip = m_pModel->GetAnimationTable().GetClip(m_iAnimationClip);
+		m_iStartFrame = (pClip != nullptr) ? (int)pClip->frames.start : 0;
+		m_iEndFrame = (pClip != nullptr) ? (int)pClip->frames.end : 0;
 		//Set Current Frame
 		m_iCurrentFrameIndex = m_iStartFrame;
-		m_iNextFrameIndex = m_iStartFrame + 1;
+		m_iNextFrameIndex = (m_iStartFrame < m_iEndFrame) ? m_iStartFrame + 1 : m_iStartFrame;
+		m_fInterpolation = 0.f;
+		m_bVertexDataStale = true;
 	}
 
-	//Increase Interpolation
-	m_fInterpolation += mc_fAnimtationSpeed * a_fDeltaTime;
-
-	//If interpolation is over 1, then change the frame
-	if (m_fInterpolation >= 1) {
+	//Move both clips on while blending, the blend is over once the clip
+	//being blended in has played for the blend duration
+	AdvanceFrames(mc_fAnimtationSpeed * a_fDeltaTime, m_iStartFrame, m_iEndFrame, m_iCurrentFrameIndex, m_iNextFrameIndex, m_fInterpolation);
+	if (m_bBlendingAnimation) {
+		AdvanceFrames(mc_fAnimtationSpeed * a_fDeltaTime, m_iBlendStartFrame, m_iBlendEndFrame, m_iBlendCurrentFrameIndex, m_iBlendNextFrameIndex, m_fBlendInterpolation);
+		m_fAnimationBlendTime += a_fDeltaTime;
+		if (m_fAnimationBlendTime >= m_fAnimationBlendDuration) {
+			m_bBlendingAnimation = false;
+			m_bVertexDataStale = true;
+		}
+	}
 
-		m_iCurrentFrameIndex++;
+	//Work out if the vertices are due to be made at our level of detail,
+	//keyframes are only made again when the frame changes and are never blended
+	++m_iAnimationTick;
+	int iNextFrameIndex = m_iNextFrameIndex;
+	float fInterpolation = m_fInterpolation;
+	bool bBlend = m_bBlendingAnimation && m_eInterpolationMode == MD2_INTERPOLATION_CPU;
+	bool bMakeVertices = m_bVertexDataStale;
+	if (m_eAnimationLOD == MD2_ANIMATION_LOD_CLOCK_ONLY) {
+		bMakeVertices = false;
+	}
+	else if (m_eAnimationLOD == MD2_ANIMATION_LOD_KEYFRAME) {
+		iNextFrameIndex = m_iCurrentFrameIndex;
+		fInterpolation = 0.f;
+		bBlend = false;
+		bMakeVertices = bMakeVertices || (m_iCurrentFrameIndex != m_iVertexFrameIndex);
+	}
+	else {
+		bMakeVertices = bMakeVertices || (m_iAnimationTick % MD2AnimationLODPolicy::GetUpdateInterval(m_eAnimationLOD) == 0);
+	}
 
-		if (m_iCurrentFrameIndex == m_iEndFrame) {
-			m_iNextFrameIndex = m_iStartFrame;
+	//Get Data
+	if (bMakeVertices && bBlend) {
+		//Blend all four frames in one pass
+		const MD2AnimationPose fromPose = { (unsigned int)m_iBlendCurrentFrameIndex, (unsigned int)m_iBlendNextFrameIndex, m_fBlendInterpolation };
+		const MD2AnimationPose toPose = { (unsigned int)m_iCurrentFrameIndex, (unsigned int)iNextFrameIndex, fInterpolation };
+		const float fBlendAmount = m_fAnimationBlendTime / m_fAnimationBlendDuration;
+
+		if (m_eVertexLayout == MD2_VERTEX_LAYOUT_SPLIT && m_eNormalFormat != MD2_NORMAL_FORMAT_FLOAT) {
+			m_pModel->GetBlendedData(fromPose, toPose, fBlendAmount,
+				m_packedVertexData.data(), (unsigned int)m_packedVertexData.size(), m_eNormalFormat, &m_keyframeCache);
 		}
-		else if (m_iCurrentFrameIndex > m_iEndFrame) {
-			m_iCurrentFrameIndex = m_iStartFrame;
-			m_iNextFrameIndex = m_iStartFrame + 1;
+		else if (m_eVertexLayout == MD2_VERTEX_LAYOUT_SPLIT) {
+			m_pModel->GetBlendedData(fromPose, toPose, fBlendAmount,
+				m_dynamicVertexData.data(), (unsigned int)m_dynamicVertexData.size(), &m_keyframeCache);
 		}
 		else {
-			m_iNextFrameIndex++;
+			m_pModel->GetBlendedData(fromPose, toPose, fBlendAmount,
+				m_currentVertexData.data(), (unsigned int)m_currentVertexData.size(), &m_keyframeCache);
 		}
 
-		m_fInterpolation = 0.f;
+		//Index normals come from whichever clip has the most weight
+		m_iVertexFrameIndex = m_iCurrentFrameIndex;
+		m_iVertexNextFrameIndex = iNextFrameIndex;
+		m_fVertexInterpolation = (fBlendAmount < 0.5f) ? m_fBlendInterpolation : fInterpolation;
+		m_bVertexDataStale = false;
 	}
+	else if (bMakeVertices) {
+		//When the GPU interpolates only the frames to draw with are needed
+		if (m_eInterpolationMode == MD2_INTERPOLATION_CPU) {
+			if (m_eVertexLayout == MD2_VERTEX_LAYOUT_SPLIT && m_eNormalFormat != MD2_NORMAL_FORMAT_FLOAT) {
+				m_pModel->GetInterpolatedData(m_iCurrentFrameIndex, iNextFrameIndex, fInterpolation,
+					m_packedVertexData.data(), (unsigned int)m_packedVertexData.size(), m_eNormalFormat, &m_keyframeCache);
+			}
+			else if (m_eVertexLayout == MD2_VERTEX_LAYOUT_SPLIT) {
+				m_pModel->GetInterpolatedData(m_iCurrentFrameIndex, iNextFrameIndex, fInterpolation,
+					m_dynamicVertexData.data(), (unsigned int)m_dynamicVertexData.size(), &m_keyframeCache);
+			}
+			else {
+				m_pModel->GetInterpolatedData(m_iCurrentFrameIndex, iNextFrameIndex, fInterpolation,
+					m_currentVertexData.data(), (unsigned int)m_currentVertexData.size(), &m_keyframeCache);
+			}
+		}
 
-	//Get Data
-	m_pCurrentVertexData = m_pModel->GetInterpolatedData(m_iCurrentFrameIndex, m_iNextFrameIndex, m_fInterpolation, m_currentPostion + m_modelOffset);
+		m_iVertexFrameIndex = m_iCurrentFrameIndex;
+		m_iVertexNextFrameIndex = iNextFrameIndex;
+		m_fVertexInterpolation = fInterpolation;
+		m_bVertexDataStale = false;
+	}
 
 	//Set var for animation state checking
-	m_eAnimationStateLastFrame = m_eAnimationState;
+	m_iAnimationClipLastFrame = m_iAnimationClip;
+}
+
+/// <summary>
+/// Moves a clip on by an amount of frames, looping back to the start after
+/// the last frame. Clips with one frame just hold it
+/// </summary>
+/// <param name="a_fAmount">Number of frames to move on by, this should be less than 1</param>
+/// <param name="a_iStartFrame">First frame of the clip</param>
+/// <param name="a_iEndFrame">Last frame of the clip</param>
+/// <param name="a_iCurrentFrame">Frame the clip is on</param>
+/// <param name="a_iNextFrame">Frame the clip is moving to</param>
+/// <param name="a_fInterpolation">Amount between the current and next frame</param>
+void MD2Pathfinder::AdvanceFrames(float a_fAmount, int a_iStartFrame, int a_iEndFrame, int& a_iCurrentFrame, int& a_iNextFrame, float& a_fInterpolation)
+{
+	//Increase Interpolation
+	a_fInterpolation += a_fAmount;
+
+	//If interpolation is over 1, then change the frame
+	if (a_fInterpolation >= 1) {
+
+		a_iCurrentFrame++;
+
+		if (a_iCurrentFrame > a_iEndFrame) {
+			a_iCurrentFrame = a_iStartFrame;
+		}
+		a_iNextFrame = (a_iCurrentFrame < a_iEndFrame) ? a_iCurrentFrame + 1 : a_iStartFrame;
+
+		a_fInterpolation = 0.f;
+	}
 }
 
 
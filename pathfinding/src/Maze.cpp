@@ -1,6 +1,7 @@
 #include "Maze.h"
 #include <random>
 #include "Gizmos.h"
+#include <algorithm>
 #include <map>
 #include <vector>
 
@@ -15,13 +16,12 @@ Maze::Maze(unsigned int width, unsigned int height, float tileSize)
 	m_iWidth = width;
 	m_iHeight = height;
 	m_fTileSize = tileSize;
-	m_Tiles = new bool*[width];
-
-
-	for (unsigned int x = 0; x < width; ++x)
-	{
-		m_Tiles[x] = new bool[height];
-	}
+	m_Tiles = new bool[width * height];
+	m_search.SetGrid(m_Tiles, width, height);
+	m_hierarchy.SetGrid(m_Tiles, width, height);
+	m_flowFields.SetGrid(m_Tiles, width, height);
+	m_bJumpTableStale = false;
+	m_iNumNodesExpanded = 0;
 
 	RandomiseWalls();
 }
@@ -31,18 +31,15 @@ Maze::Maze(unsigned int width, unsigned int height, float tileSize)
 /// </summary>
 Maze::~Maze()
 {
-	for (unsigned int x = 0; x < m_iWidth; ++x)
-	{
-		delete[] m_Tiles[x];
-	}
-
 	delete[] m_Tiles;
 }
 
 
 
 /// <summary>
-/// Randomise the walls within the maze
+/// Randomise the walls within the maze, rebuild the jump table and throw
+/// away the pathfinding hierarchy and flow fields so they are built by the
+/// next search
 /// </summary>
 void Maze::RandomiseWalls()
 {
@@ -50,9 +47,38 @@ void Maze::RandomiseWalls()
 	{
 		for (unsigned int y = 0; y < m_iHeight; ++y)
 		{
-			m_Tiles[x][y] = rand() % 5 == 0 ? true : false;
+			m_Tiles[(y * m_iWidth) + x] = rand() % 5 == 0 ? true : false;
 		}
 	}
+
+	//The jump distances depend on the walls
+	m_search.BuildJumpTable();
+	m_bJumpTableStale = false;
+	m_hierarchy.SetAllTilesChanged();
+	m_flowFields.Clear();
+}
+
+/// <summary>
+/// Sets if a tile is a wall. Only the clusters of the pathfinding hierarchy
+/// around the tile are rebuilt, the jump table is rebuilt by the next JPS
+/// search and every cached flow field is thrown away
+/// </summary>
+/// <param name="x"></param>
+/// <param name="y"></param>
+/// <param name="wall">If the tile should be a wall</param>
+void Maze::SetWall(int x, int y, bool wall)
+{
+	if (x < 0 || y < 0 || x >= (int)m_iWidth || y >= (int)m_iHeight)
+		return;
+
+	bool& tile = m_Tiles[(y * m_iWidth) + x];
+	if (tile == wall)
+		return;
+
+	tile = wall;
+	m_bJumpTableStale = true;
+	m_hierarchy.SetTileChanged(x, y);
+	m_flowFields.Clear();
 }
 
 /// <summary>
@@ -127,7 +153,7 @@ bool Maze::IsWall(int x, int y)
 	if (y < 0)
 		return true;
 	
-	return m_Tiles[x][y];
+	return m_Tiles[(y * m_iWidth) + x];
 }
 
 /// <summary>
@@ -147,7 +173,7 @@ void Maze::DrawMaze()
 	{
 		for (unsigned int y = 0; y < m_iHeight; ++y)
 		{
-			if (m_Tiles[x][y])
+			if (m_Tiles[(y * m_iWidth) + x])
 			{
 				Gizmos::addBox(GetVec3(x, y), glm::vec3(m_fTileSize), true);
 			}
@@ -207,9 +233,193 @@ glm::vec3 Maze::GetVec3(Position pos)
 /// </summary>
 /// <param name="start"></param>
 /// <param name="end"></param>
-/// <param name="finalPath"></param>
+/// <param name="finalPath">Path from the end back to the start</param>
 /// <returns></returns>
 bool Maze::PathfindingDijkstra(Position start, Position end, std::vector<Position>& finalPath)
+{
+	const bool bFound = m_search.FindPath(start, end, finalPath);
+	m_iNumNodesExpanded = m_search.GetNumNodesExpanded();
+	return bFound;
+}
+
+/// <summary>
+/// Finds a path between two postions using the A* pathfinding algorithm,
+/// which only searches towards the end rather than in every direction
+/// </summary>
+/// <param name="start"></param>
+/// <param name="end"></param>
+/// <param name="finalPath">Path from the end back to the start</param>
+/// <param name="heuristic">Estimate of the distance left to the end</param>
+/// <param name="weight">Amount to scale the estimate by, above 1 searches less but paths can be up to this many times longer</param>
+/// <returns></returns>
+bool Maze::PathfindingAStar(Position start, Position end, std::vector<Position>& finalPath, GRID_HEURISTIC heuristic, float weight)
+{
+	const bool bFound = m_search.FindPath(start, end, finalPath, heuristic, weight);
+	m_iNumNodesExpanded = m_search.GetNumNodesExpanded();
+	return bFound;
+}
+
+/// <summary>
+/// Finds a path between two postions using Jump Point Search, which finds a
+/// path as short as Dijkstra's while only expanding the tiles it must turn at
+/// </summary>
+/// <param name="start"></param>
+/// <param name="end"></param>
+/// <param name="finalPath">Path from the end back to the start</param>
+/// <returns></returns>
+bool Maze::PathfindingJPS(Position start, Position end, std::vector<Position>& finalPath)
+{
+	if (m_bJumpTableStale) {
+		m_search.BuildJumpTable();
+		m_bJumpTableStale = false;
+	}
+
+	const bool bFound = m_search.FindJumpPath(start, end, finalPath);
+	m_iNumNodesExpanded = m_search.GetNumNodesExpanded();
+	return bFound;
+}
+
+/// <summary>
+/// Finds a path between two postions over the clusters of the maze. Only the
+/// entrances between clusters the path passes through are found, each step
+/// between them is refined in to tiles with RefinePathSegment as it is needed
+/// </summary>
+/// <param name="start"></param>
+/// <param name="end"></param>
+/// <param name="waypoints">Waypoints from the end back to the start</param>
+/// <returns></returns>
+bool Maze::PathfindingHierarchical(Position start, Position end, std::vector<Position>& waypoints)
+{
+	const bool bFound = m_hierarchy.FindAbstractPath(start, end, waypoints);
+	m_iNumNodesExpanded = m_hierarchy.GetNumNodesExpanded();
+	return bFound;
+}
+
+/// <summary>
+/// Refines one step of a hierarchical path in to tiles
+/// </summary>
+/// <param name="from">Waypoint to start at</param>
+/// <param name="to">Next waypoint</param>
+/// <param name="segment">Path from the next waypoint back to the first</param>
+/// <returns></returns>
+bool Maze::RefinePathSegment(Position from, Position to, std::vector<Position>& segment)
+{
+	return m_hierarchy.RefineSegment(from, to, segment);
+}
+
+/// <summary>
+/// Refines every step of a hierarchical path in to tiles
+/// </summary>
+/// <param name="waypoints">Waypoints from PathfindingHierarchical</param>
+/// <param name="finalPath">Path from the end back to the start</param>
+/// <returns></returns>
+bool Maze::RefinePath(const std::vector<Position>& waypoints, std::vector<Position>& finalPath)
+{
+	return m_hierarchy.RefinePath(waypoints, finalPath);
+}
+
+/// <summary>
+/// Rebuilds the clusters of the pathfinding hierarchy that have changed,
+/// this is otherwise done by the next hierarchical search
+/// </summary>
+/// <returns>Number of clusters rebuilt</returns>
+unsigned int Maze::UpdateHierarchy()
+{
+	m_hierarchy.Update();
+	return m_hierarchy.GetNumClustersRebuilt();
+}
+
+/// <summary>
+/// Gets the flow field heading to a tile, built the first time it is asked
+/// for and cached for the most recently used goals. Any number of agents
+/// heading to the same tile can share it, looking it up with FindFlowField
+/// each step to read the next tile from the one they are on. The field is
+/// only valid until the walls change or a field for a goal that isn't cached
+/// is asked for
+/// </summary>
+/// <param name="goal">Tile to head to</param>
+/// <returns>Field heading to the goal, nullptr if the goal is a wall</returns>
+const FlowField* Maze::GetFlowField(Position goal)
+{
+	bool bBuilt = false;
+	return m_flowFields.Acquire(goal, bBuilt);
+}
+
+/// <summary>
+/// Gets the flow field heading to a tile if it is already cached, nothing is
+/// built and the cache's counters and order of use are left as they are. For
+/// agents that read the field every step after it was built by GetFlowField
+/// </summary>
+/// <param name="goal">Tile to head to</param>
+/// <returns>Field heading to the goal, nullptr if it isn't cached</returns>
+const FlowField* Maze::FindFlowField(Position goal)
+{
+	return m_flowFields.Find(goal);
+}
+
+/// <summary>
+/// Finds a path between two postions by following the flow field heading to
+/// the end, the field is cached so later paths to the same end are only the
+/// cost of walking them
+/// </summary>
+/// <param name="start"></param>
+/// <param name="end"></param>
+/// <param name="finalPath">Path from the end back to the start</param>
+/// <returns></returns>
+bool Maze::PathfindingFlowField(Position start, Position end, std::vector<Position>& finalPath)
+{
+	finalPath.clear();
+
+	//Only a field that had to be built counts as expanding tiles
+	bool bBuilt = false;
+	const FlowField* pFlowField = m_flowFields.Acquire(end, bBuilt);
+	m_iNumNodesExpanded = (bBuilt && pFlowField != nullptr) ? pFlowField->GetNumTilesReached() : 0;
+	if (pFlowField == nullptr || IsWall(start) || pFlowField->GetDistance(start) < 0)
+	{
+		return false;
+	}
+
+	Position tile = start;
+	finalPath.push_back(tile);
+	while (pFlowField->GetNextTile(tile, tile))
+	{
+		finalPath.push_back(tile);
+	}
+
+	//The field leads from the start to the end, paths run the other way
+	std::reverse(finalPath.begin(), finalPath.end());
+	return true;
+}
+
+/// <summary>
+/// Gets the cache of flow fields, for reading how often fields were reused
+/// </summary>
+/// <returns></returns>
+FlowFieldCache& Maze::GetFlowFieldCache()
+{
+	return m_flowFields;
+}
+
+/// <summary>
+/// Gets the number of tiles, or entrances for a hierarchical search, the
+/// last search expanded
+/// </summary>
+/// <returns></returns>
+unsigned int Maze::GetNumNodesExpanded()
+{
+	return m_iNumNodesExpanded;
+}
+
+/// <summary>
+/// Finds a path between two postions using the original map based Dijkstra,
+/// kept to check and benchmark PathfindingDijkstra against. It scans every
+/// open tile each step so is far too slow for large mazes
+/// </summary>
+/// <param name="start"></param>
+/// <param name="end"></param>
+/// <param name="finalPath">Path from the end back to the start</param>
+/// <returns></returns>
+bool Maze::PathfindingDijkstraReference(Position start, Position end, std::vector<Position>& finalPath)
 {
 	//Clear the final path
 	finalPath.clear();
@@ -324,107 +534,6 @@ bool Maze::PathfindingDijkstra(Position start, Position end, std::vector<Positio
 }
 
 
-/*
-
-	ATTEMPTED IMPLEMENTATION OF A*, however freezes when called
-
-bool Maze::PathfindingAStar(Position start, Position end, std::vector<Position>& finalPath)
-{
-
-	//Clear final path
-	finalPath.clear();
-
-	//Create a start and end node
-	AStarNode startNode = AStarNode(nullptr, start);
-	startNode.g = startNode.h = startNode.f = 0;
-	AStarNode endNode = AStarNode(nullptr, end);
-	endNode.g = endNode.h = endNode.f = 0;
-
-	//Create a visited and unvisited list
-	std::vector<AStarNode> openList;
-	std::vector<AStarNode> closedList;
-
-	openList.push_back(startNode);
-
-	//Loop until we find the end or we have nothing left in the open list
-	while (openList.size() > 0) {
-
-		//Get the current node
-		AStarNode currentNode = openList[0];
-		int iCurrentIndex = 0;
-
-		for (int i = 0; i < openList.size(); i++) {
-			if (openList[i].f < currentNode.f) {
-				currentNode = openList[i];
-				iCurrentIndex = i;
-			}
-		}
-
-		//Remove current off the open list and add to the closed list
-		openList.erase(openList.begin() + iCurrentIndex);
-		closedList.push_back(currentNode);
-
-		//Check if we have found the goal, construct the path
-		if (currentNode == endNode) {
-			AStarNode* current = &currentNode;
-			//Loop through the parents of each node to construct the path
-			while (current != nullptr) {
-				finalPath.push_back(current->position);
-				current = current->parent;
-			}
-			//Return that we have found a path
-			return true;
-		}
-
-		//Construct Children Nodes
-		std::vector<AStarNode> children;
-		Position* childPostions = GetAdjacentPositions(currentNode.position);
-		for (int i = 0; i < 4; i++) {
-
-			//Check that children arent walls
-			if (IsWall(childPostions[i])) {
-				continue;
-			}
-
-			//Create a new node
-			AStarNode* pointer = &currentNode;
-			AStarNode newNode = AStarNode(pointer, childPostions[0]);
-			children.push_back(newNode);
-		}
-
-		//Loop through children
-		for each(AStarNode child in children) {
-
-			//Check if child is closed
-			for each(AStarNode closedNode in closedList) {
-				if (child == closedNode) {
-					continue;
-				}
-			}
-
-			//Create G H F values
-			child.g = currentNode.g + 1;
-			child.h = pow(child.position.x - endNode.position.x, 2) + pow(child.position.y - endNode.position.y, 2);
-			child.f = child.g + child.f;
-
-			//Check if child is already in the open node list
-			for each(AStarNode openNode in openList) {
-				if (child == openNode && child.g > openNode.g) {
-					continue;
-				}
-			}
-
-			//Add the child to the open list
-			openList.push_back(child);
-
-		}
-
-	}
-
-	return false;
-}
-*/
-
 /// <summary>
 /// Gets the postions of tiles adjacent (up, left, down, right)
 /// to the given tile
@@ -10,7 +10,12 @@
 #include "Application_Log.h"
 #include "MD2Pathfinder.h"
 #include "texture_manager.h"
+#include "md2_model_manager.h"
 #include "md2_loader.h"
+#include "md2_crowd.h"
+#include "JobSystem.h"
+#include "PathfindingBenchmark.h"
+#include <chrono>
 
 PathfindingApp::PathfindingApp()
 {
@@ -29,14 +34,72 @@ bool PathfindingApp::onCreate()
 	Gizmos::create();
 
 	TextureManager* texManager = TextureManager::CreateInstance();
+	MD2ModelManager::CreateInstance();
+	JobSystem::Create();
 
 	m_pMaze = new Maze(20, 20, 1.0f);
 
 	InitBoilerplateGL();
 
 	m_pPathfindingModel = new MD2Pathfinder("./models/monsters/gunner/tris.md2");
+	m_pPathfindingModel->SetVertexLayout(m_eVertexLayout);
+	m_pPathfindingModel->SetNormalFormat(m_eNormalFormat);
 	m_pLocationRaycaster = new LocationPicker(m_windowWidth, m_windowHeight);
 
+	//Indices don't change as the model animates so only need uploading once
+	SetModelIndexData(m_pPathfindingModel->GetNumIndices(), m_pPathfindingModel->GetIndexData());
+
+	//Every keyframe is uploaded up front so the shader can interpolate them
+	const MD2Model* pModel = m_pPathfindingModel->GetModel();
+	if (pModel != nullptr) {
+		//Neither do the colours and UVs. The split layout and both ways of
+		//interpolating in the shader read them from their own stream, so it
+		//is filled here whatever layout the pathfinder animates with
+		std::vector<MD2StaticVertex> staticData(pModel->GetNumUniqueVerts());
+		pModel->InitialiseStaticVertexBuffer(staticData.data(), (unsigned int)staticData.size());
+		SetModelStaticDrawData((unsigned int)staticData.size(), staticData.data());
+
+		std::vector<MD2PackedVertex> keyframeData(pModel->GetNumFrames() * pModel->GetNumUniqueVerts());
+		if (pModel->GetKeyframeData(keyframeData.data(), (unsigned int)keyframeData.size(), m_eKeyframeNormalFormat)) {
+			SetModelKeyframeData(pModel->GetNumUniqueVerts(), pModel->GetNumFrames(), keyframeData.data());
+		}
+
+		//Or baked in to textures so the shader can sample them
+		MD2AnimationTexture animationTexture;
+		m_bHasAnimationTextures = animationTexture.Bake(*pModel) && SetModelAnimationTextures(animationTexture);
+
+		//Check the baked textures animate the same as the CPU does before the
+		//G key can draw with them
+		if (m_bHasAnimationTextures) {
+			const float afInterpAmounts[] = { 0.f, 0.25f, 0.5f, 0.75f, 1.f };
+			const unsigned int iNumMismatches = animationTexture.CountMismatches(*pModel, afInterpAmounts, 5);
+			Application_Log* log = Application_Log::Get();
+			if (log != nullptr) {
+				log->addLog(iNumMismatches == 0 ? LOG_INFO : LOG_ERROR, "Animation textures: %u of %u samples differ from the CPU interpolation",
+					iNumMismatches, animationTexture.GetHeight() * 5);
+			}
+		}
+
+		//Check every instruction set the CPU has interpolates and blends bit
+		//for bit the same as the scalar path
+		const float afISAInterpAmounts[] = { 0.f, 0.25f, 0.5f, 0.75f, 1.f };
+		for (int iISA = MD2Interpolator::MD2_ISA_SCALAR + 1; iISA <= MD2Interpolator::GetSupportedISA(); ++iISA) {
+			const MD2Interpolator::MD2_ISA eISA = (MD2Interpolator::MD2_ISA)iISA;
+			const unsigned int iNumMismatches = pModel->CountISAMismatches(eISA, afISAInterpAmounts, 5);
+			Application_Log* log = Application_Log::Get();
+			if (log != nullptr) {
+				log->addLog(iNumMismatches == 0 ? LOG_INFO : LOG_ERROR, "Interpolation: %u of %u %s samples differ from the scalar path",
+					iNumMismatches, pModel->GetNumFrames() * 5, MD2Interpolator::GetISAName(eISA));
+			}
+		}
+
+		//Only cull the model once no pose it can take could be seen, agents
+		//are culled by a sphere round their origin
+		const MD2FrameBounds& animationBounds = pModel->GetAnimationBounds();
+		m_animationLODPolicy.SetBoundingRadius(glm::length(animationBounds.centre) + animationBounds.radius);
+	}
+	m_pPathfindingModel->SetInterpolationMode(m_eInterpolationMode);
+
 	// set the clear colour and enable depth testing and backface culling
 	glClearColor(0.25f, 0.25f, 0.25f, 1.f);
 	glEnable(GL_DEPTH_TEST);
@@ -80,16 +143,45 @@ void PathfindingApp::Update(float a_deltaTime)
 				m_pMaze->GetNumTilesHeight());
 			Position currentPlayerPos = Position(m_pPathfindingModel->GetCurrentPosition());
 
-			m_pMaze->PathfindingDijkstra(currentPlayerPos,
-				targetPathfindPos,
-				m_path);
-
-			m_pPathfindingModel->StartPath(&m_path, glm::vec3(0));
+			switch (m_ePathfindingMode) {
+			case PATHFINDING_MODE_FLOW_FIELD:
+				//The path is only kept to be drawn, the model reads its next
+				//tile from the field as it goes
+				m_pMaze->PathfindingFlowField(currentPlayerPos,
+					targetPathfindPos,
+					m_path);
+
+				m_pPathfindingModel->StartFlowField(m_pMaze, targetPathfindPos, glm::vec3(0));
+				break;
+			case PATHFINDING_MODE_HIERARCHICAL:
+				//Only the waypoints are found and drawn, the model refines the
+				//tiles between them as it walks
+				m_pMaze->PathfindingHierarchical(currentPlayerPos,
+					targetPathfindPos,
+					m_path);
+
+				m_pPathfindingModel->StartHierarchicalPath(m_pMaze, m_path, glm::vec3(0));
+				break;
+			default:
+				m_pMaze->PathfindingAStar(currentPlayerPos,
+					targetPathfindPos,
+					m_path);
+
+				m_pPathfindingModel->StartPath(&m_path, glm::vec3(0));
+				break;
+			}
 		}
 	}
 
 	m_bLeftMousePressedLastFrame = glfwGetMouseButton(m_window, GLFW_MOUSE_BUTTON_1);
 
+	//Cycle click to move between A* paths, flow fields and hierarchical paths
+	if (!m_bPathfindingModeKeyPressedLastFrame && glfwGetKey(m_window, GLFW_KEY_F) == GLFW_PRESS) {
+		m_ePathfindingMode = (PATHFINDING_MODE)((m_ePathfindingMode + 1) % PATHFINDING_MODE_COUNT);
+	}
+
+	m_bPathfindingModeKeyPressedLastFrame = glfwGetKey(m_window, GLFW_KEY_F);
+
 	#pragma endregion
 
 	#pragma region Change Skin of Model
@@ -133,15 +225,89 @@ void PathfindingApp::Update(float a_deltaTime)
 
 	#pragma endregion
 
+	#pragma region Change Interpolation Mode
+
+	//Cycle between interpolating on the CPU, in the vertex shader from the
+	//keyframe buffer and in the vertex shader from the animation textures
+	if (!m_bInterpolationKeyPressedLastFrame && glfwGetKey(m_window, GLFW_KEY_G) == GLFW_PRESS) {
+		m_eInterpolationMode = (MD2_INTERPOLATION_MODE)((m_eInterpolationMode + 1) % MD2_INTERPOLATION_COUNT);
+		if (m_eInterpolationMode == MD2_INTERPOLATION_TEXTURE && !m_bHasAnimationTextures) {
+			m_eInterpolationMode = MD2_INTERPOLATION_CPU;
+		}
+		m_pPathfindingModel->SetInterpolationMode(m_eInterpolationMode);
+	}
+
+	m_bInterpolationKeyPressedLastFrame = glfwGetKey(m_window, GLFW_KEY_G);
+
+	#pragma endregion
+
+	#pragma region Crowd Benchmark
+
+	//Time animating a crowd of agents that share the model
+	if (!m_bBenchmarkKeyPressedLastFrame && glfwGetKey(m_window, GLFW_KEY_B) == GLFW_PRESS) {
+		BenchmarkCrowd(1000, 100, 8);
+	}
+
+	m_bBenchmarkKeyPressedLastFrame = glfwGetKey(m_window, GLFW_KEY_B);
+
+	#pragma endregion
+
+	#pragma region Pathfinding Benchmark
+
+	//Time path finding on mazes from 20x20 up to 2048x2048, the mazes are
+	//large so it runs on its own thread and is logged once it finishes
+	if (!m_bPathfindingBenchmarkKeyPressedLastFrame && glfwGetKey(m_window, GLFW_KEY_P) == GLFW_PRESS && !m_pathfindingBenchmark.valid()) {
+		m_pathfindingBenchmark = std::async(std::launch::async, []() {
+			std::vector<std::string> lines;
+			PathfindingBenchmark::Run(16, lines);
+			return lines;
+		});
+	}
+
+	m_bPathfindingBenchmarkKeyPressedLastFrame = glfwGetKey(m_window, GLFW_KEY_P);
+
+	if (m_pathfindingBenchmark.valid() && m_pathfindingBenchmark.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+		const std::vector<std::string> lines = m_pathfindingBenchmark.get();
+		Application_Log* log = Application_Log::Get();
+		if (log != nullptr) {
+			for (const std::string& line : lines) {
+				log->addLog(LOG_INFO, "%s", line.c_str());
+			}
+		}
+	}
+
+	#pragma endregion
+
 	//Set Texture ID
 
 	SetModelTextureID(m_pPathfindingModel->GetTextureID());
 
+	//Animate less often the further the model is from the camera and stop
+	//making vertices when it is out of view
+	m_animationLODPolicy.SetCamera(glm::vec3(m_cameraMatrix[3]), m_projectionMatrix * glm::inverse(m_cameraMatrix));
+	m_pPathfindingModel->SetAnimationLOD(m_animationLODPolicy.GetLOD(glm::vec3(m_pPathfindingModel->GetModelMatrix()[3])));
+
 	//Update and set draw data
 	m_pPathfindingModel->Update(a_deltaTime);
-	MD2Vertex* currentVertexData = m_pPathfindingModel->GetVertsData();
-	SetModelDrawData(m_pPathfindingModel->GetNumVerts(), sizeof(MD2Vertex), currentVertexData);
-	delete[] currentVertexData;
+	if (m_eInterpolationMode != MD2_INTERPOLATION_CPU) {
+		//Nothing is uploaded, the shader is only told which frames to draw
+		m_iKeyframeCurrentFrame = m_pPathfindingModel->GetCurrentFrame();
+		m_iKeyframeNextFrame = m_pPathfindingModel->GetNextFrame();
+		m_fKeyframeInterpolation = m_pPathfindingModel->GetInterpolation();
+	}
+	else if (m_eVertexLayout == MD2_VERTEX_LAYOUT_SPLIT && m_eNormalFormat != MD2_NORMAL_FORMAT_FLOAT) {
+		const MD2PackedVertex* currentVertexData = m_pPathfindingModel->GetPackedVertsData();
+		SetModelDrawData(m_pPathfindingModel->GetNumVerts(), sizeof(MD2PackedVertex), currentVertexData);
+		m_fNormalInterpolation = m_pPathfindingModel->GetInterpolation();
+	}
+	else if (m_eVertexLayout == MD2_VERTEX_LAYOUT_SPLIT) {
+		const MD2DynamicVertex* currentVertexData = m_pPathfindingModel->GetDynamicVertsData();
+		SetModelDrawData(m_pPathfindingModel->GetNumVerts(), sizeof(MD2DynamicVertex), currentVertexData);
+	}
+	else {
+		const MD2Vertex* currentVertexData = m_pPathfindingModel->GetVertsData();
+		SetModelDrawData(m_pPathfindingModel->GetNumVerts(), sizeof(MD2Vertex), currentVertexData);
+	}
 		
 
 	
@@ -184,7 +350,7 @@ void PathfindingApp::Draw()
 
 	m_pLocationRaycaster->Draw();
 	m_pMaze->DrawMaze();
-	DrawModel(m_pPathfindingModel->GetNumVerts());
+	DrawModel(m_pPathfindingModel->GetNumIndices(), m_pPathfindingModel->GetModelMatrix());
 
 	if (m_bDrawPath) {
 		m_pMaze->DrawPath(m_path);
@@ -192,12 +358,129 @@ void PathfindingApp::Draw()
 		
 }
 
+/// <summary>
+/// Appends the bytes of every agents vertices in whichever layout the crowd
+/// interpolates to
+/// </summary>
+/// <param name="a_crowd">Crowd to read the vertices from</param>
+/// <param name="a_outBytes">Bytes to append the vertices to</param>
+static void AppendCrowdVertices(const MD2Crowd& a_crowd, std::vector<unsigned char>& a_outBytes)
+{
+	const size_t iNumVerts = a_crowd.GetNumVertsPerAgent();
+	for (unsigned int i = 0; i < a_crowd.GetNumAgents(); ++i) {
+		const unsigned char* pBytes = nullptr;
+		size_t iNumBytes = 0;
+		if (a_crowd.GetVertsData(i) != nullptr) {
+			pBytes = reinterpret_cast<const unsigned char*>(a_crowd.GetVertsData(i));
+			iNumBytes = iNumVerts * sizeof(MD2Vertex);
+		}
+		else if (a_crowd.GetDynamicVertsData(i) != nullptr) {
+			pBytes = reinterpret_cast<const unsigned char*>(a_crowd.GetDynamicVertsData(i));
+			iNumBytes = iNumVerts * sizeof(MD2DynamicVertex);
+		}
+		else if (a_crowd.GetPackedVertsData(i) != nullptr) {
+			pBytes = reinterpret_cast<const unsigned char*>(a_crowd.GetPackedVertsData(i));
+			iNumBytes = iNumVerts * sizeof(MD2PackedVertex);
+		}
+		a_outBytes.insert(a_outBytes.end(), pBytes, pBytes + iNumBytes);
+	}
+}
+
+/// <summary>
+/// Animates a crowd of agents sharing the pathfinders model and logs how many
+/// agents are updated and interpolated each millisecond, first on this thread,
+/// then across the job system and then with the agents spread around the
+/// camera so they are animated at their level of detail. The vertices from
+/// the job system are checked to be byte for byte the same as this thread's
+/// </summary>
+/// <param name="a_iNumAgents">Number of agents in the crowd</param>
+/// <param name="a_iNumUpdates">Number of frames to time</param>
+/// <param name="a_iInterpolationSteps">Steps to quantise interpolation to so agents can share poses, 0 for none</param>
+void PathfindingApp::BenchmarkCrowd(unsigned int a_iNumAgents, unsigned int a_iNumUpdates, unsigned int a_iInterpolationSteps)
+{
+	const MD2Model* pModel = m_pPathfindingModel->GetModel();
+	if (pModel == nullptr || a_iNumAgents == 0 || a_iNumUpdates == 0) {
+		return;
+	}
+
+	//Spread the agents over every frame so they are not all in step, both
+	//runs use the same starting poses
+	const unsigned int iNumFrames = pModel->GetNumFrames();
+	const MD2Animation allFrames = { 0, iNumFrames - 1 };
+	std::vector<unsigned int> startFrames(a_iNumAgents);
+	std::vector<float> startInterpolations(a_iNumAgents);
+	std::vector<glm::vec3> positions(a_iNumAgents);
+	for (unsigned int i = 0; i < a_iNumAgents; ++i) {
+		startFrames[i] = rand() % iNumFrames;
+		startInterpolations[i] = (float)rand() / ((float)RAND_MAX + 1.f);
+		positions[i] = glm::vec3((float)(rand() % 200) - 100.f, 0.f, (float)(rand() % 200) - 100.f);
+	}
+
+	std::vector<unsigned char> singleThreadVertices;
+	std::vector<unsigned char> crowdVertices;
+
+	for (unsigned int iRun = 0; iRun < 3; ++iRun) {
+		JobSystem* pJobSystem = (iRun == 0) ? nullptr : JobSystem::Get();
+		const bool bUseLOD = (iRun == 2);
+		if (iRun == 1 && pJobSystem == nullptr) {
+			continue;
+		}
+
+		MD2Crowd crowd(pModel, m_eVertexLayout, m_eNormalFormat);
+		crowd.SetInterpolationSteps(a_iInterpolationSteps);
+		for (unsigned int i = 0; i < a_iNumAgents; ++i) {
+			const unsigned int iAgent = crowd.AddAgent(allFrames, 10.f);
+			crowd.SetFrame(iAgent, startFrames[i], startInterpolations[i]);
+		}
+
+		//The camera doesn't move while the benchmark runs
+		if (bUseLOD) {
+			crowd.UpdateLODs(m_animationLODPolicy, positions.data());
+		}
+
+		const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+		for (unsigned int i = 0; i < a_iNumUpdates; ++i) {
+			crowd.Update(1.f / 60.f, pJobSystem);
+			crowd.Interpolate(pJobSystem);
+		}
+		const std::chrono::high_resolution_clock::time_point endTime = std::chrono::high_resolution_clock::now();
+
+		const double dElapsedMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+		const double dAgentsPerMs = ((double)a_iNumAgents * a_iNumUpdates) / dElapsedMs;
+
+		//Both runs without LOD start from the same poses so must end with the
+		//same vertices however many threads they ran on
+		crowdVertices.clear();
+		AppendCrowdVertices(crowd, crowdVertices);
+		if (iRun == 0) {
+			singleThreadVertices.swap(crowdVertices);
+		}
+		const unsigned int iNumThreads = (pJobSystem != nullptr) ? pJobSystem->getThreadCount() : 1;
+
+		Application_Log* log = Application_Log::Get();
+		if (log != nullptr) {
+			log->addLog(LOG_INFO, "Crowd benchmark: %u agents, %u updates on %u threads%s in %.2fms, %.1f agents per ms (cache hits %llu, misses %llu)",
+				a_iNumAgents, a_iNumUpdates, iNumThreads, bUseLOD ? " with animation LOD" : "", dElapsedMs, dAgentsPerMs,
+				crowd.GetNumKeyframeCacheHits(), crowd.GetNumKeyframeCacheMisses());
+			log->addLog(LOG_INFO, "Crowd benchmark: %u interpolation steps, %llu of %llu poses interpolated, %.1f%% shared",
+				a_iInterpolationSteps, crowd.GetNumPosesInterpolated(), crowd.GetNumPosesRequested(), crowd.GetPoseSharingRate() * 100.f);
+			if (iRun == 1) {
+				const bool bMatches = (crowdVertices == singleThreadVertices);
+				log->addLog(bMatches ? LOG_INFO : LOG_ERROR, "Crowd benchmark: vertices on %u threads %s the vertices on 1 thread",
+					iNumThreads, bMatches ? "match" : "differ from");
+			}
+		}
+	}
+}
+
 //Destroy Allocated memory from app
 void PathfindingApp::Destroy()
 {
 	if (m_pPathfindingModel) {
 		delete m_pPathfindingModel;
 	}
+	MD2ModelManager::DestroyInstance();
+	JobSystem::Destroy();
 	if (m_pMaze) {
 		delete m_pMaze;
 	}
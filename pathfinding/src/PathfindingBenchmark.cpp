@@ -0,0 +1,397 @@
+#include "PathfindingBenchmark.h"
+
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+
+/// <summary>
+/// Finds paths between random tiles of random mazes from 20x20 up to
+/// 2048x2048 with every search and checks them against Dijkstra's. On the
+/// smaller mazes the map based search must find the same paths, A* paths
+/// must be no longer than its weight allows and JPS and flow field paths
+/// must be as short. A crowd heading to one goal is timed with A* against a
+/// shared flow field, and last the hierarchical search is timed and some
+/// tiles changed to time rebuilding the clusters around them
+/// </summary>
+/// <param name="a_iNumQueries">Number of paths to find in each maze</param>
+/// <param name="a_outLines">Lines describing each result are added to this</param>
+/// <returns>If every check passed</returns>
+bool PathfindingBenchmark::Run(unsigned int a_iNumQueries, std::vector<std::string>& a_outLines)
+{
+	if (a_iNumQueries == 0) {
+		return true;
+	}
+
+	const unsigned int aiMazeSizes[] = { 20, 64, 256, 1024, 2048 };
+	//The map based search scans every open tile each step
+	const unsigned int iMaxReferenceSize = 64;
+	const unsigned int iNumCrowdAgents = 256;
+
+	bool bPassed = true;
+	for (unsigned int iMazeSize : aiMazeSizes) {
+		Maze maze(iMazeSize, iMazeSize, 1.f);
+		PathfindingQueries queries = CreateQueries(iMazeSize, a_iNumQueries);
+
+		const PathfindingBenchmarkResult dijkstra = RunDijkstra(maze, queries);
+		AddLine(a_outLines, "Pathfinding benchmark: %ux%u maze, %u of %u paths found, %zu tiles long in total, Dijkstra %.3fms per path, %llu tiles expanded",
+			iMazeSize, iMazeSize, dijkstra.numFound, a_iNumQueries, dijkstra.totalLength, dijkstra.elapsedMs / a_iNumQueries, dijkstra.numExpanded);
+
+		if (iMazeSize <= iMaxReferenceSize) {
+			const PathfindingBenchmarkResult reference = RunDijkstraReference(maze, queries);
+			AddLine(a_outLines, "Pathfinding benchmark: %ux%u maze, map based search %.3fms per path, %u paths differ",
+				iMazeSize, iMazeSize, reference.elapsedMs / a_iNumQueries, reference.numWrong);
+			bPassed = bPassed && reference.numWrong == 0;
+		}
+
+		//A* with each heuristic and then weighted to trade path length for speed
+		const GRID_HEURISTIC aeHeuristics[] = { GRID_HEURISTIC_MANHATTAN, GRID_HEURISTIC_OCTILE, GRID_HEURISTIC_EUCLIDEAN, GRID_HEURISTIC_MANHATTAN };
+		const float afWeights[] = { 1.f, 1.f, 1.f, 1.5f };
+		const char* aszHeuristicNames[GRID_HEURISTIC_COUNT] = { "none", "Manhattan", "octile", "Euclidean" };
+		for (unsigned int iRun = 0; iRun < 4; ++iRun) {
+			const PathfindingBenchmarkResult aStar = RunAStar(maze, queries, aeHeuristics[iRun], afWeights[iRun]);
+			AddLine(a_outLines, "Pathfinding benchmark: %ux%u maze, A* %s x%.1f %.3fms per path, %llu tiles expanded (%.1f%% of Dijkstra), %zu tiles long in total, %u paths too long",
+				iMazeSize, iMazeSize, aszHeuristicNames[aeHeuristics[iRun]], afWeights[iRun], aStar.elapsedMs / a_iNumQueries,
+				aStar.numExpanded, (dijkstra.numExpanded > 0) ? (100.0 * aStar.numExpanded) / dijkstra.numExpanded : 0.0, aStar.totalLength, aStar.numWrong);
+			bPassed = bPassed && aStar.numWrong == 0;
+		}
+
+		const PathfindingBenchmarkResult jump = RunJPS(maze, queries);
+		AddLine(a_outLines, "Pathfinding benchmark: %ux%u maze, JPS %.3fms per path, %llu tiles expanded (%.2f%% of Dijkstra), %zu tiles long in total, %u paths a different length",
+			iMazeSize, iMazeSize, jump.elapsedMs / a_iNumQueries, jump.numExpanded,
+			(dijkstra.numExpanded > 0) ? (100.0 * jump.numExpanded) / dijkstra.numExpanded : 0.0, jump.totalLength, jump.numWrong);
+		bPassed = bPassed && jump.numWrong == 0;
+
+		const PathfindingBenchmarkResult flowField = RunFlowField(maze, queries);
+		AddLine(a_outLines, "Pathfinding benchmark: %ux%u maze, flow fields %.3fms per path, %llu tiles expanded, %u paths a different length, cache hits %llu, misses %llu, %.1f%% reused",
+			iMazeSize, iMazeSize, flowField.elapsedMs / a_iNumQueries, flowField.numExpanded, flowField.numWrong,
+			flowField.numCacheHits, flowField.numCacheMisses, GetCacheReuseRate(flowField) * 100.0);
+		bPassed = bPassed && flowField.numWrong == 0;
+
+		//A* with the Manhattan heuristic finds the shortest paths, so the
+		//crowd can only walk as far through the field if every agent took a
+		//shortest path
+		std::vector<Position> agentTiles(iNumCrowdAgents);
+		for (unsigned int i = 0; i < iNumCrowdAgents; ++i) {
+			agentTiles[i] = Position(rand() % iMazeSize, rand() % iMazeSize);
+		}
+		const PathfindingBenchmarkResult crowdAStar = RunCrowdAStar(maze, agentTiles, queries.ends[0]);
+		const PathfindingBenchmarkResult crowdFlowField = RunCrowdFlowField(maze, agentTiles, queries.ends[0]);
+		AddLine(a_outLines, "Pathfinding benchmark: %ux%u maze, %u agents to one goal, A* %.2fms, flow field %.2fms, %zu and %zu tiles walked, cache hits %llu, misses %llu, %.1f%% reused",
+			iMazeSize, iMazeSize, iNumCrowdAgents, crowdAStar.elapsedMs, crowdFlowField.elapsedMs, crowdAStar.totalLength, crowdFlowField.totalLength,
+			crowdFlowField.numCacheHits, crowdFlowField.numCacheMisses, GetCacheReuseRate(crowdFlowField) * 100.0);
+		bPassed = bPassed && crowdAStar.totalLength == crowdFlowField.totalLength && crowdAStar.numFound == crowdFlowField.numFound;
+
+		//The abstract graph is built before the searches are timed
+		unsigned int iNumClustersBuilt = 0;
+		const double dBuildElapsedMs = TimeHierarchyUpdate(maze, iNumClustersBuilt);
+		const PathfindingBenchmarkResult hierarchical = RunHierarchical(maze, queries);
+		AddLine(a_outLines, "Pathfinding benchmark: %ux%u maze, HPA* %.3fms per path to the first segment, %llu nodes expanded (%.2f%% of Dijkstra), %zu tiles long refined (%.1f%% longer), %u paths found wrongly",
+			iMazeSize, iMazeSize, hierarchical.elapsedMs / a_iNumQueries, hierarchical.numExpanded,
+			(dijkstra.numExpanded > 0) ? (100.0 * hierarchical.numExpanded) / dijkstra.numExpanded : 0.0, hierarchical.totalLength,
+			(dijkstra.totalLength > 0) ? (100.0 * ((double)hierarchical.totalLength - dijkstra.totalLength)) / dijkstra.totalLength : 0.0, hierarchical.numWrong);
+		bPassed = bPassed && hierarchical.numWrong == 0;
+
+		//Change some tiles and rebuild only the clusters around them
+		for (unsigned int i = 0; i < 64; ++i) {
+			maze.SetWall(rand() % iMazeSize, rand() % iMazeSize, rand() % 5 == 0);
+		}
+		unsigned int iNumClustersRebuilt = 0;
+		const double dRebuildElapsedMs = TimeHierarchyUpdate(maze, iNumClustersRebuilt);
+		AddLine(a_outLines, "Pathfinding benchmark: %ux%u maze, HPA* built %u clusters in %.2fms, 64 tile changes rebuilt %u clusters in %.2fms",
+			iMazeSize, iMazeSize, iNumClustersBuilt, dBuildElapsedMs, iNumClustersRebuilt, dRebuildElapsedMs);
+	}
+
+	AddLine(a_outLines, "Pathfinding benchmark: %s", bPassed ? "every check passed" : "some checks FAILED");
+	return bPassed;
+}
+
+/// <summary>
+/// Picks random start and end tiles, the paths are left to RunDijkstra
+/// </summary>
+/// <param name="a_iMazeSize">Number of tiles across and down the maze</param>
+/// <param name="a_iNumQueries">Number of paths to find</param>
+/// <returns>Queries with no paths</returns>
+PathfindingQueries PathfindingBenchmark::CreateQueries(unsigned int a_iMazeSize, unsigned int a_iNumQueries)
+{
+	PathfindingQueries queries;
+	queries.starts.resize(a_iNumQueries);
+	queries.ends.resize(a_iNumQueries);
+	queries.paths.resize(a_iNumQueries);
+	for (unsigned int i = 0; i < a_iNumQueries; ++i) {
+		queries.starts[i] = Position(rand() % a_iMazeSize, rand() % a_iMazeSize);
+		queries.ends[i] = Position(rand() % a_iMazeSize, rand() % a_iMazeSize);
+	}
+	return queries;
+}
+
+/// <summary>
+/// Finds every path with Dijkstra's algorithm and keeps them in the queries
+/// for the other searches to be checked against
+/// </summary>
+PathfindingBenchmarkResult PathfindingBenchmark::RunDijkstra(Maze& a_maze, PathfindingQueries& a_queries)
+{
+	PathfindingBenchmarkResult result = {};
+	const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < a_queries.starts.size(); ++i) {
+		if (a_maze.PathfindingDijkstra(a_queries.starts[i], a_queries.ends[i], a_queries.paths[i])) {
+			++result.numFound;
+			result.totalLength += a_queries.paths[i].size();
+		}
+		result.numExpanded += a_maze.GetNumNodesExpanded();
+	}
+	const std::chrono::high_resolution_clock::time_point endTime = std::chrono::high_resolution_clock::now();
+	result.elapsedMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+	return result;
+}
+
+/// <summary>
+/// Finds every path with the map based search, which must find the same
+/// paths as Dijkstra
+/// </summary>
+PathfindingBenchmarkResult PathfindingBenchmark::RunDijkstraReference(Maze& a_maze, const PathfindingQueries& a_queries)
+{
+	PathfindingBenchmarkResult result = {};
+	std::vector<Position> path;
+	const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < a_queries.starts.size(); ++i) {
+		if (a_maze.PathfindingDijkstraReference(a_queries.starts[i], a_queries.ends[i], path)) {
+			++result.numFound;
+			result.totalLength += path.size();
+		}
+		if (path != a_queries.paths[i]) {
+			++result.numWrong;
+		}
+	}
+	const std::chrono::high_resolution_clock::time_point endTime = std::chrono::high_resolution_clock::now();
+	result.elapsedMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+	return result;
+}
+
+/// <summary>
+/// Finds every path with A*, each path must be no more than the weight times
+/// longer than Dijkstra's
+/// </summary>
+PathfindingBenchmarkResult PathfindingBenchmark::RunAStar(Maze& a_maze, const PathfindingQueries& a_queries, GRID_HEURISTIC a_eHeuristic, float a_fWeight)
+{
+	PathfindingBenchmarkResult result = {};
+	std::vector<Position> path;
+	const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < a_queries.starts.size(); ++i) {
+		const bool bFound = a_maze.PathfindingAStar(a_queries.starts[i], a_queries.ends[i], path, a_eHeuristic, a_fWeight);
+		if (bFound) {
+			++result.numFound;
+			result.totalLength += path.size();
+		}
+		if (bFound == a_queries.paths[i].empty() ||
+			(bFound && (float)(path.size() - 1) > a_fWeight * (float)(a_queries.paths[i].size() - 1))) {
+			++result.numWrong;
+		}
+		result.numExpanded += a_maze.GetNumNodesExpanded();
+	}
+	const std::chrono::high_resolution_clock::time_point endTime = std::chrono::high_resolution_clock::now();
+	result.elapsedMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+	return result;
+}
+
+/// <summary>
+/// Finds every path with Jump Point Search, each path must be as short as
+/// Dijkstra's
+/// </summary>
+PathfindingBenchmarkResult PathfindingBenchmark::RunJPS(Maze& a_maze, const PathfindingQueries& a_queries)
+{
+	PathfindingBenchmarkResult result = {};
+	std::vector<Position> path;
+	const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < a_queries.starts.size(); ++i) {
+		if (a_maze.PathfindingJPS(a_queries.starts[i], a_queries.ends[i], path)) {
+			++result.numFound;
+			result.totalLength += path.size();
+		}
+		if (path.size() != a_queries.paths[i].size()) {
+			++result.numWrong;
+		}
+		result.numExpanded += a_maze.GetNumNodesExpanded();
+	}
+	const std::chrono::high_resolution_clock::time_point endTime = std::chrono::high_resolution_clock::now();
+	result.elapsedMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+	return result;
+}
+
+/// <summary>
+/// Finds every path by following the flow field to its end, each path must
+/// be as short as Dijkstra's. Every query has its own end so most build a
+/// field
+/// </summary>
+PathfindingBenchmarkResult PathfindingBenchmark::RunFlowField(Maze& a_maze, const PathfindingQueries& a_queries)
+{
+	PathfindingBenchmarkResult result = {};
+	std::vector<Position> path;
+	FlowFieldCache& flowFieldCache = a_maze.GetFlowFieldCache();
+	flowFieldCache.ResetCounters();
+	const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < a_queries.starts.size(); ++i) {
+		if (a_maze.PathfindingFlowField(a_queries.starts[i], a_queries.ends[i], path)) {
+			++result.numFound;
+			result.totalLength += path.size();
+		}
+		if (path.size() != a_queries.paths[i].size()) {
+			++result.numWrong;
+		}
+		result.numExpanded += a_maze.GetNumNodesExpanded();
+	}
+	const std::chrono::high_resolution_clock::time_point endTime = std::chrono::high_resolution_clock::now();
+	result.elapsedMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+	result.numCacheHits = flowFieldCache.GetNumHits();
+	result.numCacheMisses = flowFieldCache.GetNumMisses();
+	return result;
+}
+
+/// <summary>
+/// Finds a path to one goal with A* for each agent of a crowd
+/// </summary>
+/// <param name="a_maze">Maze the crowd is in</param>
+/// <param name="a_agentTiles">Tile each agent starts on</param>
+/// <param name="a_goal">Tile every agent heads to</param>
+PathfindingBenchmarkResult PathfindingBenchmark::RunCrowdAStar(Maze& a_maze, const std::vector<Position>& a_agentTiles, Position a_goal)
+{
+	PathfindingBenchmarkResult result = {};
+	std::vector<Position> path;
+	const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < a_agentTiles.size(); ++i) {
+		if (a_maze.PathfindingAStar(a_agentTiles[i], a_goal, path)) {
+			++result.numFound;
+			result.totalLength += path.size();
+		}
+		result.numExpanded += a_maze.GetNumNodesExpanded();
+	}
+	const std::chrono::high_resolution_clock::time_point endTime = std::chrono::high_resolution_clock::now();
+	result.elapsedMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+	return result;
+}
+
+/// <summary>
+/// Walks a crowd to one goal through a shared flow field. Each agent asks
+/// for the field when it starts, only the first builds it, then each step
+/// every agent that hasn't arrived looks the field up and reads its next tile
+/// from it like a PathfindingObject does. The time includes building the field
+/// </summary>
+/// <param name="a_maze">Maze the crowd is in</param>
+/// <param name="a_agentTiles">Tile each agent starts on</param>
+/// <param name="a_goal">Tile every agent heads to</param>
+PathfindingBenchmarkResult PathfindingBenchmark::RunCrowdFlowField(Maze& a_maze, const std::vector<Position>& a_agentTiles, Position a_goal)
+{
+	PathfindingBenchmarkResult result = {};
+	std::vector<Position> agentTiles(a_agentTiles);
+	std::vector<bool> agentsArrived(agentTiles.size(), false);
+
+	//Drop any field already built so the build is timed too
+	FlowFieldCache& flowFieldCache = a_maze.GetFlowFieldCache();
+	flowFieldCache.Clear();
+	flowFieldCache.ResetCounters();
+	const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+	const FlowField* pFlowField = nullptr;
+	for (size_t i = 0; i < agentTiles.size(); ++i) {
+		pFlowField = a_maze.GetFlowField(a_goal);
+		if (pFlowField != nullptr && pFlowField->GetDistance(agentTiles[i]) >= 0) {
+			++result.numFound;
+			++result.totalLength;
+		}
+	}
+	result.numExpanded = (pFlowField != nullptr) ? pFlowField->GetNumTilesReached() : 0;
+
+	bool bAgentsMoving = true;
+	while (bAgentsMoving) {
+		bAgentsMoving = false;
+		for (size_t i = 0; i < agentTiles.size(); ++i) {
+			if (agentsArrived[i]) {
+				continue;
+			}
+			pFlowField = a_maze.FindFlowField(a_goal);
+			if (pFlowField != nullptr && pFlowField->GetNextTile(agentTiles[i], agentTiles[i])) {
+				++result.totalLength;
+				bAgentsMoving = true;
+			}
+			else {
+				agentsArrived[i] = true;
+			}
+		}
+	}
+	const std::chrono::high_resolution_clock::time_point endTime = std::chrono::high_resolution_clock::now();
+	result.elapsedMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+	result.numCacheHits = flowFieldCache.GetNumHits();
+	result.numCacheMisses = flowFieldCache.GetNumMisses();
+	return result;
+}
+
+/// <summary>
+/// Finds every path with the hierarchical search, the time is to the first
+/// refined segment as that is all an agent needs to start walking. Every
+/// path is then refined in full, untimed, to count how much longer than
+/// Dijkstra's they are. A path must be found for the same queries as
+/// Dijkstra. The abstract graph must be up to date
+/// </summary>
+PathfindingBenchmarkResult PathfindingBenchmark::RunHierarchical(Maze& a_maze, const PathfindingQueries& a_queries)
+{
+	PathfindingBenchmarkResult result = {};
+	std::vector<std::vector<Position>> waypoints(a_queries.starts.size());
+	std::vector<Position> segment;
+	const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+	for (size_t i = 0; i < a_queries.starts.size(); ++i) {
+		if (a_maze.PathfindingHierarchical(a_queries.starts[i], a_queries.ends[i], waypoints[i])) {
+			++result.numFound;
+			if (waypoints[i].size() > 1) {
+				a_maze.RefinePathSegment(waypoints[i][waypoints[i].size() - 1], waypoints[i][waypoints[i].size() - 2], segment);
+			}
+		}
+		result.numExpanded += a_maze.GetNumNodesExpanded();
+	}
+	const std::chrono::high_resolution_clock::time_point endTime = std::chrono::high_resolution_clock::now();
+	result.elapsedMs = std::chrono::duration<double, std::milli>(endTime - startTime).count();
+
+	std::vector<Position> refinedPath;
+	for (size_t i = 0; i < a_queries.starts.size(); ++i) {
+		a_maze.RefinePath(waypoints[i], refinedPath);
+		result.totalLength += refinedPath.size();
+		if (refinedPath.empty() != a_queries.paths[i].empty()) {
+			++result.numWrong;
+		}
+	}
+	return result;
+}
+
+/// <summary>
+/// Times bringing the hierarchical search's abstract graph up to date
+/// </summary>
+/// <param name="a_maze">Maze to update</param>
+/// <param name="a_iOutNumClusters">Number of clusters rebuilt</param>
+/// <returns>Time taken in milliseconds</returns>
+double PathfindingBenchmark::TimeHierarchyUpdate(Maze& a_maze, unsigned int& a_iOutNumClusters)
+{
+	const std::chrono::high_resolution_clock::time_point startTime = std::chrono::high_resolution_clock::now();
+	a_iOutNumClusters = a_maze.UpdateHierarchy();
+	const std::chrono::high_resolution_clock::time_point endTime = std::chrono::high_resolution_clock::now();
+	return std::chrono::duration<double, std::milli>(endTime - startTime).count();
+}
+
+/// <summary>
+/// Gets the fraction of flow field cache lookups that found a field already built
+/// </summary>
+double PathfindingBenchmark::GetCacheReuseRate(const PathfindingBenchmarkResult& a_result)
+{
+	const unsigned long long iNumLookups = a_result.numCacheHits + a_result.numCacheMisses;
+	return (iNumLookups > 0) ? (double)a_result.numCacheHits / iNumLookups : 0.0;
+}
+
+/// <summary>
+/// Formats a line and adds it to the lines
+/// </summary>
+void PathfindingBenchmark::AddLine(std::vector<std::string>& a_outLines, const char* a_szFormat, ...)
+{
+	char szLine[512];
+	va_list args;
+	va_start(args, a_szFormat);
+	vsnprintf(szLine, sizeof(szLine), a_szFormat, args);
+	va_end(args);
+	a_outLines.push_back(szLine);
+}
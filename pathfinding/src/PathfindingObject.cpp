@@ -4,6 +4,8 @@
 #include "Gizmos.h"
 #include "Maze.h"
 #include <glm/glm.hpp>
+#include <algorithm>
+#include <cmath>
 
 
 /// <summary>
@@ -54,6 +56,8 @@ void PathfindingObject::StartPath(std::vector<Position>* a_pPath, glm::vec3 a_pa
 
 	m_path = *a_pPath;
 	m_pathOffset = a_pathStartPos;
+	m_pFlowFieldMaze = nullptr;
+	m_pHierarchyMaze = nullptr;
 
 	//Reverse the path becuase when it is spit out from the 
 	//maze it starts at the end
@@ -66,6 +70,68 @@ void PathfindingObject::StartPath(std::vector<Position>* a_pPath, glm::vec3 a_pa
 	m_bFollowingPath = true;
 }
 
+/// <summary>
+/// Starts the pathfinding object heading to a goal by following the maze's
+/// flow field to it, the next postion is read from the field each time one
+/// is reached so any number of objects can share the field. The field is
+/// built now if it isn't cached, the object stops if it is dropped from the
+/// cache before the goal is reached
+/// </summary>
+/// <param name="a_pMaze">Maze to get the flow field from</param>
+/// <param name="a_goal">Tile to head to</param>
+/// <param name="a_pathOffset">Postion of the maze's first tile</param>
+void PathfindingObject::StartFlowField(Maze* a_pMaze, Position a_goal, glm::vec3 a_pathOffset)
+{
+	if (a_pMaze == nullptr) {
+		return;
+	}
+
+	if (a_pMaze->GetFlowField(a_goal) == nullptr) {
+		return;
+	}
+
+	m_path.clear();
+	m_pathOffset = a_pathOffset;
+	m_pFlowFieldMaze = a_pMaze;
+	m_pHierarchyMaze = nullptr;
+	m_flowFieldGoal = a_goal;
+
+	//Move on to the tile we are over first, the field is read from there
+	const glm::vec3 mazePosition = m_currentPostion - m_pathOffset;
+	const Position currentTile((int)roundf(mazePosition.x), (int)roundf(mazePosition.z));
+	m_currentTargetPostion = glm::vec3(currentTile.x, 0, currentTile.y) + m_pathOffset;
+	m_bFollowingPath = true;
+}
+
+/// <summary>
+/// Starts the pathfinding object on a hierarchical path. Only the segment to
+/// the first waypoint is refined in to tiles now, each segment after is
+/// refined when the one before it has been walked so walls changed on the
+/// way are seen
+/// </summary>
+/// <param name="a_pMaze">Maze the waypoints were found in</param>
+/// <param name="a_waypoints">Waypoints from the end back to the start, from Maze::PathfindingHierarchical</param>
+/// <param name="a_pathOffset">Postion of the maze's first tile</param>
+void PathfindingObject::StartHierarchicalPath(Maze* a_pMaze, const std::vector<Position>& a_waypoints, glm::vec3 a_pathOffset)
+{
+	if (a_pMaze == nullptr || a_waypoints.size() == 0) {
+		return;
+	}
+
+	//Reverse the waypoints so they run from the start to the end
+	m_waypoints.assign(a_waypoints.rbegin(), a_waypoints.rend());
+	m_pathOffset = a_pathOffset;
+	m_pFlowFieldMaze = nullptr;
+	m_pHierarchyMaze = a_pMaze;
+	m_iNextWaypoint = 1;
+
+	//Head to the start of the path, the first segment is refined from there
+	m_path.assign(1, m_waypoints[0]);
+	m_iCurrentIndexInPath = 0;
+	m_currentTargetPostion = glm::vec3(m_waypoints[0].x, 0, m_waypoints[0].y) + m_pathOffset;
+	m_bFollowingPath = true;
+}
+
 /// <summary>
 /// Gets the current postion of the player in the grid
 /// </summary>
@@ -83,8 +149,8 @@ void PathfindingObject::FollowPath(float a_fDeltaTime)
 {
 	//Check if we should be following a path
 	if (m_bFollowingPath) {
-		//Check that we have a valid path (i.e > 0)
-		if (m_path.size() > 0) {
+		//Check that we have a valid path (i.e > 0) or a flow field to follow
+		if (m_path.size() > 0 || m_pFlowFieldMaze != nullptr) {
 
 			//Work out the difference between my target postion and my current position
 			glm::vec3 diff = m_currentTargetPostion - m_currentPostion;
@@ -124,6 +190,27 @@ void PathfindingObject::FollowPath(float a_fDeltaTime)
 /// (i.e we are not at the end of the path)</returns>
 bool PathfindingObject::IncrementNextPathPostion()
 {
+	//Step to the tile the flow field points to from the one we reached
+	if (m_pFlowFieldMaze != nullptr) {
+		const FlowField* pFlowField = m_pFlowFieldMaze->FindFlowField(m_flowFieldGoal);
+		const glm::vec3 mazePosition = m_currentTargetPostion - m_pathOffset;
+		Position nextPostion;
+		if (pFlowField == nullptr || !pFlowField->GetNextTile(Position((int)roundf(mazePosition.x), (int)roundf(mazePosition.z)), nextPostion)) {
+			m_pFlowFieldMaze = nullptr;
+			return false;
+		}
+		m_currentTargetPostion = glm::vec3(nextPostion.x, 0, nextPostion.y) + m_pathOffset;
+		return true;
+	}
+
+	//Once the segment has been walked refine the one to the next waypoint,
+	//its first tile is the one we are on
+	while (m_iCurrentIndexInPath + 1 >= m_path.size() && m_pHierarchyMaze != nullptr) {
+		if (!RefineNextSegment()) {
+			return false;
+		}
+	}
+
 	//Increment the next postion in the path index, retreive the next
 	//position in the path from the list and convert to vector 3
 	if (++m_iCurrentIndexInPath < m_path.size()) {
@@ -137,6 +224,25 @@ bool PathfindingObject::IncrementNextPathPostion()
 }
 
 
+/// <summary>
+/// Refines the hierarchical path from the waypoint we are on to the next one
+/// in to the path
+/// </summary>
+/// <returns>If there was a next waypoint and a path to it could be found</returns>
+bool PathfindingObject::RefineNextSegment()
+{
+	if (m_iNextWaypoint >= m_waypoints.size() ||
+		!m_pHierarchyMaze->RefinePathSegment(m_waypoints[m_iNextWaypoint - 1], m_waypoints[m_iNextWaypoint], m_path)) {
+		m_pHierarchyMaze = nullptr;
+		return false;
+	}
+
+	//Segments come back from the next waypoint to this one
+	std::reverse(m_path.begin(), m_path.end());
+	m_iCurrentIndexInPath = 0;
+	++m_iNextWaypoint;
+	return true;
+}
 
 /// <summary>
 /// Draws a box at the pathfinding objects position, should be used for debug only
@@ -0,0 +1,124 @@
+#include "mapped_file.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/// <summary>
+/// Create a mapping with no file mapped
+/// </summary>
+MappedFile::MappedFile()
+{
+	m_pData = nullptr;
+	m_size = 0;
+}
+
+/// <summary>
+/// Release the view of the file
+/// </summary>
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+/// <summary>
+/// Map a file in to memory for reading
+/// </summary>
+/// <param name="a_filename">Name of file to map</param>
+/// <returns>If the file was mapped</returns>
+bool MappedFile::Open(const char* a_filename)
+{
+	//Release any file we already have mapped
+	Close();
+
+#ifdef _WIN32
+	HANDLE hFile = CreateFileA(a_filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (hFile == INVALID_HANDLE_VALUE) {
+		std::cout << "Unable to open file for mapping" << std::endl;
+		return false;
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(hFile, &fileSize) || fileSize.QuadPart == 0) {
+		std::cout << "File Contains No Data" << std::endl;
+		CloseHandle(hFile);
+		return false;
+	}
+
+	//The view keeps the mapping alive so both handles can be closed
+	//as soon as the view has been created
+	HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	CloseHandle(hFile);
+	if (hMapping == nullptr) {
+		std::cout << "Unable to create file mapping" << std::endl;
+		return false;
+	}
+
+	void* pView = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+	CloseHandle(hMapping);
+	if (pView == nullptr) {
+		std::cout << "Unable to map view of file" << std::endl;
+		return false;
+	}
+
+	m_pData = static_cast<const unsigned char*>(pView);
+	m_size = (size_t)fileSize.QuadPart;
+#else
+	int iFile = open(a_filename, O_RDONLY);
+	if (iFile < 0) {
+		std::cout << "Unable to open file for mapping" << std::endl;
+		return false;
+	}
+
+	struct stat fileInfo;
+	if (fstat(iFile, &fileInfo) != 0 || fileInfo.st_size == 0) {
+		std::cout << "File Contains No Data" << std::endl;
+		close(iFile);
+		return false;
+	}
+
+	//The mapping holds its own reference to the file so the descriptor
+	//can be closed straight away
+	void* pView = mmap(nullptr, (size_t)fileInfo.st_size, PROT_READ, MAP_PRIVATE, iFile, 0);
+	close(iFile);
+	if (pView == MAP_FAILED) {
+		std::cout << "Unable to map view of file" << std::endl;
+		return false;
+	}
+
+	m_pData = static_cast<const unsigned char*>(pView);
+	m_size = (size_t)fileInfo.st_size;
+#endif
+
+	return true;
+}
+
+/// <summary>
+/// Unmap the file if one is mapped
+/// </summary>
+void MappedFile::Close()
+{
+	if (m_pData != nullptr) {
+#ifdef _WIN32
+		UnmapViewOfFile(m_pData);
+#else
+		munmap(const_cast<unsigned char*>(m_pData), m_size);
+#endif
+	}
+
+	m_pData = nullptr;
+	m_size = 0;
+}
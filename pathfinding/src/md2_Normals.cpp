@@ -1,5 +1,6 @@
 
 #include "MD2_Normals.h"
+#include <cmath>
 
 /* Table of precalculated normals */
 const glm::vec3 precalculated_normals[162] = {
@@ -165,4 +166,50 @@ const glm::vec3 precalculated_normals[162] = {
 	glm::vec3(-0.425325f, -0.688191f, -0.587785f) ,
 	glm::vec3(-0.587785f, -0.425325f, -0.688191f) ,
 	glm::vec3(-0.688191f, -0.587785f, -0.425325f)
-};
\ No newline at end of file
+};
+
+/* Table of precalculated normals packed as octahedral values */
+struct OctahedralNormalTable {
+	unsigned int normals[precalculated_normal_length];
+
+	OctahedralNormalTable() {
+		for (int i = 0; i < precalculated_normal_length; ++i) {
+			normals[i] = PackNormalOctahedral(precalculated_normals[i]);
+		}
+	}
+};
+
+/// <summary>
+/// Packs a unit normal by projecting it on to an octahedron and unfolding the
+/// lower half over the upper half, each of the 2 coordinates is stored as a
+/// 16 bit signed value
+/// </summary>
+/// <param name="a_normal">Unit normal to pack</param>
+/// <returns>Packed normal, x in the low 16 bits and y in the high 16 bits</returns>
+unsigned int PackNormalOctahedral(const glm::vec3& a_normal)
+{
+	const float fInvL1 = 1.f / (fabsf(a_normal.x) + fabsf(a_normal.y) + fabsf(a_normal.z));
+	float x = a_normal.x * fInvL1;
+	float y = a_normal.y * fInvL1;
+	if (a_normal.z < 0.f) {
+		const float fFoldedX = (1.f - fabsf(y)) * (x >= 0.f ? 1.f : -1.f);
+		const float fFoldedY = (1.f - fabsf(x)) * (y >= 0.f ? 1.f : -1.f);
+		x = fFoldedX;
+		y = fFoldedY;
+	}
+
+	const short iX = (short)roundf(glm::clamp(x, -1.f, 1.f) * 32767.f);
+	const short iY = (short)roundf(glm::clamp(y, -1.f, 1.f) * 32767.f);
+	return (unsigned int)(unsigned short)iX | ((unsigned int)(unsigned short)iY << 16);
+}
+
+/// <summary>
+/// Gets the precalculated normals packed as octahedral values, the table is
+/// built the first time it is asked for
+/// </summary>
+/// <returns>Packed normal for each normal index</returns>
+const unsigned int* GetPrecalculatedNormalsOctahedral()
+{
+	static const OctahedralNormalTable table;
+	return table.normals;
+}
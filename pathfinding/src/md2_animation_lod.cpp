@@ -0,0 +1,137 @@
+#include "md2_animation_lod.h"
+
+#include <cfloat>
+
+/// <summary>
+/// Create a policy with bands sized for the maze, no agent is culled until a
+/// camera has been set
+/// </summary>
+MD2AnimationLODPolicy::MD2AnimationLODPolicy()
+{
+	m_fBandDistances[MD2_ANIMATION_LOD_FULL] = 15.f;
+	m_fBandDistances[MD2_ANIMATION_LOD_HALF] = 30.f;
+	m_fBandDistances[MD2_ANIMATION_LOD_QUARTER] = 60.f;
+	m_fBandDistances[MD2_ANIMATION_LOD_EIGHTH] = 120.f;
+	m_fBoundingRadius = 1.f;
+	m_bCullOutsideFrustum = false;
+	m_cameraPosition = glm::vec3(0.f);
+	for (int i = 0; i < 6; ++i) {
+		m_frustumPlanes[i] = glm::vec4(0.f);
+	}
+}
+
+/// <summary>
+/// Sets the furthest distance from the camera a level is used to
+/// </summary>
+/// <param name="a_eLOD">Level to set, only the interpolated levels have a band</param>
+/// <param name="a_fMaxDistance">Furthest distance from the camera</param>
+void MD2AnimationLODPolicy::SetBandDistance(MD2_ANIMATION_LOD a_eLOD, float a_fMaxDistance)
+{
+	if (a_eLOD < MD2_ANIMATION_LOD_KEYFRAME) {
+		m_fBandDistances[a_eLOD] = a_fMaxDistance;
+	}
+}
+
+/// <summary>
+/// Gets the furthest distance from the camera a level is used to
+/// </summary>
+/// <param name="a_eLOD">Level to get</param>
+/// <returns>Furthest distance, levels without a band have no limit</returns>
+float MD2AnimationLODPolicy::GetBandDistance(MD2_ANIMATION_LOD a_eLOD) const
+{
+	if (a_eLOD < MD2_ANIMATION_LOD_KEYFRAME) {
+		return m_fBandDistances[a_eLOD];
+	}
+	return FLT_MAX;
+}
+
+/// <summary>
+/// Sets the camera agents are measured from and turns on frustum culling
+/// </summary>
+/// <param name="a_cameraPosition">Position of the camera in the world</param>
+/// <param name="a_viewProjection">Projection matrix multiplied by the view matrix</param>
+void MD2AnimationLODPolicy::SetCamera(const glm::vec3& a_cameraPosition, const glm::mat4& a_viewProjection)
+{
+	m_cameraPosition = a_cameraPosition;
+	m_bCullOutsideFrustum = true;
+
+	//Pull the planes out of the rows of the matrix, glm is column major
+	const glm::vec4 row0(a_viewProjection[0][0], a_viewProjection[1][0], a_viewProjection[2][0], a_viewProjection[3][0]);
+	const glm::vec4 row1(a_viewProjection[0][1], a_viewProjection[1][1], a_viewProjection[2][1], a_viewProjection[3][1]);
+	const glm::vec4 row2(a_viewProjection[0][2], a_viewProjection[1][2], a_viewProjection[2][2], a_viewProjection[3][2]);
+	const glm::vec4 row3(a_viewProjection[0][3], a_viewProjection[1][3], a_viewProjection[2][3], a_viewProjection[3][3]);
+
+	m_frustumPlanes[0] = row3 + row0; //Left
+	m_frustumPlanes[1] = row3 - row0; //Right
+	m_frustumPlanes[2] = row3 + row1; //Bottom
+	m_frustumPlanes[3] = row3 - row1; //Top
+	m_frustumPlanes[4] = row3 + row2; //Near
+	m_frustumPlanes[5] = row3 - row2; //Far
+
+	//Normalise so that the distance to a plane is in world units
+	for (int i = 0; i < 6; ++i) {
+		const float fLength = glm::length(glm::vec3(m_frustumPlanes[i]));
+		if (fLength > 0.f) {
+			m_frustumPlanes[i] /= fLength;
+		}
+	}
+}
+
+/// <summary>
+/// Gets the level of detail to animate an agent at
+/// </summary>
+/// <param name="a_position">Position of the agent in the world</param>
+/// <returns>Level of detail</returns>
+MD2_ANIMATION_LOD MD2AnimationLODPolicy::GetLOD(const glm::vec3& a_position) const
+{
+	if (m_bCullOutsideFrustum && !IsInFrustum(a_position)) {
+		return MD2_ANIMATION_LOD_CLOCK_ONLY;
+	}
+
+	const glm::vec3 toAgent = a_position - m_cameraPosition;
+	const float fDistanceSqr = glm::dot(toAgent, toAgent);
+	for (int i = MD2_ANIMATION_LOD_FULL; i < MD2_ANIMATION_LOD_KEYFRAME; ++i) {
+		if (fDistanceSqr <= m_fBandDistances[i] * m_fBandDistances[i]) {
+			return (MD2_ANIMATION_LOD)i;
+		}
+	}
+
+	return MD2_ANIMATION_LOD_KEYFRAME;
+}
+
+/// <summary>
+/// Gets how many updates go by between an agent's vertices being made
+/// </summary>
+/// <param name="a_eLOD">Level of detail</param>
+/// <returns>Updates between vertices, 0 if they are never made</returns>
+unsigned int MD2AnimationLODPolicy::GetUpdateInterval(MD2_ANIMATION_LOD a_eLOD)
+{
+	switch (a_eLOD) {
+	case MD2_ANIMATION_LOD_HALF:
+		return 2;
+	case MD2_ANIMATION_LOD_QUARTER:
+		return 4;
+	case MD2_ANIMATION_LOD_EIGHTH:
+		return 8;
+	case MD2_ANIMATION_LOD_CLOCK_ONLY:
+		return 0;
+	default:
+		return 1;
+	}
+}
+
+/// <summary>
+/// Checks if the bounding sphere of an agent is at least partly inside the view frustum
+/// </summary>
+/// <param name="a_position">Position of the agent in the world</param>
+/// <returns>If the agent could be seen</returns>
+bool MD2AnimationLODPolicy::IsInFrustum(const glm::vec3& a_position) const
+{
+	for (int i = 0; i < 6; ++i) {
+		const float fDistance = glm::dot(glm::vec3(m_frustumPlanes[i]), a_position) + m_frustumPlanes[i].w;
+		if (fDistance < -m_fBoundingRadius) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,120 @@
+#include "md2_animation_table.h"
+
+#include <cstring>
+
+#include "md2_loader.h"
+
+/// <summary>
+/// Builds the clips of a model from the names of its frames, any clips
+/// already in the table are removed
+/// </summary>
+/// <param name="a_pFrames">Frames of the model</param>
+/// <param name="a_iNumFrames">Number of frames</param>
+void MD2AnimationTable::Build(const MD2Frame* a_pFrames, const unsigned int a_iNumFrames)
+{
+	Clear();
+
+	std::string clipName;
+	std::string baseName;
+	std::string lastBaseName;
+	int iLastFrameNumber = 0;
+
+	for (unsigned int i = 0; i < a_iNumFrames; ++i) {
+		int iFrameNumber = 0;
+		SplitFrameName(a_pFrames[i].name, clipName, baseName, iFrameNumber);
+
+		//Carry on the current clip while the name is the same and the frame
+		//numbers follow on, so stand99 to stand100 stays in one clip but
+		//attak121 to attak201 starts a new one
+		if (!m_clips.empty() && baseName == lastBaseName && iFrameNumber == iLastFrameNumber + 1) {
+			m_clips.back().frames.end = i;
+		}
+		else {
+			MD2AnimationClip clip;
+			memset(clip.name, 0, sizeof(clip.name));
+			memcpy(clip.name, clipName.c_str(), clipName.size());
+			clip.frames.start = i;
+			clip.frames.end = i;
+			m_clips.push_back(clip);
+
+			//Keep the first clip with a name if a model reuses it
+			m_clipLookup.insert(std::make_pair(clipName, (unsigned int)m_clips.size() - 1));
+		}
+
+		lastBaseName = baseName;
+		iLastFrameNumber = iFrameNumber;
+	}
+}
+
+/// <summary>
+/// Removes every clip from the table
+/// </summary>
+void MD2AnimationTable::Clear()
+{
+	m_clips.clear();
+	m_clipLookup.clear();
+}
+
+/// <summary>
+/// Gets a clip by its ID, IDs are in the order the clips appear in the model
+/// </summary>
+/// <param name="a_iClipID">ID of the clip</param>
+/// <returns>Clip, nullptr if there is no clip with the ID</returns>
+const MD2AnimationClip* MD2AnimationTable::GetClip(const unsigned int a_iClipID) const
+{
+	if (a_iClipID >= m_clips.size()) {
+		return nullptr;
+	}
+	return &m_clips[a_iClipID];
+}
+
+/// <summary>
+/// Finds the ID of a clip by name
+/// </summary>
+/// <param name="a_name">Name of the clip, such as "run" or "attak1"</param>
+/// <returns>ID of the clip, INVALID_CLIP if the model has no clip with the name</returns>
+unsigned int MD2AnimationTable::FindClip(const char* a_name) const
+{
+	if (a_name == nullptr) {
+		return INVALID_CLIP;
+	}
+
+	std::unordered_map<std::string, unsigned int>::const_iterator clipIter = m_clipLookup.find(a_name);
+	if (clipIter == m_clipLookup.end()) {
+		return INVALID_CLIP;
+	}
+	return clipIter->second;
+}
+
+/// <summary>
+/// Splits a frame name in to the name of its clip and its frame number. Frame
+/// numbers are the last two digits when there are more, any digits before
+/// them pick between animations with the same name (attak101 is frame 1 of
+/// attak1)
+/// </summary>
+/// <param name="a_frameName">Name of the frame, this may not be null terminated</param>
+/// <param name="a_outClipName">Name of the clip the frame belongs to</param>
+/// <param name="a_outBaseName">Name of the frame without any digits on the end</param>
+/// <param name="a_iOutFrameNumber">Every digit on the end of the name as a number, 0 if there are none</param>
+void MD2AnimationTable::SplitFrameName(const char* a_frameName, std::string& a_outClipName, std::string& a_outBaseName, int& a_iOutFrameNumber)
+{
+	unsigned int iLength = 0;
+	while (iLength < MD2_FRAME_NAME_LENGTH && a_frameName[iLength] != '\0') {
+		++iLength;
+	}
+
+	//Only as many digits as fit in an int are taken as the frame number
+	unsigned int iNumDigits = 0;
+	while (iNumDigits < iLength && iNumDigits < 9 && a_frameName[iLength - iNumDigits - 1] >= '0' && a_frameName[iLength - iNumDigits - 1] <= '9') {
+		++iNumDigits;
+	}
+
+	const unsigned int iBaseLength = iLength - iNumDigits;
+	a_outBaseName.assign(a_frameName, iBaseLength);
+	a_outClipName.assign(a_frameName, (iNumDigits > 2) ? iLength - 2 : iBaseLength);
+
+	a_iOutFrameNumber = 0;
+	for (unsigned int i = iBaseLength; i < iLength; ++i) {
+		a_iOutFrameNumber = (a_iOutFrameNumber * 10) + (a_frameName[i] - '0');
+	}
+}
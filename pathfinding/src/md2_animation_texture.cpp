@@ -0,0 +1,127 @@
+#include "md2_animation_texture.h"
+
+#include "md2_Normals.h"
+
+#include <cstring>
+
+/// <summary>
+/// Bakes every keyframe of a model, anything already baked is removed
+/// </summary>
+/// <param name="a_model">Model to bake</param>
+/// <returns>If the model was baked</returns>
+bool MD2AnimationTexture::Bake(const MD2Model& a_model)
+{
+	Clear();
+
+	const unsigned int iWidth = a_model.GetNumUniqueVerts();
+	const unsigned int iHeight = a_model.GetNumFrames();
+	if (iWidth == 0 || iHeight == 0) {
+		return false;
+	}
+
+	//The keyframes come out of the model with their normal index in the low
+	//byte of the normal, they only need splitting in to the two textures
+	std::vector<MD2PackedVertex> keyframeData(iWidth * iHeight);
+	if (!a_model.GetKeyframeData(keyframeData.data(), (unsigned int)keyframeData.size(), MD2_NORMAL_FORMAT_INDEX)) {
+		return false;
+	}
+
+	m_positions.resize(keyframeData.size() * 3);
+	m_normalIndices.resize(keyframeData.size());
+	for (size_t i = 0; i < keyframeData.size(); ++i) {
+		m_positions[(i * 3) + 0] = keyframeData[i].position.x;
+		m_positions[(i * 3) + 1] = keyframeData[i].position.y;
+		m_positions[(i * 3) + 2] = keyframeData[i].position.z;
+		m_normalIndices[i] = (unsigned char)(keyframeData[i].normal & 0xFF);
+	}
+
+	m_iWidth = iWidth;
+	m_iHeight = iHeight;
+	return true;
+}
+
+/// <summary>
+/// Removes the baked textures
+/// </summary>
+void MD2AnimationTexture::Clear()
+{
+	m_iWidth = 0;
+	m_iHeight = 0;
+	m_positions.clear();
+	m_normalIndices.clear();
+}
+
+/// <summary>
+/// Interpolates between two rows of the textures the same way the CPU path,
+/// MD2Model::GetInterpolatedData, does. Normals are lerped and left
+/// unnormalised like the CPU path, unlike the vertex shader which renormalises
+/// them. Only the position and normal of each vertex are written. Frames past
+/// the last frame wrap round like MD2Model::GetFrame
+/// </summary>
+/// <param name="a_iCurrentFrame">Current Frame of the animation</param>
+/// <param name="a_iNextFrame">Next Frame of the animation</param>
+/// <param name="a_fInterpAmount">Amount to interpolate between frames</param>
+/// <param name="a_pOutVertices">Buffer to write the interpolated vertices to</param>
+/// <param name="a_iNumOutVertices">Number of vertices the buffer can hold, must be at least GetWidth()</param>
+/// <returns>If the buffer was filled</returns>
+bool MD2AnimationTexture::Sample(const unsigned int a_iCurrentFrame, const unsigned int a_iNextFrame, const float a_fInterpAmount, MD2DynamicVertex* a_pOutVertices, const unsigned int a_iNumOutVertices) const
+{
+	if (!IsBaked() || a_pOutVertices == nullptr || a_iNumOutVertices < m_iWidth) {
+		return false;
+	}
+
+	const size_t iCurrentRow = (size_t)(a_iCurrentFrame % m_iHeight) * m_iWidth;
+	const size_t iNextRow = (size_t)(a_iNextFrame % m_iHeight) * m_iWidth;
+	const float* pCurrentPositions = &m_positions[iCurrentRow * 3];
+	const float* pNextPositions = &m_positions[iNextRow * 3];
+	const unsigned char* pCurrentNormals = &m_normalIndices[iCurrentRow];
+	const unsigned char* pNextNormals = &m_normalIndices[iNextRow];
+
+	for (unsigned int i = 0; i < m_iWidth; ++i) {
+		const float* pCurrentPosition = pCurrentPositions + (i * 3);
+		const float* pNextPosition = pNextPositions + (i * 3);
+		a_pOutVertices[i].position.x = pCurrentPosition[0] + (a_fInterpAmount * (pNextPosition[0] - pCurrentPosition[0]));
+		a_pOutVertices[i].position.y = pCurrentPosition[1] + (a_fInterpAmount * (pNextPosition[1] - pCurrentPosition[1]));
+		a_pOutVertices[i].position.z = pCurrentPosition[2] + (a_fInterpAmount * (pNextPosition[2] - pCurrentPosition[2]));
+
+		const glm::vec3& currentNormal = precalculated_normals[pCurrentNormals[i]];
+		const glm::vec3& nextNormal = precalculated_normals[pNextNormals[i]];
+		a_pOutVertices[i].normal.x = currentNormal.x + (a_fInterpAmount * (nextNormal.x - currentNormal.x));
+		a_pOutVertices[i].normal.y = currentNormal.y + (a_fInterpAmount * (nextNormal.y - currentNormal.y));
+		a_pOutVertices[i].normal.z = currentNormal.z + (a_fInterpAmount * (nextNormal.z - currentNormal.z));
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Checks the baked textures against the model by sampling every frame and
+/// the one after it, including the last frame wrapping round to the first,
+/// and comparing the vertices bit for bit with MD2Model::GetInterpolatedData
+/// </summary>
+/// <param name="a_model">Model the textures were baked from</param>
+/// <param name="a_pInterpAmounts">Amounts to interpolate between each pair of frames</param>
+/// <param name="a_iNumInterpAmounts">Number of interpolation amounts</param>
+/// <returns>Number of samples that differ from the model, or every sample if the textures don't fit the model</returns>
+unsigned int MD2AnimationTexture::CountMismatches(const MD2Model& a_model, const float* a_pInterpAmounts, const unsigned int a_iNumInterpAmounts) const
+{
+	const unsigned int iNumSamples = m_iHeight * a_iNumInterpAmounts;
+	if (!IsBaked() || a_model.GetNumUniqueVerts() != m_iWidth || a_model.GetNumFrames() != m_iHeight) {
+		return iNumSamples;
+	}
+
+	std::vector<MD2DynamicVertex> sampled(m_iWidth);
+	std::vector<MD2DynamicVertex> interpolated(m_iWidth);
+	unsigned int iNumMismatches = 0;
+	for (unsigned int iFrame = 0; iFrame < m_iHeight; ++iFrame) {
+		for (unsigned int i = 0; i < a_iNumInterpAmounts; ++i) {
+			const bool bSampled = Sample(iFrame, iFrame + 1, a_pInterpAmounts[i], sampled.data(), m_iWidth);
+			const bool bInterpolated = a_model.GetInterpolatedData(iFrame, iFrame + 1, a_pInterpAmounts[i], interpolated.data(), m_iWidth);
+			if (!bSampled || !bInterpolated || memcmp(sampled.data(), interpolated.data(), sizeof(MD2DynamicVertex) * m_iWidth) != 0) {
+				++iNumMismatches;
+			}
+		}
+	}
+
+	return iNumMismatches;
+}
@@ -0,0 +1,575 @@
+#include "md2_crowd.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "JobSystem.h"
+
+//Key of an agent that has no pose
+#define MD2_CROWD_NO_POSE_KEY 0xFFFFFFFFFFFFFFFFull
+
+const unsigned int MD2Crowd::NO_POSE;
+
+/// <summary>
+/// Create a crowd with no agents
+/// </summary>
+/// <param name="a_pModel">Model every agent uses</param>
+/// <param name="a_eVertexLayout">Layout of the vertices the crowd is interpolated in to</param>
+/// <param name="a_eNormalFormat">How normals are stored when using the split layout</param>
+MD2Crowd::MD2Crowd(const MD2Model* a_pModel, MD2_VERTEX_LAYOUT a_eVertexLayout, MD2_NORMAL_FORMAT a_eNormalFormat)
+{
+	m_pModel = a_pModel;
+	m_iNumVertsPerAgent = (a_pModel != nullptr) ? a_pModel->GetNumUniqueVerts() : 0;
+	m_eVertexLayout = a_eVertexLayout;
+	m_eNormalFormat = a_eNormalFormat;
+	m_pKeyframeCaches = nullptr;
+	m_iNumKeyframeCaches = 0;
+	m_iInterpolationTick = 0;
+	m_iInterpolationSteps = 0;
+	m_iNumPosesRequested = 0;
+	m_iNumPosesInterpolated = 0;
+}
+
+/// <summary>
+/// Destructor, the model is not owned by the crowd
+/// </summary>
+MD2Crowd::~MD2Crowd()
+{
+	delete[] m_pKeyframeCaches;
+}
+
+/// <summary>
+/// Adds an agent to the crowd at the start of an animation
+/// </summary>
+/// <param name="a_animation">Animation to play</param>
+/// <param name="a_fAnimationSpeed">Frames per second to play the animation at</param>
+/// <returns>Index of the agent</returns>
+unsigned int MD2Crowd::AddAgent(const MD2Animation& a_animation, float a_fAnimationSpeed)
+{
+	const unsigned int iAgent = GetNumAgents();
+
+	m_currentFrames.push_back(0);
+	m_nextFrames.push_back(0);
+	m_interpolations.push_back(0.f);
+	m_animationSpeeds.push_back(a_fAnimationSpeed);
+	m_startFrames.push_back(0);
+	m_endFrames.push_back(0);
+	m_agentLODs.push_back(MD2_ANIMATION_LOD_FULL);
+	m_agentPoseKeys.push_back(MD2_CROWD_NO_POSE_KEY);
+	m_agentPoses.push_back(NO_POSE);
+	SetAnimation(iAgent, a_animation);
+
+	//Every agent brings one more pose slot with it
+	const unsigned int iPose = (unsigned int)m_poseKeys.size();
+	m_poseKeys.push_back(MD2_CROWD_NO_POSE_KEY);
+	m_poseCurrentFrames.push_back(0);
+	m_poseNextFrames.push_back(0);
+	m_poseInterpolations.push_back(0.f);
+	m_poseInUse.push_back(0);
+	m_freePoses.push_back(iPose);
+
+	//Grow the output buffer to hold the new pose, the interleaved layout holds
+	//colours and UVs that do not change so they are filled in here
+	const size_t iNumVerts = (size_t)m_iNumVertsPerAgent * m_poseKeys.size();
+	if (m_eVertexLayout == MD2_VERTEX_LAYOUT_SPLIT && m_eNormalFormat != MD2_NORMAL_FORMAT_FLOAT) {
+		m_packedVertexData.resize(iNumVerts);
+	}
+	else if (m_eVertexLayout == MD2_VERTEX_LAYOUT_SPLIT) {
+		m_dynamicVertexData.resize(iNumVerts);
+	}
+	else {
+		m_vertexData.resize(iNumVerts);
+		if (m_pModel != nullptr) {
+			m_pModel->InitialiseVertexBuffer(&m_vertexData[(size_t)m_iNumVertsPerAgent * iPose], m_iNumVertsPerAgent);
+		}
+	}
+
+	return iAgent;
+}
+
+/// <summary>
+/// Changes the animation an agent is playing, the agent starts from the
+/// first frame of the animation
+/// </summary>
+/// <param name="a_iAgent">Agent to change</param>
+/// <param name="a_animation">Animation to play</param>
+void MD2Crowd::SetAnimation(unsigned int a_iAgent, const MD2Animation& a_animation)
+{
+	//An animation that runs backwards only plays its first frame
+	const unsigned int iEndFrame = (a_animation.end > a_animation.start) ? a_animation.end : a_animation.start;
+
+	m_startFrames[a_iAgent] = a_animation.start;
+	m_endFrames[a_iAgent] = iEndFrame;
+	m_currentFrames[a_iAgent] = a_animation.start;
+	m_nextFrames[a_iAgent] = (a_animation.start < iEndFrame) ? a_animation.start + 1 : a_animation.start;
+	m_interpolations[a_iAgent] = 0.f;
+
+	//Show the new animation on the next update whatever the level of detail
+	m_agentPoseKeys[a_iAgent] = MD2_CROWD_NO_POSE_KEY;
+}
+
+/// <summary>
+/// Moves an agent to a frame of the animation it is playing, used to stop
+/// agents playing the same animation in step
+/// </summary>
+/// <param name="a_iAgent">Agent to change</param>
+/// <param name="a_iFrame">Frame to move to, this is clamped to the animation</param>
+/// <param name="a_fInterpolation">Amount between this frame and the next</param>
+void MD2Crowd::SetFrame(unsigned int a_iAgent, unsigned int a_iFrame, float a_fInterpolation)
+{
+	const unsigned int iStartFrame = m_startFrames[a_iAgent];
+	const unsigned int iEndFrame = m_endFrames[a_iAgent];
+	const unsigned int iFrame = (a_iFrame < iStartFrame) ? iStartFrame : (a_iFrame > iEndFrame) ? iEndFrame : a_iFrame;
+
+	m_currentFrames[a_iAgent] = iFrame;
+	m_nextFrames[a_iAgent] = (iFrame < iEndFrame) ? iFrame + 1 : iStartFrame;
+	m_interpolations[a_iAgent] = (a_fInterpolation >= 0.f && a_fInterpolation < 1.f) ? a_fInterpolation : 0.f;
+	m_agentPoseKeys[a_iAgent] = MD2_CROWD_NO_POSE_KEY;
+}
+
+/// <summary>
+/// Sets the number of steps interpolation is rounded to when finding agents in
+/// the same pose. Changing it drops every pose so they are all made again
+/// </summary>
+/// <param name="a_iInterpolationSteps">Number of steps, 0 only shares poses between agents exactly in step</param>
+void MD2Crowd::SetInterpolationSteps(unsigned int a_iInterpolationSteps)
+{
+	if (a_iInterpolationSteps != m_iInterpolationSteps) {
+		m_iInterpolationSteps = a_iInterpolationSteps;
+		ReleasePoses();
+	}
+}
+
+/// <summary>
+/// Sets the level of detail of every agent from where it is
+/// </summary>
+/// <param name="a_policy">Policy to pick levels with, the camera must already be set</param>
+/// <param name="a_pPositions">Position of each agent in the world, indexed by agent</param>
+void MD2Crowd::UpdateLODs(const MD2AnimationLODPolicy& a_policy, const glm::vec3* a_pPositions)
+{
+	const unsigned int iNumAgents = GetNumAgents();
+	for (unsigned int i = 0; i < iNumAgents; ++i) {
+		m_agentLODs[i] = a_policy.GetLOD(a_pPositions[i]);
+	}
+}
+
+/// <summary>
+/// Removes every agent from the crowd
+/// </summary>
+void MD2Crowd::Clear()
+{
+	m_currentFrames.clear();
+	m_nextFrames.clear();
+	m_interpolations.clear();
+	m_animationSpeeds.clear();
+	m_startFrames.clear();
+	m_endFrames.clear();
+	m_agentLODs.clear();
+	m_agentPoseKeys.clear();
+	m_agentPoses.clear();
+	m_poseLookup.clear();
+	m_poseKeys.clear();
+	m_poseCurrentFrames.clear();
+	m_poseNextFrames.clear();
+	m_poseInterpolations.clear();
+	m_poseInUse.clear();
+	m_freePoses.clear();
+	m_posesToInterpolate.clear();
+	m_vertexData.clear();
+	m_dynamicVertexData.clear();
+	m_packedVertexData.clear();
+}
+
+/// <summary>
+/// Advances the animation of every agent, this is done at full rate whatever
+/// the agents level of detail so they keep time
+/// </summary>
+/// <param name="a_fDeltaTime">Time since the last update</param>
+/// <param name="a_pJobSystem">Job system to split the agents across, nullptr updates them all on this thread</param>
+void MD2Crowd::Update(float a_fDeltaTime, JobSystem* a_pJobSystem)
+{
+	if (a_pJobSystem == nullptr) {
+		UpdateAgents(0, GetNumAgents(), a_fDeltaTime);
+		return;
+	}
+
+	a_pJobSystem->parallelFor(GetNumAgents(), mc_iUpdateChunkSize,
+		[this, a_fDeltaTime](unsigned int a_iBegin, unsigned int a_iEnd, unsigned int) {
+			UpdateAgents(a_iBegin, a_iEnd, a_fDeltaTime);
+		});
+}
+
+/// <summary>
+/// Makes the vertices of every agent that is due them at its level of detail,
+/// each distinct pose is only interpolated once and is kept while it is used
+/// </summary>
+/// <param name="a_pJobSystem">Job system to split the poses across, nullptr interpolates them all on this thread</param>
+void MD2Crowd::Interpolate(JobSystem* a_pJobSystem)
+{
+	if (m_pModel == nullptr || m_iNumVertsPerAgent == 0) {
+		return;
+	}
+
+	BuildPoses();
+
+	const unsigned int iNumPoses = (unsigned int)m_posesToInterpolate.size();
+	if (a_pJobSystem == nullptr) {
+		CreateKeyframeCaches(1);
+		InterpolatePoses(0, iNumPoses, &m_pKeyframeCaches[0]);
+		return;
+	}
+
+	//Poses are in frame order so each thread's cache sees few frames
+	CreateKeyframeCaches(a_pJobSystem->getThreadCount());
+	a_pJobSystem->parallelFor(iNumPoses, mc_iInterpolateChunkSize,
+		[this](unsigned int a_iBegin, unsigned int a_iEnd, unsigned int a_iThreadIndex) {
+			InterpolatePoses(a_iBegin, a_iEnd, &m_pKeyframeCaches[a_iThreadIndex]);
+		});
+}
+
+/// <summary>
+/// Advances the animation of a range of agents, this is the same stepping
+/// as MD2Pathfinder::Animate
+/// </summary>
+/// <param name="a_iBegin">First agent to update</param>
+/// <param name="a_iEnd">One past the last agent to update</param>
+/// <param name="a_fDeltaTime">Time since the last update</param>
+void MD2Crowd::UpdateAgents(unsigned int a_iBegin, unsigned int a_iEnd, float a_fDeltaTime)
+{
+	unsigned int* pCurrentFrames = m_currentFrames.data();
+	unsigned int* pNextFrames = m_nextFrames.data();
+	float* pInterpolations = m_interpolations.data();
+	const float* pAnimationSpeeds = m_animationSpeeds.data();
+	const unsigned int* pStartFrames = m_startFrames.data();
+	const unsigned int* pEndFrames = m_endFrames.data();
+
+	for (unsigned int i = a_iBegin; i < a_iEnd; ++i) {
+
+		//Increase Interpolation
+		pInterpolations[i] += pAnimationSpeeds[i] * a_fDeltaTime;
+
+		//If interpolation is over 1, then change the frame and loop back to
+		//the start of the animation after the last frame
+		if (pInterpolations[i] >= 1.f) {
+			unsigned int iFrame = pCurrentFrames[i] + 1;
+			if (iFrame > pEndFrames[i]) {
+				iFrame = pStartFrames[i];
+			}
+
+			pCurrentFrames[i] = iFrame;
+			pNextFrames[i] = (iFrame < pEndFrames[i]) ? iFrame + 1 : pStartFrames[i];
+			pInterpolations[i] = 0.f;
+		}
+	}
+}
+
+/// <summary>
+/// Interpolates the vertices of a range of the poses made this update
+/// </summary>
+/// <param name="a_iBegin">First pose to interpolate</param>
+/// <param name="a_iEnd">One past the last pose to interpolate</param>
+/// <param name="a_pKeyframeCache">Cache only used by the calling thread</param>
+void MD2Crowd::InterpolatePoses(unsigned int a_iBegin, unsigned int a_iEnd, MD2KeyframeCache* a_pKeyframeCache)
+{
+	for (unsigned int i = a_iBegin; i < a_iEnd; ++i) {
+
+		const unsigned int iPose = m_posesToInterpolate[i];
+		const size_t iOffset = (size_t)m_iNumVertsPerAgent * iPose;
+
+		if (m_eVertexLayout == MD2_VERTEX_LAYOUT_SPLIT && m_eNormalFormat != MD2_NORMAL_FORMAT_FLOAT) {
+			m_pModel->GetInterpolatedData(m_poseCurrentFrames[iPose], m_poseNextFrames[iPose], m_poseInterpolations[iPose],
+				&m_packedVertexData[iOffset], m_iNumVertsPerAgent, m_eNormalFormat, a_pKeyframeCache);
+		}
+		else if (m_eVertexLayout == MD2_VERTEX_LAYOUT_SPLIT) {
+			m_pModel->GetInterpolatedData(m_poseCurrentFrames[iPose], m_poseNextFrames[iPose], m_poseInterpolations[iPose],
+				&m_dynamicVertexData[iOffset], m_iNumVertsPerAgent, a_pKeyframeCache);
+		}
+		else {
+			m_pModel->GetInterpolatedData(m_poseCurrentFrames[iPose], m_poseNextFrames[iPose], m_poseInterpolations[iPose],
+				&m_vertexData[iOffset], m_iNumVertsPerAgent, a_pKeyframeCache);
+		}
+	}
+}
+
+/// <summary>
+/// Makes sure there is a keyframe cache for every thread, the caches are
+/// kept between calls so frames decoded last update are still there
+/// </summary>
+/// <param name="a_iNumThreads">Number of threads that will interpolate the crowd</param>
+void MD2Crowd::CreateKeyframeCaches(unsigned int a_iNumThreads)
+{
+	if (m_iNumKeyframeCaches >= a_iNumThreads) {
+		return;
+	}
+
+	delete[] m_pKeyframeCaches;
+	m_pKeyframeCaches = new MD2KeyframeCache[a_iNumThreads];
+	m_iNumKeyframeCaches = a_iNumThreads;
+
+	//A cache that can't be created is left empty and the model decodes
+	//straight from its frames instead
+	for (unsigned int i = 0; i < a_iNumThreads; ++i) {
+		m_pModel->CreateKeyframeCache(m_pKeyframeCaches[i], mc_iKeyframeCacheBudget);
+	}
+}
+
+/// <summary>
+/// Gets the interpolated vertices of a pose when using the interleaved layout
+/// </summary>
+/// <param name="a_iPose">Pose to get</param>
+/// <returns>First vertex of the pose, nullptr if the layout is not interleaved or there is no pose</returns>
+const MD2Vertex* MD2Crowd::GetPoseVertsData(unsigned int a_iPose) const
+{
+	if (m_vertexData.empty() || a_iPose == NO_POSE) {
+		return nullptr;
+	}
+	return &m_vertexData[(size_t)m_iNumVertsPerAgent * a_iPose];
+}
+
+/// <summary>
+/// Gets the interpolated vertices of a pose when using the split layout
+/// with float normals
+/// </summary>
+/// <param name="a_iPose">Pose to get</param>
+/// <returns>First vertex of the pose, nullptr if a different layout is used or there is no pose</returns>
+const MD2DynamicVertex* MD2Crowd::GetPoseDynamicVertsData(unsigned int a_iPose) const
+{
+	if (m_dynamicVertexData.empty() || a_iPose == NO_POSE) {
+		return nullptr;
+	}
+	return &m_dynamicVertexData[(size_t)m_iNumVertsPerAgent * a_iPose];
+}
+
+/// <summary>
+/// Gets the interpolated vertices of a pose when using the split layout
+/// with packed normals
+/// </summary>
+/// <param name="a_iPose">Pose to get</param>
+/// <returns>First vertex of the pose, nullptr if a different layout is used or there is no pose</returns>
+const MD2PackedVertex* MD2Crowd::GetPosePackedVertsData(unsigned int a_iPose) const
+{
+	if (m_packedVertexData.empty() || a_iPose == NO_POSE) {
+		return nullptr;
+	}
+	return &m_packedVertexData[(size_t)m_iNumVertsPerAgent * a_iPose];
+}
+
+/// <summary>
+/// Gets how many keyframes the crowd found already decoded, over every thread
+/// </summary>
+/// <returns>Number of keyframe cache hits</returns>
+unsigned long long MD2Crowd::GetNumKeyframeCacheHits() const
+{
+	unsigned long long iNumHits = 0;
+	for (unsigned int i = 0; i < m_iNumKeyframeCaches; ++i) {
+		iNumHits += m_pKeyframeCaches[i].GetNumHits();
+	}
+	return iNumHits;
+}
+
+/// <summary>
+/// Gets how many keyframes the crowd had to decode, over every thread
+/// </summary>
+/// <returns>Number of keyframe cache misses</returns>
+unsigned long long MD2Crowd::GetNumKeyframeCacheMisses() const
+{
+	unsigned long long iNumMisses = 0;
+	for (unsigned int i = 0; i < m_iNumKeyframeCaches; ++i) {
+		iNumMisses += m_pKeyframeCaches[i].GetNumMisses();
+	}
+	return iNumMisses;
+}
+
+/// <summary>
+/// Gets the fraction of agents that used a pose interpolated for another agent
+/// rather than having one interpolated for them
+/// </summary>
+/// <returns>Rate between 0 and 1</returns>
+float MD2Crowd::GetPoseSharingRate() const
+{
+	if (m_iNumPosesRequested == 0) {
+		return 0.f;
+	}
+	return 1.f - (float)((double)m_iNumPosesInterpolated / (double)m_iNumPosesRequested);
+}
+
+/// <summary>
+/// Sets the pose sharing counters back to zero
+/// </summary>
+void MD2Crowd::ResetPoseCounters()
+{
+	m_iNumPosesRequested = 0;
+	m_iNumPosesInterpolated = 0;
+}
+
+/// <summary>
+/// Works out the pose each agent shows this update. Agents keep their pose
+/// until they are due to be updated at their level of detail, poses no agent
+/// uses are freed and new poses are given a free slot to be interpolated in to
+/// </summary>
+void MD2Crowd::BuildPoses()
+{
+	++m_iInterpolationTick;
+
+	//Pick the pose every agent that is due should show
+	const unsigned int iNumAgents = GetNumAgents();
+	for (unsigned int i = 0; i < iNumAgents; ++i) {
+		if (m_agentLODs[i] == MD2_ANIMATION_LOD_CLOCK_ONLY) {
+			m_agentPoseKeys[i] = MD2_CROWD_NO_POSE_KEY;
+		}
+		else if (IsAgentDue(i)) {
+			m_agentPoseKeys[i] = GetPoseKey(i);
+		}
+	}
+
+	//Find the poses that already exist
+	std::fill(m_poseInUse.begin(), m_poseInUse.end(), 0);
+	for (unsigned int i = 0; i < iNumAgents; ++i) {
+		m_agentPoses[i] = NO_POSE;
+		if (m_agentPoseKeys[i] != MD2_CROWD_NO_POSE_KEY) {
+			std::unordered_map<unsigned long long, unsigned int>::const_iterator poseIter = m_poseLookup.find(m_agentPoseKeys[i]);
+			if (poseIter != m_poseLookup.end()) {
+				m_agentPoses[i] = poseIter->second;
+				m_poseInUse[poseIter->second] = 1;
+			}
+		}
+	}
+
+	//Free the poses no agent shows any more
+	const unsigned int iNumSlots = (unsigned int)m_poseKeys.size();
+	for (unsigned int iPose = 0; iPose < iNumSlots; ++iPose) {
+		if (m_poseKeys[iPose] != MD2_CROWD_NO_POSE_KEY && !m_poseInUse[iPose]) {
+			m_poseLookup.erase(m_poseKeys[iPose]);
+			m_poseKeys[iPose] = MD2_CROWD_NO_POSE_KEY;
+			m_freePoses.push_back(iPose);
+		}
+	}
+
+	//Make the new poses, agents that want the same new pose share it
+	unsigned int iNumRequested = 0;
+	m_posesToInterpolate.clear();
+	for (unsigned int i = 0; i < iNumAgents; ++i) {
+		const unsigned long long iKey = m_agentPoseKeys[i];
+		if (iKey == MD2_CROWD_NO_POSE_KEY) {
+			continue;
+		}
+
+		++iNumRequested;
+		if (m_agentPoses[i] != NO_POSE) {
+			continue;
+		}
+
+		std::unordered_map<unsigned long long, unsigned int>::const_iterator poseIter = m_poseLookup.find(iKey);
+		if (poseIter != m_poseLookup.end()) {
+			m_agentPoses[i] = poseIter->second;
+			continue;
+		}
+
+		//There is always a free slot as there are as many slots as agents
+		const unsigned int iPose = m_freePoses.back();
+		m_freePoses.pop_back();
+
+		const unsigned int iInterpolationKey = (unsigned int)(iKey & 0xFFFFFFFF);
+		float fInterpolation = 0.f;
+		if (m_iInterpolationSteps > 0) {
+			fInterpolation = (float)iInterpolationKey / (float)m_iInterpolationSteps;
+		}
+		else {
+			memcpy(&fInterpolation, &iInterpolationKey, sizeof(fInterpolation));
+		}
+
+		m_poseKeys[iPose] = iKey;
+		m_poseCurrentFrames[iPose] = (unsigned int)(iKey >> 48);
+		m_poseNextFrames[iPose] = (unsigned int)((iKey >> 32) & 0xFFFF);
+		m_poseInterpolations[iPose] = fInterpolation;
+		m_poseLookup[iKey] = iPose;
+		m_posesToInterpolate.push_back(iPose);
+		m_agentPoses[i] = iPose;
+	}
+
+	//Interpolate poses on the same frames one after another
+	std::sort(m_posesToInterpolate.begin(), m_posesToInterpolate.end(),
+		[this](unsigned int a_iPoseA, unsigned int a_iPoseB) {
+			return m_poseKeys[a_iPoseA] < m_poseKeys[a_iPoseB];
+		});
+
+	m_iNumPosesRequested += iNumRequested;
+	m_iNumPosesInterpolated += m_posesToInterpolate.size();
+}
+
+/// <summary>
+/// Drops every pose, each agent is given a pose again on the next update
+/// </summary>
+void MD2Crowd::ReleasePoses()
+{
+	m_poseLookup.clear();
+	m_freePoses.clear();
+	m_posesToInterpolate.clear();
+
+	//Slots are handed out from the back of the free list, lowest first
+	const unsigned int iNumSlots = (unsigned int)m_poseKeys.size();
+	for (unsigned int i = 0; i < iNumSlots; ++i) {
+		m_poseKeys[i] = MD2_CROWD_NO_POSE_KEY;
+		m_freePoses.push_back(iNumSlots - 1 - i);
+	}
+
+	std::fill(m_agentPoseKeys.begin(), m_agentPoseKeys.end(), MD2_CROWD_NO_POSE_KEY);
+	std::fill(m_agentPoses.begin(), m_agentPoses.end(), NO_POSE);
+}
+
+/// <summary>
+/// Checks if an agent should have its pose updated this update. Agents at a
+/// reduced rate are offset by their index so their updates are spread out
+/// </summary>
+/// <param name="a_iAgent">Agent to check</param>
+/// <returns>If the agent is due a new pose</returns>
+bool MD2Crowd::IsAgentDue(unsigned int a_iAgent) const
+{
+	//Agents without a pose need one straight away
+	if (m_agentPoseKeys[a_iAgent] == MD2_CROWD_NO_POSE_KEY) {
+		return true;
+	}
+
+	const unsigned int iInterval = MD2AnimationLODPolicy::GetUpdateInterval(m_agentLODs[a_iAgent]);
+	if (iInterval == 0) {
+		return false;
+	}
+	return ((m_iInterpolationTick + a_iAgent) % iInterval) == 0;
+}
+
+/// <summary>
+/// Gets the key of the pose an agent is in now, the current frame, next
+/// frame and interpolation key packed in to 64 bits
+/// </summary>
+/// <param name="a_iAgent">Agent to get the pose of</param>
+/// <returns>Pose key</returns>
+unsigned long long MD2Crowd::GetPoseKey(unsigned int a_iAgent) const
+{
+	//Agents snapped to keyframes all show the current frame on its own
+	unsigned long long iCurrentFrame = m_currentFrames[a_iAgent] & 0xFFFF;
+	unsigned long long iNextFrame = m_nextFrames[a_iAgent] & 0xFFFF;
+	unsigned long long iInterpolationKey = GetInterpolationKey(m_interpolations[a_iAgent]);
+	if (m_agentLODs[a_iAgent] == MD2_ANIMATION_LOD_KEYFRAME) {
+		iNextFrame = iCurrentFrame;
+		iInterpolationKey = GetInterpolationKey(0.f);
+	}
+
+	return (iCurrentFrame << 48) | (iNextFrame << 32) | iInterpolationKey;
+}
+
+/// <summary>
+/// Gets the value agents are compared by to see if their interpolation puts
+/// them in the same pose
+/// </summary>
+/// <param name="a_fInterpolation">Interpolation of an agent</param>
+/// <returns>Nearest step when quantising, otherwise the bits of the interpolation</returns>
+unsigned int MD2Crowd::GetInterpolationKey(float a_fInterpolation) const
+{
+	if (m_iInterpolationSteps > 0) {
+		return (unsigned int)((a_fInterpolation * m_iInterpolationSteps) + 0.5f);
+	}
+
+	unsigned int iKey = 0;
+	memcpy(&iKey, &a_fInterpolation, sizeof(iKey));
+	return iKey;
+}
@@ -0,0 +1,376 @@
+#include "md2_interpolator.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define MD2_INTERPOLATOR_X86
+#include <emmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+//MSVC allows AVX2 intrinsics in any function
+#define MD2_TARGET_AVX2
+#else
+#include <cpuid.h>
+//GCC and Clang need to be told a function may use AVX2. FMA is deliberately not
+//enabled so multiply and add are never fused and results match the scalar path
+#define MD2_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+//Number of streams in a keyframe (position xyz and normal xyz)
+#define MD2_KEYFRAME_STREAMS 6
+
+MD2Interpolator::MD2_ISA MD2Interpolator::m_eActiveISA = MD2Interpolator::GetSupportedISA();
+
+/// <summary>
+/// Writes the interpolated positions and normals of a block of vertices from
+/// a stream ordered temporary buffer in to the output
+/// </summary>
+/// <param name="a_values">Interpolated px, py, pz, nx, ny, nz for each vertex in the block</param>
+/// <param name="a_out">Stream to write to</param>
+/// <param name="a_iFirstVertex">Index of the first vertex in the block</param>
+template <unsigned int BLOCK_SIZE>
+static inline void StoreBlock(const float (&a_values)[MD2_KEYFRAME_STREAMS][BLOCK_SIZE], const MD2VertexStream& a_out, const unsigned int a_iFirstVertex)
+{
+	for (unsigned int i = 0; i < BLOCK_SIZE; ++i) {
+		float* pPosition = a_out.position + ((size_t)(a_iFirstVertex + i) * a_out.stride);
+		pPosition[0] = a_values[0][i];
+		pPosition[1] = a_values[1][i];
+		pPosition[2] = a_values[2][i];
+		if (a_out.normal != nullptr) {
+			float* pNormal = a_out.normal + ((size_t)(a_iFirstVertex + i) * a_out.stride);
+			pNormal[0] = a_values[3][i];
+			pNormal[1] = a_values[4][i];
+			pNormal[2] = a_values[5][i];
+		}
+	}
+}
+
+/// <summary>
+/// Scalar interpolation of vertices, this is the refrence every other
+/// instruction set has to match
+/// </summary>
+static void InterpolateScalar(const MD2KeyframeSoA& a_currentFrame, const MD2KeyframeSoA& a_nextFrame, const float a_fInterpAmount,
+	const MD2VertexStream& a_out, const unsigned int a_iFirstVertex, const unsigned int a_iEndVertex)
+{
+	for (unsigned int i = a_iFirstVertex; i < a_iEndVertex; ++i) {
+		float* pPosition = a_out.position + ((size_t)i * a_out.stride);
+
+		pPosition[0] = a_currentFrame.px[i] + (a_fInterpAmount * (a_nextFrame.px[i] - a_currentFrame.px[i]));
+		pPosition[1] = a_currentFrame.py[i] + (a_fInterpAmount * (a_nextFrame.py[i] - a_currentFrame.py[i]));
+		pPosition[2] = a_currentFrame.pz[i] + (a_fInterpAmount * (a_nextFrame.pz[i] - a_currentFrame.pz[i]));
+
+		if (a_out.normal != nullptr) {
+			float* pNormal = a_out.normal + ((size_t)i * a_out.stride);
+			pNormal[0] = a_currentFrame.nx[i] + (a_fInterpAmount * (a_nextFrame.nx[i] - a_currentFrame.nx[i]));
+			pNormal[1] = a_currentFrame.ny[i] + (a_fInterpAmount * (a_nextFrame.ny[i] - a_currentFrame.ny[i]));
+			pNormal[2] = a_currentFrame.nz[i] + (a_fInterpAmount * (a_nextFrame.nz[i] - a_currentFrame.nz[i]));
+		}
+	}
+}
+
+/// <summary>
+/// Scalar blend of two interpolated frame pairs, this is the refrence every
+/// other instruction set has to match
+/// </summary>
+static void BlendScalar(const MD2KeyframeSoA (&a_frames)[MD2_BLEND_FRAME_COUNT], const float a_fFromInterpAmount, const float a_fToInterpAmount, const float a_fBlendAmount,
+	const MD2VertexStream& a_out, const unsigned int a_iFirstVertex, const unsigned int a_iEndVertex)
+{
+	const float* fromCurrentStreams[MD2_KEYFRAME_STREAMS] = { a_frames[0].px, a_frames[0].py, a_frames[0].pz, a_frames[0].nx, a_frames[0].ny, a_frames[0].nz };
+	const float* fromNextStreams[MD2_KEYFRAME_STREAMS] = { a_frames[1].px, a_frames[1].py, a_frames[1].pz, a_frames[1].nx, a_frames[1].ny, a_frames[1].nz };
+	const float* toCurrentStreams[MD2_KEYFRAME_STREAMS] = { a_frames[2].px, a_frames[2].py, a_frames[2].pz, a_frames[2].nx, a_frames[2].ny, a_frames[2].nz };
+	const float* toNextStreams[MD2_KEYFRAME_STREAMS] = { a_frames[3].px, a_frames[3].py, a_frames[3].pz, a_frames[3].nx, a_frames[3].ny, a_frames[3].nz };
+	const int iNumStreams = (a_out.normal != nullptr) ? MD2_KEYFRAME_STREAMS : 3;
+
+	for (unsigned int i = a_iFirstVertex; i < a_iEndVertex; ++i) {
+		for (int s = 0; s < iNumStreams; ++s) {
+			const float fFrom = fromCurrentStreams[s][i] + (a_fFromInterpAmount * (fromNextStreams[s][i] - fromCurrentStreams[s][i]));
+			const float fTo = toCurrentStreams[s][i] + (a_fToInterpAmount * (toNextStreams[s][i] - toCurrentStreams[s][i]));
+			float* pOut = (s < 3) ? a_out.position + ((size_t)i * a_out.stride) + s : a_out.normal + ((size_t)i * a_out.stride) + (s - 3);
+			*pOut = fFrom + (a_fBlendAmount * (fTo - fFrom));
+		}
+	}
+}
+
+#ifdef MD2_INTERPOLATOR_X86
+
+/// <summary>
+/// SSE2 interpolation of 4 vertices at a time, returns the first vertex
+/// that was not interpolated
+/// </summary>
+static unsigned int InterpolateSSE2(const MD2KeyframeSoA& a_currentFrame, const MD2KeyframeSoA& a_nextFrame, const float a_fInterpAmount,
+	const MD2VertexStream& a_out, const unsigned int a_iNumVertices)
+{
+	const __m128 t = _mm_set1_ps(a_fInterpAmount);
+	const float* currentStreams[MD2_KEYFRAME_STREAMS] = { a_currentFrame.px, a_currentFrame.py, a_currentFrame.pz, a_currentFrame.nx, a_currentFrame.ny, a_currentFrame.nz };
+	const float* nextStreams[MD2_KEYFRAME_STREAMS] = { a_nextFrame.px, a_nextFrame.py, a_nextFrame.pz, a_nextFrame.nx, a_nextFrame.ny, a_nextFrame.nz };
+
+	alignas(16) float values[MD2_KEYFRAME_STREAMS][4];
+	//Normal streams are skipped when the normals are not wanted
+	const int iNumStreams = (a_out.normal != nullptr) ? MD2_KEYFRAME_STREAMS : 3;
+
+	unsigned int i = 0;
+	for (; i + 4 <= a_iNumVertices; i += 4) {
+		for (int s = 0; s < iNumStreams; ++s) {
+			const __m128 current = _mm_loadu_ps(currentStreams[s] + i);
+			const __m128 next = _mm_loadu_ps(nextStreams[s] + i);
+			_mm_store_ps(values[s], _mm_add_ps(current, _mm_mul_ps(t, _mm_sub_ps(next, current))));
+		}
+		StoreBlock(values, a_out, i);
+	}
+
+	return i;
+}
+
+/// <summary>
+/// AVX2 interpolation of 8 vertices at a time, returns the first vertex
+/// that was not interpolated
+/// </summary>
+MD2_TARGET_AVX2 static unsigned int InterpolateAVX2(const MD2KeyframeSoA& a_currentFrame, const MD2KeyframeSoA& a_nextFrame, const float a_fInterpAmount,
+	const MD2VertexStream& a_out, const unsigned int a_iNumVertices)
+{
+	const __m256 t = _mm256_set1_ps(a_fInterpAmount);
+	const float* currentStreams[MD2_KEYFRAME_STREAMS] = { a_currentFrame.px, a_currentFrame.py, a_currentFrame.pz, a_currentFrame.nx, a_currentFrame.ny, a_currentFrame.nz };
+	const float* nextStreams[MD2_KEYFRAME_STREAMS] = { a_nextFrame.px, a_nextFrame.py, a_nextFrame.pz, a_nextFrame.nx, a_nextFrame.ny, a_nextFrame.nz };
+
+	alignas(32) float values[MD2_KEYFRAME_STREAMS][8];
+	//Normal streams are skipped when the normals are not wanted
+	const int iNumStreams = (a_out.normal != nullptr) ? MD2_KEYFRAME_STREAMS : 3;
+
+	unsigned int i = 0;
+	for (; i + 8 <= a_iNumVertices; i += 8) {
+		for (int s = 0; s < iNumStreams; ++s) {
+			const __m256 current = _mm256_loadu_ps(currentStreams[s] + i);
+			const __m256 next = _mm256_loadu_ps(nextStreams[s] + i);
+			_mm256_store_ps(values[s], _mm256_add_ps(current, _mm256_mul_ps(t, _mm256_sub_ps(next, current))));
+		}
+		StoreBlock(values, a_out, i);
+	}
+
+	return i;
+}
+
+/// <summary>
+/// SSE2 blend of two interpolated frame pairs 4 vertices at a time, returns
+/// the first vertex that was not blended
+/// </summary>
+static unsigned int BlendSSE2(const MD2KeyframeSoA (&a_frames)[MD2_BLEND_FRAME_COUNT], const float a_fFromInterpAmount, const float a_fToInterpAmount, const float a_fBlendAmount,
+	const MD2VertexStream& a_out, const unsigned int a_iNumVertices)
+{
+	const __m128 fromT = _mm_set1_ps(a_fFromInterpAmount);
+	const __m128 toT = _mm_set1_ps(a_fToInterpAmount);
+	const __m128 blend = _mm_set1_ps(a_fBlendAmount);
+	const float* fromCurrentStreams[MD2_KEYFRAME_STREAMS] = { a_frames[0].px, a_frames[0].py, a_frames[0].pz, a_frames[0].nx, a_frames[0].ny, a_frames[0].nz };
+	const float* fromNextStreams[MD2_KEYFRAME_STREAMS] = { a_frames[1].px, a_frames[1].py, a_frames[1].pz, a_frames[1].nx, a_frames[1].ny, a_frames[1].nz };
+	const float* toCurrentStreams[MD2_KEYFRAME_STREAMS] = { a_frames[2].px, a_frames[2].py, a_frames[2].pz, a_frames[2].nx, a_frames[2].ny, a_frames[2].nz };
+	const float* toNextStreams[MD2_KEYFRAME_STREAMS] = { a_frames[3].px, a_frames[3].py, a_frames[3].pz, a_frames[3].nx, a_frames[3].ny, a_frames[3].nz };
+
+	alignas(16) float values[MD2_KEYFRAME_STREAMS][4];
+	//Normal streams are skipped when the normals are not wanted
+	const int iNumStreams = (a_out.normal != nullptr) ? MD2_KEYFRAME_STREAMS : 3;
+
+	unsigned int i = 0;
+	for (; i + 4 <= a_iNumVertices; i += 4) {
+		for (int s = 0; s < iNumStreams; ++s) {
+			const __m128 fromCurrent = _mm_loadu_ps(fromCurrentStreams[s] + i);
+			const __m128 toCurrent = _mm_loadu_ps(toCurrentStreams[s] + i);
+			const __m128 from = _mm_add_ps(fromCurrent, _mm_mul_ps(fromT, _mm_sub_ps(_mm_loadu_ps(fromNextStreams[s] + i), fromCurrent)));
+			const __m128 to = _mm_add_ps(toCurrent, _mm_mul_ps(toT, _mm_sub_ps(_mm_loadu_ps(toNextStreams[s] + i), toCurrent)));
+			_mm_store_ps(values[s], _mm_add_ps(from, _mm_mul_ps(blend, _mm_sub_ps(to, from))));
+		}
+		StoreBlock(values, a_out, i);
+	}
+
+	return i;
+}
+
+/// <summary>
+/// AVX2 blend of two interpolated frame pairs 8 vertices at a time, returns
+/// the first vertex that was not blended
+/// </summary>
+MD2_TARGET_AVX2 static unsigned int BlendAVX2(const MD2KeyframeSoA (&a_frames)[MD2_BLEND_FRAME_COUNT], const float a_fFromInterpAmount, const float a_fToInterpAmount, const float a_fBlendAmount,
+	const MD2VertexStream& a_out, const unsigned int a_iNumVertices)
+{
+	const __m256 fromT = _mm256_set1_ps(a_fFromInterpAmount);
+	const __m256 toT = _mm256_set1_ps(a_fToInterpAmount);
+	const __m256 blend = _mm256_set1_ps(a_fBlendAmount);
+	const float* fromCurrentStreams[MD2_KEYFRAME_STREAMS] = { a_frames[0].px, a_frames[0].py, a_frames[0].pz, a_frames[0].nx, a_frames[0].ny, a_frames[0].nz };
+	const float* fromNextStreams[MD2_KEYFRAME_STREAMS] = { a_frames[1].px, a_frames[1].py, a_frames[1].pz, a_frames[1].nx, a_frames[1].ny, a_frames[1].nz };
+	const float* toCurrentStreams[MD2_KEYFRAME_STREAMS] = { a_frames[2].px, a_frames[2].py, a_frames[2].pz, a_frames[2].nx, a_frames[2].ny, a_frames[2].nz };
+	const float* toNextStreams[MD2_KEYFRAME_STREAMS] = { a_frames[3].px, a_frames[3].py, a_frames[3].pz, a_frames[3].nx, a_frames[3].ny, a_frames[3].nz };
+
+	alignas(32) float values[MD2_KEYFRAME_STREAMS][8];
+	//Normal streams are skipped when the normals are not wanted
+	const int iNumStreams = (a_out.normal != nullptr) ? MD2_KEYFRAME_STREAMS : 3;
+
+	unsigned int i = 0;
+	for (; i + 8 <= a_iNumVertices; i += 8) {
+		for (int s = 0; s < iNumStreams; ++s) {
+			const __m256 fromCurrent = _mm256_loadu_ps(fromCurrentStreams[s] + i);
+			const __m256 toCurrent = _mm256_loadu_ps(toCurrentStreams[s] + i);
+			const __m256 from = _mm256_add_ps(fromCurrent, _mm256_mul_ps(fromT, _mm256_sub_ps(_mm256_loadu_ps(fromNextStreams[s] + i), fromCurrent)));
+			const __m256 to = _mm256_add_ps(toCurrent, _mm256_mul_ps(toT, _mm256_sub_ps(_mm256_loadu_ps(toNextStreams[s] + i), toCurrent)));
+			_mm256_store_ps(values[s], _mm256_add_ps(from, _mm256_mul_ps(blend, _mm256_sub_ps(to, from))));
+		}
+		StoreBlock(values, a_out, i);
+	}
+
+	return i;
+}
+
+#endif // MD2_INTERPOLATOR_X86
+
+/// <summary>
+/// Finds the widest instruction set that this CPU and OS support
+/// </summary>
+/// <returns>Widest supported instruction set</returns>
+MD2Interpolator::MD2_ISA MD2Interpolator::GetSupportedISA()
+{
+#ifdef MD2_INTERPOLATOR_X86
+	unsigned int leaf1[4] = { 0, 0, 0, 0 };
+	unsigned int leaf7[4] = { 0, 0, 0, 0 };
+	unsigned long long xcr0 = 0;
+	unsigned int iMaxLeaf = 0;
+
+#ifdef _MSC_VER
+	int info[4];
+	__cpuid(info, 0);
+	iMaxLeaf = (unsigned int)info[0];
+	__cpuid(info, 1);
+	for (int i = 0; i < 4; ++i) { leaf1[i] = (unsigned int)info[i]; }
+	if (iMaxLeaf >= 7) {
+		__cpuidex(info, 7, 0);
+		for (int i = 0; i < 4; ++i) { leaf7[i] = (unsigned int)info[i]; }
+	}
+	//OS must have enabled saving of the AVX registers before we can read XCR0
+	if (leaf1[2] & (1u << 27)) {
+		xcr0 = _xgetbv(0);
+	}
+#else
+	iMaxLeaf = __get_cpuid_max(0, nullptr);
+	__get_cpuid(1, &leaf1[0], &leaf1[1], &leaf1[2], &leaf1[3]);
+	if (iMaxLeaf >= 7) {
+		__cpuid_count(7, 0, leaf7[0], leaf7[1], leaf7[2], leaf7[3]);
+	}
+	if (leaf1[2] & (1u << 27)) {
+		unsigned int xcr0Low = 0, xcr0High = 0;
+		__asm__ volatile("xgetbv" : "=a"(xcr0Low), "=d"(xcr0High) : "c"(0));
+		xcr0 = ((unsigned long long)xcr0High << 32) | xcr0Low;
+	}
+#endif
+
+	const bool bOSSavesAVX = (xcr0 & 0x6) == 0x6;
+	const bool bAVX = (leaf1[2] & (1u << 28)) != 0;
+	const bool bAVX2 = (leaf7[1] & (1u << 5)) != 0;
+	const bool bSSE2 = (leaf1[3] & (1u << 26)) != 0;
+
+	if (bOSSavesAVX && bAVX && bAVX2) {
+		return MD2_ISA_AVX2;
+	}
+	if (bSSE2) {
+		return MD2_ISA_SSE2;
+	}
+#endif
+
+	return MD2_ISA_SCALAR;
+}
+
+/// <summary>
+/// Gets the instruction set interpolation is currently run with
+/// </summary>
+MD2Interpolator::MD2_ISA MD2Interpolator::GetActiveISA()
+{
+	return m_eActiveISA;
+}
+
+/// <summary>
+/// Sets the instruction set to run interpolation with, used to compare paths
+/// or to force the scalar path
+/// </summary>
+/// <param name="a_eISA">Instruction set to use</param>
+/// <returns>If the CPU supports the instruction set, if not the active one is unchanged</returns>
+bool MD2Interpolator::SetActiveISA(MD2_ISA a_eISA)
+{
+	if (a_eISA < 0 || a_eISA >= MD2_ISA_COUNT || a_eISA > GetSupportedISA()) {
+		return false;
+	}
+
+	m_eActiveISA = a_eISA;
+	return true;
+}
+
+/// <summary>
+/// Gets a readable name for an instruction set
+/// </summary>
+const char* MD2Interpolator::GetISAName(MD2_ISA a_eISA)
+{
+	switch (a_eISA) {
+	case MD2_ISA_SCALAR:	return "Scalar";
+	case MD2_ISA_SSE2:		return "SSE2";
+	case MD2_ISA_AVX2:		return "AVX2";
+	default:				return "Unknown";
+	}
+}
+
+/// <summary>
+/// Interpolates between two decoded keyframes with the active instruction set
+/// </summary>
+/// <param name="a_currentFrame">Keyframe to interpolate from</param>
+/// <param name="a_nextFrame">Keyframe to interpolate to</param>
+/// <param name="a_fInterpAmount">Amount to interpolate between frames</param>
+/// <param name="a_out">Stream to write the interpolated vertices to</param>
+/// <param name="a_iNumVertices">Number of vertices to interpolate</param>
+void MD2Interpolator::Interpolate(const MD2KeyframeSoA& a_currentFrame, const MD2KeyframeSoA& a_nextFrame, const float a_fInterpAmount,
+	const MD2VertexStream& a_out, const unsigned int a_iNumVertices)
+{
+	unsigned int iFirstRemaining = 0;
+
+#ifdef MD2_INTERPOLATOR_X86
+	switch (m_eActiveISA) {
+	case MD2_ISA_AVX2:
+		iFirstRemaining = InterpolateAVX2(a_currentFrame, a_nextFrame, a_fInterpAmount, a_out, a_iNumVertices);
+		break;
+	case MD2_ISA_SSE2:
+		iFirstRemaining = InterpolateSSE2(a_currentFrame, a_nextFrame, a_fInterpAmount, a_out, a_iNumVertices);
+		break;
+	default:
+		break;
+	}
+#endif
+
+	//Finish off any vertices that didn't fill a whole block
+	InterpolateScalar(a_currentFrame, a_nextFrame, a_fInterpAmount, a_out, iFirstRemaining, a_iNumVertices);
+}
+
+/// <summary>
+/// Blends between two animations in one pass with the active instruction set.
+/// Each animation is interpolated between its pair of keyframes and the two
+/// results are then interpolated by the blend amount, so the four keyframes
+/// are only read once and nothing is written until the final vertex
+/// </summary>
+/// <param name="a_frames">Keyframes in MD2_BLEND_FRAME order</param>
+/// <param name="a_fFromInterpAmount">Amount between the frames of the animation being blended out</param>
+/// <param name="a_fToInterpAmount">Amount between the frames of the animation being blended in</param>
+/// <param name="a_fBlendAmount">Amount to blend, 0 is all of the animation being blended out</param>
+/// <param name="a_out">Stream to write the blended vertices to</param>
+/// <param name="a_iNumVertices">Number of vertices to blend</param>
+void MD2Interpolator::Blend(const MD2KeyframeSoA (&a_frames)[MD2_BLEND_FRAME_COUNT], const float a_fFromInterpAmount, const float a_fToInterpAmount, const float a_fBlendAmount,
+	const MD2VertexStream& a_out, const unsigned int a_iNumVertices)
+{
+	unsigned int iFirstRemaining = 0;
+
+#ifdef MD2_INTERPOLATOR_X86
+	switch (m_eActiveISA) {
+	case MD2_ISA_AVX2:
+		iFirstRemaining = BlendAVX2(a_frames, a_fFromInterpAmount, a_fToInterpAmount, a_fBlendAmount, a_out, a_iNumVertices);
+		break;
+	case MD2_ISA_SSE2:
+		iFirstRemaining = BlendSSE2(a_frames, a_fFromInterpAmount, a_fToInterpAmount, a_fBlendAmount, a_out, a_iNumVertices);
+		break;
+	default:
+		break;
+	}
+#endif
+
+	//Finish off any vertices that didn't fill a whole block
+	BlendScalar(a_frames, a_fFromInterpAmount, a_fToInterpAmount, a_fBlendAmount, a_out, iFirstRemaining, a_iNumVertices);
+}
@@ -0,0 +1,240 @@
+#include "md2_keyframe_cache.h"
+
+#include <iostream>
+#include <cstdlib>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+//Every stream in the cache starts on its own cache line
+#define MD2_KEYFRAME_CACHE_ALIGNMENT 64
+
+//Number of streams in a keyframe (position xyz and normal xyz)
+#define MD2_KEYFRAME_STREAMS 6
+
+/// <summary>
+/// Number of floats in a stream of a given number of vertices once it is
+/// padded out to a whole number of cache lines
+/// </summary>
+static size_t GetAlignedStreamLength(const unsigned int a_iNumVertices)
+{
+	const size_t iFloatsPerLine = MD2_KEYFRAME_CACHE_ALIGNMENT / sizeof(float);
+	return ((a_iNumVertices + (iFloatsPerLine - 1)) / iFloatsPerLine) * iFloatsPerLine;
+}
+
+/// <summary>
+/// Create a cache with no slots
+/// </summary>
+MD2KeyframeCache::MD2KeyframeCache()
+{
+	m_pSlots = nullptr;
+	m_iStreamLength = 0;
+	m_iSlotLength = 0;
+	m_iNumSlots = 0;
+	m_iHead = -1;
+	m_iTail = -1;
+	m_iNumHits = 0;
+	m_iNumMisses = 0;
+}
+
+/// <summary>
+/// Free the slots
+/// </summary>
+MD2KeyframeCache::~MD2KeyframeCache()
+{
+	Destroy();
+}
+
+/// <summary>
+/// Gets the number of bytes one decoded keyframe takes up in the cache
+/// </summary>
+/// <param name="a_iNumVertices">Number of vertices in each keyframe</param>
+/// <returns>Bytes for one keyframe</returns>
+size_t MD2KeyframeCache::GetFrameSize(const unsigned int a_iNumVertices)
+{
+	return GetAlignedStreamLength(a_iNumVertices) * MD2_KEYFRAME_STREAMS * sizeof(float);
+}
+
+/// <summary>
+/// Allocates as many slots as fit in the budget, never more than there are
+/// frames. Interpolating needs two frames at once so a budget that can not
+/// hold two frames is refused
+/// </summary>
+/// <param name="a_iNumVertices">Number of vertices in each keyframe</param>
+/// <param name="a_iNumFrames">Number of frames in the model</param>
+/// <param name="a_iBudgetBytes">Most bytes of keyframe data the cache may hold</param>
+/// <returns>If the cache was created</returns>
+bool MD2KeyframeCache::Create(const unsigned int a_iNumVertices, const unsigned int a_iNumFrames, const size_t a_iBudgetBytes)
+{
+	Destroy();
+
+	if (a_iNumVertices == 0 || a_iNumFrames == 0) {
+		return false;
+	}
+
+	const size_t iFrameSize = GetFrameSize(a_iNumVertices);
+	size_t iNumSlots = a_iBudgetBytes / iFrameSize;
+	if (iNumSlots > a_iNumFrames) {
+		iNumSlots = a_iNumFrames;
+	}
+	if (iNumSlots < 2 && iNumSlots < a_iNumFrames) {
+		std::cout << "Keyframe cache budget is too small to hold two frames" << std::endl;
+		return false;
+	}
+
+	void* pBlock = nullptr;
+#ifdef _WIN32
+	pBlock = _aligned_malloc(iFrameSize * iNumSlots, MD2_KEYFRAME_CACHE_ALIGNMENT);
+#else
+	if (posix_memalign(&pBlock, MD2_KEYFRAME_CACHE_ALIGNMENT, iFrameSize * iNumSlots) != 0) {
+		pBlock = nullptr;
+	}
+#endif
+	if (pBlock == nullptr) {
+		std::cout << "Unable to allocate memory for keyframe cache" << std::endl;
+		return false;
+	}
+
+	m_pSlots = static_cast<float*>(pBlock);
+	m_iStreamLength = GetAlignedStreamLength(a_iNumVertices);
+	m_iSlotLength = m_iStreamLength * MD2_KEYFRAME_STREAMS;
+	m_iNumSlots = (unsigned int)iNumSlots;
+
+	//Every slot starts empty, linked in slot order
+	m_frameSlots.assign(a_iNumFrames, -1);
+	m_slotFrames.assign(m_iNumSlots, -1);
+	m_slotPrev.resize(m_iNumSlots);
+	m_slotNext.resize(m_iNumSlots);
+	for (unsigned int i = 0; i < m_iNumSlots; ++i) {
+		m_slotPrev[i] = (int)i - 1;
+		m_slotNext[i] = (i + 1 < m_iNumSlots) ? (int)i + 1 : -1;
+	}
+	m_iHead = 0;
+	m_iTail = (int)m_iNumSlots - 1;
+
+	ResetCounters();
+	return true;
+}
+
+/// <summary>
+/// Free the slots, every frame will need decoding again if the cache is recreated
+/// </summary>
+void MD2KeyframeCache::Destroy()
+{
+	if (m_pSlots != nullptr) {
+#ifdef _WIN32
+		_aligned_free(m_pSlots);
+#else
+		free(m_pSlots);
+#endif
+	}
+
+	m_pSlots = nullptr;
+	m_iStreamLength = 0;
+	m_iSlotLength = 0;
+	m_iNumSlots = 0;
+	m_frameSlots.clear();
+	m_slotFrames.clear();
+	m_slotPrev.clear();
+	m_slotNext.clear();
+	m_iHead = -1;
+	m_iTail = -1;
+}
+
+/// <summary>
+/// Gets the slot holding a frame and marks it as the most recently used. If
+/// the frame is not in the cache the least recently used slot is given to it
+/// and the caller must decode the frame in to it
+/// </summary>
+/// <param name="a_iFrame">Frame to find, must be less than the number of frames</param>
+/// <param name="a_bOutNeedsDecode">Set if the frame has to be decoded in to the slot</param>
+/// <returns>Slot for the frame</returns>
+float* MD2KeyframeCache::Acquire(const unsigned int a_iFrame, bool& a_bOutNeedsDecode)
+{
+	int iSlot = m_frameSlots[a_iFrame];
+	a_bOutNeedsDecode = (iSlot == -1);
+
+	if (a_bOutNeedsDecode) {
+		++m_iNumMisses;
+
+		//Take the least recently used slot from whichever frame had it
+		iSlot = m_iTail;
+		if (m_slotFrames[iSlot] != -1) {
+			m_frameSlots[m_slotFrames[iSlot]] = -1;
+		}
+		m_slotFrames[iSlot] = (int)a_iFrame;
+		m_frameSlots[a_iFrame] = iSlot;
+	}
+	else {
+		++m_iNumHits;
+	}
+
+	MoveToFront(iSlot);
+	return m_pSlots + (m_iSlotLength * iSlot);
+}
+
+/// <summary>
+/// Gets a structure of arrays view of a slot
+/// </summary>
+/// <param name="a_pSlot">Slot returned from Acquire</param>
+/// <returns>View of the keyframe in the slot</returns>
+MD2KeyframeSoA MD2KeyframeCache::GetKeyframe(const float* a_pSlot) const
+{
+	MD2KeyframeSoA keyframe;
+	keyframe.px = a_pSlot;
+	keyframe.py = a_pSlot + m_iStreamLength;
+	keyframe.pz = a_pSlot + (m_iStreamLength * 2);
+	keyframe.nx = a_pSlot + (m_iStreamLength * 3);
+	keyframe.ny = a_pSlot + (m_iStreamLength * 4);
+	keyframe.nz = a_pSlot + (m_iStreamLength * 5);
+	return keyframe;
+}
+
+/// <summary>
+/// Gets one stream of a slot to decode in to, in the order px, py, pz, nx, ny, nz
+/// </summary>
+/// <param name="a_pSlot">Slot returned from Acquire</param>
+/// <param name="a_iStream">Stream to get</param>
+/// <returns>First value of the stream</returns>
+float* MD2KeyframeCache::GetStream(float* a_pSlot, const unsigned int a_iStream) const
+{
+	return a_pSlot + (m_iStreamLength * a_iStream);
+}
+
+/// <summary>
+/// Sets the hit and miss counters back to zero
+/// </summary>
+void MD2KeyframeCache::ResetCounters()
+{
+	m_iNumHits = 0;
+	m_iNumMisses = 0;
+}
+
+/// <summary>
+/// Moves a slot to the head of the use list
+/// </summary>
+/// <param name="a_iSlot">Slot that has just been used</param>
+void MD2KeyframeCache::MoveToFront(const int a_iSlot)
+{
+	if (a_iSlot == m_iHead) {
+		return;
+	}
+
+	//Unlink the slot, it can't be the head so always has a previous slot
+	const int iPrev = m_slotPrev[a_iSlot];
+	const int iNext = m_slotNext[a_iSlot];
+	m_slotNext[iPrev] = iNext;
+	if (iNext != -1) {
+		m_slotPrev[iNext] = iPrev;
+	}
+	else {
+		m_iTail = iPrev;
+	}
+
+	//Link it back in at the head
+	m_slotPrev[a_iSlot] = -1;
+	m_slotNext[a_iSlot] = m_iHead;
+	m_slotPrev[m_iHead] = a_iSlot;
+	m_iHead = a_iSlot;
+}
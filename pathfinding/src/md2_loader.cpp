@@ -3,38 +3,144 @@
 #include <iostream>
 #include <fstream>
 #include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#ifdef _WIN32
+#include <malloc.h>
+#endif
 
 #include "md2_Normals.h"
 #include "texture_manager.h"
 
+//Magic number and version that every MD2 file must start with
+#define MD2_IDENT 844121161
+#define MD2_VERSION 8
+
+//Every region of the model arena starts on its own cache line
+#define MD2_ARENA_ALIGNMENT 64
+
+/// <summary>
+/// Byte offsets of each region of a models arena, regions for the file
+/// sections are empty when the sections are viewed from a mapping
+/// </summary>
+struct MD2ArenaLayout {
+	size_t mesh;
+	size_t skins;
+	size_t textcoords;
+	size_t triangles;
+	size_t glcmds;
+	size_t frames;
+	size_t verts;
+	size_t textureIDs;
+	size_t weldedVerts;
+	size_t indices;
+	size_t weldHeads;
+	size_t weldChain;
+	size_t total;
+};
+
+/// <summary>
+/// Rounds a size up to the next arena alignment boundary
+/// </summary>
+static size_t AlignArenaSize(size_t a_size) {
+	return (a_size + (MD2_ARENA_ALIGNMENT - 1)) & ~(size_t)(MD2_ARENA_ALIGNMENT - 1);
+}
+
+/// <summary>
+/// Works out where each part of the model lives in a single arena
+/// </summary>
+/// <param name="a_header">Header of the model to lay out</param>
+/// <param name="a_bCopySections">If the file sections and frame vertices are held in the arena</param>
+/// <returns>Layout of the arena</returns>
+static MD2ArenaLayout ComputeArenaLayout(const MD2Header& a_header, bool a_bCopySections) {
+
+	size_t iCopyMultiplier = a_bCopySections ? 1 : 0;
+	MD2ArenaLayout layout;
+	size_t offset = 0;
+
+	layout.mesh = offset;		offset += AlignArenaSize(sizeof(MD2Mesh));
+	layout.frames = offset;		offset += AlignArenaSize(sizeof(MD2Frame) * a_header.num_frames);
+	layout.textureIDs = offset;	offset += AlignArenaSize(sizeof(unsigned int) * a_header.num_skins);
+	//There can never be more unique vertices than there are triangle corners
+	layout.weldedVerts = offset;	offset += AlignArenaSize(sizeof(MD2WeldedVertex) * a_header.num_tris * 3);
+	layout.indices = offset;	offset += AlignArenaSize(sizeof(unsigned short) * a_header.num_tris * 3);
+	//Lists used to find matching pairs while welding
+	layout.weldHeads = offset;	offset += AlignArenaSize(sizeof(int) * a_header.num_vertices);
+	layout.weldChain = offset;	offset += AlignArenaSize(sizeof(int) * a_header.num_tris * 3);
+	layout.skins = offset;		offset += AlignArenaSize(sizeof(MD2Skin) * a_header.num_skins * iCopyMultiplier);
+	layout.textcoords = offset;	offset += AlignArenaSize(sizeof(MD2TextCoord) * a_header.num_st * iCopyMultiplier);
+	layout.triangles = offset;	offset += AlignArenaSize(sizeof(MD2Triangle) * a_header.num_tris * iCopyMultiplier);
+	layout.glcmds = offset;		offset += AlignArenaSize(sizeof(int) * a_header.num_glcmds * iCopyMultiplier);
+	//Frame vertices are stored back to back so that frames can be walked linearly
+	layout.verts = offset;		offset += AlignArenaSize(sizeof(MD2CompressedVertex) * a_header.num_vertices * a_header.num_frames * iCopyMultiplier);
+	layout.total = offset;
+
+	return layout;
+}
+
+/// <summary>
+/// Allocates a cache aligned, zeroed block for a models arena
+/// </summary>
+static unsigned char* AllocateArena(size_t a_size) {
+	void* pBlock = nullptr;
+#ifdef _WIN32
+	pBlock = _aligned_malloc(a_size, MD2_ARENA_ALIGNMENT);
+#else
+	if (posix_memalign(&pBlock, MD2_ARENA_ALIGNMENT, a_size) != 0) {
+		pBlock = nullptr;
+	}
+#endif
+	if (pBlock != nullptr) {
+		memset(pBlock, 0, a_size);
+	}
+	return static_cast<unsigned char*>(pBlock);
+}
+
+/// <summary>
+/// Frees a block allocated with AllocateArena
+/// </summary>
+static void FreeArena(unsigned char* a_pArena) {
+#ifdef _WIN32
+	_aligned_free(a_pArena);
+#else
+	free(a_pArena);
+#endif
+}
+
 /// <summary>
 /// Create a model shell with no model loaded
 /// </summary>
 MD2Model::MD2Model() {
 	m_pModel = nullptr;
+	m_pArena = nullptr;
+	m_animationBounds = MD2FrameBounds();
 }
 
 /// <summary>
 /// Destroy allocated memory
 /// </summary>
 MD2Model::~MD2Model() {
+	Unload();
+}
 
-	if (m_pModel != nullptr) {
-		delete[] m_pModel->m_textureID;
+/// <summary>
+/// Free the model data, everything the model owns lives in the one arena
+/// and mapped sections are released with the mapping
+/// </summary>
+void MD2Model::Unload() {
 
-		for (int i = 0; i < m_pModel->m_header.num_frames; ++i) {
-			delete[] m_pModel->m_pFrames[i].verts;
-		}
+	FreeArena(m_pArena);
+	m_pArena = nullptr;
+	m_pModel = nullptr;
 
-		delete[] m_pModel->m_pSkins;
-		delete[] m_pModel->m_pTextcoords;
-		delete[] m_pModel->m_pTriangles;
-		delete[] m_pModel->m_pFrames;
-		delete[] m_pModel->m_glcmds;
-	}
+	m_keyframeCache.Destroy();
+	m_animationTable.Clear();
 
-	delete m_pModel;
-	m_pModel = nullptr;
+	m_mappedFile.Close();
 }
 
 /// <summary>
@@ -42,124 +148,506 @@ MD2Model::~MD2Model() {
 /// </summary>
 /// <param name="a_filename">Name of model file to load</param>
 /// <param name="a_fScale">Scale to make model at</param>
+/// <param name="a_eLoadMode">Whether to read the file in to the models arena or map it</param>
 /// <returns></returns>
-bool MD2Model::Load(const char* a_filename, float a_fScale) {
+bool MD2Model::Load(const char* a_filename, float a_fScale, MD2_LOAD_MODE a_eLoadMode) {
+
+	//Release any model we already have loaded
+	Unload();
+
+	bool bLoaded = false;
+	if (a_eLoadMode == MD2_LOAD_MODE_MAPPED) {
+		bLoaded = LoadFromMapping(a_filename);
+	}
+	else {
+		bLoaded = LoadFromStream(a_filename);
+	}
+
+	if (!bLoaded) {
+		Unload();
+		return false;
+	}
+
+	LoadSkinTextures(a_filename);
+
+	//Find the animations from the frame names so any model can be animated
+	//without knowing its frame ranges
+	m_animationTable.Build(m_pModel->m_pFrames, m_pModel->m_header.num_frames);
+
+	//Set scale
+	m_fScale = a_fScale;
+
+	//Bounds depend on the scale so are worked out last
+	CalculateFrameBounds();
+
+	return true;
+}
+
+/// <summary>
+/// Works out the bounds of every frame from its compressed vertices, the
+/// same way the vertices are decoded, along with bounds that hold every frame
+/// and every pose between them
+/// </summary>
+void MD2Model::CalculateFrameBounds() {
+
+	const int iNumVerts = m_pModel->m_header.num_vertices;
+	glm::vec3 animationMin = glm::vec3(FLT_MAX);
+	glm::vec3 animationMax = glm::vec3(-FLT_MAX);
+
+	for (int i = 0; i < m_pModel->m_header.num_frames; ++i) {
+		MD2Frame* frame = &m_pModel->m_pFrames[i];
+
+		//the y and z axis are swapped going from MD2 space to world space
+		const glm::vec3 scale = glm::vec3(frame->scale.x * m_fScale, frame->scale.z * m_fScale, frame->scale.y * m_fScale);
+		const glm::vec3 translate = glm::vec3(frame->translate.x * m_fScale, frame->translate.z * m_fScale, frame->translate.y * m_fScale);
+
+		glm::vec3 frameMin = glm::vec3(FLT_MAX);
+		glm::vec3 frameMax = glm::vec3(-FLT_MAX);
+		for (int j = 0; j < iNumVerts; ++j) {
+			const MD2CompressedVertex& vertex = frame->verts[j];
+			const glm::vec3 position = glm::vec3((scale.x * vertex.v[0]) + translate.x, (scale.y * vertex.v[2]) + translate.y, (scale.z * vertex.v[1]) + translate.z);
+			frameMin = glm::min(frameMin, position);
+			frameMax = glm::max(frameMax, position);
+		}
+
+		//The sphere is centred on the box and reaches the furthest vertex
+		const glm::vec3 centre = (frameMin + frameMax) * 0.5f;
+		float fRadiusSquared = 0.f;
+		for (int j = 0; j < iNumVerts; ++j) {
+			const MD2CompressedVertex& vertex = frame->verts[j];
+			const glm::vec3 position = glm::vec3((scale.x * vertex.v[0]) + translate.x, (scale.y * vertex.v[2]) + translate.y, (scale.z * vertex.v[1]) + translate.z);
+			const glm::vec3 toVertex = position - centre;
+			fRadiusSquared = std::max(fRadiusSquared, glm::dot(toVertex, toVertex));
+		}
+
+		frame->bounds.min = frameMin;
+		frame->bounds.max = frameMax;
+		frame->bounds.centre = centre;
+		frame->bounds.radius = sqrtf(fRadiusSquared);
+
+		animationMin = glm::min(animationMin, frameMin);
+		animationMax = glm::max(animationMax, frameMax);
+	}
+
+	//The sphere round every frame holds each frame's sphere
+	m_animationBounds.min = animationMin;
+	m_animationBounds.max = animationMax;
+	m_animationBounds.centre = (animationMin + animationMax) * 0.5f;
+	m_animationBounds.radius = 0.f;
+	for (int i = 0; i < m_pModel->m_header.num_frames; ++i) {
+		const MD2FrameBounds& bounds = m_pModel->m_pFrames[i].bounds;
+		m_animationBounds.radius = std::max(m_animationBounds.radius, glm::length(bounds.centre - m_animationBounds.centre) + bounds.radius);
+	}
+
+	//Interpolated poses are also held, grow the bounds to cover rounding
+	const float fPadding = mc_fBoundsPadding * (1.f + m_animationBounds.radius + glm::length(m_animationBounds.centre));
+	m_animationBounds.min -= glm::vec3(fPadding);
+	m_animationBounds.max += glm::vec3(fPadding);
+	m_animationBounds.radius += fPadding;
+}
+
+/// <summary>
+/// Allocates the arena for the model and places the mesh and frame table at
+/// the start of it
+/// </summary>
+/// <param name="a_header">Header of the model being loaded</param>
+/// <param name="a_bCopySections">If the file sections are going to be copied in to the arena</param>
+/// <returns>Layout of the allocated arena</returns>
+MD2ArenaLayout MD2Model::CreateArena(const MD2Header& a_header, bool a_bCopySections) {
+
+	MD2ArenaLayout layout = ComputeArenaLayout(a_header, a_bCopySections);
+	m_pArena = AllocateArena(layout.total);
+	if (m_pArena == nullptr) {
+		std::cout << "Unable to allocate memory for model" << std::endl;
+		return layout;
+	}
+
+	m_pModel = new (m_pArena + layout.mesh) MD2Mesh();
+	m_pModel->m_header = a_header;
+	m_pModel->m_pFrames = reinterpret_cast<MD2Frame*>(m_pArena + layout.frames);
+	m_pModel->m_textureID = reinterpret_cast<unsigned int*>(m_pArena + layout.textureIDs);
+	m_pModel->m_pWeldedVerts = reinterpret_cast<MD2WeldedVertex*>(m_pArena + layout.weldedVerts);
+	m_pModel->m_pIndices = reinterpret_cast<unsigned short*>(m_pArena + layout.indices);
+
+	return layout;
+}
+
+/// <summary>
+/// Reads the model by copying each section of the file in to a single
+/// arena sized from the header
+/// </summary>
+/// <param name="a_filename">Name of model file to load</param>
+/// <returns>If the model was read</returns>
+bool MD2Model::LoadFromStream(const char* a_filename) {
 
 	std::fstream file;
 
 	//Open the file for reading
 	file.open(a_filename, std::ios::in | std::ios::binary);
 
-	if (file.is_open()) {
-		//Get size of the file to ensure that its not empty
-		file.ignore(std::numeric_limits<std::streamsize>::max());
-		std::streamsize fileLength = file.gcount();
-		file.clear();
+	if (!file.is_open()) {
+		std::cout << "Unable to open file for reading" << std::endl;
+		return false;
+	}
+
+	//Get size of the file to ensure that its not empty
+	file.ignore(std::numeric_limits<std::streamsize>::max());
+	std::streamsize fileLength = file.gcount();
+	file.clear();
+
+	file.seekg(0, std::ios_base::beg);
+
+	if (fileLength == 0) {
+		std::cout << "File Containts No Data" << std::endl;
+		return false;
+	}
+
+	//Read Header
+	MD2Header header;
+	file.read((char*)(&header), sizeof(MD2Header));
+
+	if (!file || !ValidateHeader(header, (size_t)fileLength)) {
+		//Error Wrong File
+		file.close();
+		return false;
+	}
+
+	//Allocate memory for the whole model at once
+	MD2ArenaLayout layout = CreateArena(header, true);
+	if (m_pArena == nullptr) {
+		file.close();
+		return false;
+	}
+
+	MD2Skin* pSkins = reinterpret_cast<MD2Skin*>(m_pArena + layout.skins);
+	MD2TextCoord* pTextcoords = reinterpret_cast<MD2TextCoord*>(m_pArena + layout.textcoords);
+	MD2Triangle* pTriangles = reinterpret_cast<MD2Triangle*>(m_pArena + layout.triangles);
+	int* pGLCmds = reinterpret_cast<int*>(m_pArena + layout.glcmds);
+	MD2CompressedVertex* pVerts = reinterpret_cast<MD2CompressedVertex*>(m_pArena + layout.verts);
+	m_pModel->m_pSkins = pSkins;
+	m_pModel->m_pTextcoords = pTextcoords;
+	m_pModel->m_pTriangles = pTriangles;
+	m_pModel->m_glcmds = pGLCmds;
+
+	//Read in Model
+	file.seekg(header.offset_skins, std::ios_base::beg);
+	file.read((char*)(pSkins), sizeof(MD2Skin)*header.num_skins);
+
+	//Read in Texture Coordinate Data
+	file.seekg(header.offset_st, std::ios_base::beg);
+	file.read((char*)(pTextcoords), sizeof(MD2TextCoord) * header.num_st);
+
+	//Raed in Triangle Data
+	file.seekg(header.offset_tris, std::ios_base::beg);
+	file.read((char*)(pTriangles), sizeof(MD2Triangle) * header.num_tris);
+
+	//Read in glCmnds
+	file.seekg(header.offset_glcmds, std::ios_base::beg);
+	file.read((char*)(pGLCmds), sizeof(int) * header.num_glcmds);
+
+	//Raed in Frames, each frames vertices follow on from the last frames
+	for (int i = 0; i < header.num_frames; ++i) {
+		MD2FileFrame fileFrame;
+		MD2Frame* frame = &m_pModel->m_pFrames[i];
+		file.seekg(header.offset_frames + (i * header.framesize), std::ios_base::beg);
+		file.read((char*)(&fileFrame), sizeof(MD2FileFrame));
+		file.read((char*)(pVerts), sizeof(MD2CompressedVertex) * header.num_vertices);
+		frame->scale = fileFrame.scale;
+		frame->translate = fileFrame.translate;
+		memcpy(frame->name, fileFrame.name, sizeof(frame->name));
+		frame->verts = pVerts;
+		pVerts += header.num_vertices;
+	}
+
+	bool bRead = !file.fail();
+
+	file.close();
+	file.clear();
+
+	if (!bRead) {
+		std::cout << "Unable to read all of the model data" << std::endl;
+		return false;
+	}
+
+	if (!ValidateTriangles(header, m_pModel->m_pTriangles)) {
+		return false;
+	}
+
+	if (!ValidateFrames(header, m_pModel->m_pFrames)) {
+		return false;
+	}
+
+	return WeldVertices(layout);
+}
+
+/// <summary>
+/// Maps the model file read only and points each section of the mesh
+/// directly at the mapped data, only the mesh and frame table are
+/// held in the arena
+/// </summary>
+/// <param name="a_filename">Name of model file to load</param>
+/// <returns>If the model was mapped</returns>
+bool MD2Model::LoadFromMapping(const char* a_filename) {
+
+	if (!m_mappedFile.Open(a_filename)) {
+		return false;
+	}
+
+	const unsigned char* pData = m_mappedFile.GetData();
+	size_t fileLength = m_mappedFile.GetSize();
+
+	if (fileLength < sizeof(MD2Header)) {
+		std::cout << "This is not a valid MD2 file" << std::endl;
+		return false;
+	}
+
+	//Copy the header out of the mapping so we can hold it in the mesh
+	MD2Header header;
+	memcpy(&header, pData, sizeof(MD2Header));
 
-		file.seekg(0, std::ios_base::beg);
+	if (!ValidateHeader(header, fileLength)) {
+		return false;
+	}
+
+	//Sections must be aligned for their types to be read in place, if they aren't
+	//then read the file the old way instead
+	if (!IsMappingAligned(header)) {
+		std::cout << "MD2 sections are not aligned for mapping, reading file instead" << std::endl;
+		m_mappedFile.Close();
+		return LoadFromStream(a_filename);
+	}
+
+	MD2ArenaLayout layout = CreateArena(header, false);
+	if (m_pArena == nullptr) {
+		return false;
+	}
+
+	//Point each section at the mapped file
+	m_pModel->m_pSkins = reinterpret_cast<const MD2Skin*>(pData + header.offset_skins);
+	m_pModel->m_pTextcoords = reinterpret_cast<const MD2TextCoord*>(pData + header.offset_st);
+	m_pModel->m_pTriangles = reinterpret_cast<const MD2Triangle*>(pData + header.offset_tris);
+	m_pModel->m_glcmds = reinterpret_cast<const int*>(pData + header.offset_glcmds);
+
+	//Frame table holds the frame header and a view of the frames vertices
+	for (int i = 0; i < header.num_frames; ++i) {
+		const unsigned char* pFrameData = pData + header.offset_frames + ((size_t)i * header.framesize);
+		const MD2FileFrame* pFileFrame = reinterpret_cast<const MD2FileFrame*>(pFrameData);
+		MD2Frame* frame = &m_pModel->m_pFrames[i];
+		frame->scale = pFileFrame->scale;
+		frame->translate = pFileFrame->translate;
+		memcpy(frame->name, pFileFrame->name, sizeof(frame->name));
+		frame->verts = reinterpret_cast<const MD2CompressedVertex*>(pFrameData + sizeof(MD2FileFrame));
+	}
+
+	if (!ValidateTriangles(header, m_pModel->m_pTriangles)) {
+		return false;
+	}
+
+	if (!ValidateFrames(header, m_pModel->m_pFrames)) {
+		return false;
+	}
 
-		if (fileLength == 0) {
-			std::cout << "File Containts No Data" << std::endl;
+	return WeldVertices(layout);
+}
+
+/// <summary>
+/// Checks that the header is from an MD2 file and that every section
+/// it describes lies within the file
+/// </summary>
+/// <param name="a_header">Header to check</param>
+/// <param name="a_fileLength">Length of the file in bytes</param>
+/// <returns>If the header is valid</returns>
+bool MD2Model::ValidateHeader(const MD2Header& a_header, size_t a_fileLength) {
+
+	if ((a_header.ident != MD2_IDENT) || (a_header.version != MD2_VERSION)) {
+		std::cout << "This is not a valid MD2 file" << std::endl;
+		return false;
+	}
+
+	//Counts must be positive and we need at least one frame and skin size
+	//to build vertex data from
+	if (a_header.num_skins < 0 || a_header.num_vertices < 0 || a_header.num_st < 0 ||
+		a_header.num_tris < 0 || a_header.num_glcmds < 0 || a_header.num_frames <= 0 ||
+		a_header.skinwidth <= 0 || a_header.skinheight <= 0) {
+		std::cout << "MD2 header contains invalid counts" << std::endl;
+		return false;
+	}
+
+	//Each frame must at least hold its header and its vertices
+	long long minFrameSize = (long long)sizeof(MD2FileFrame) + (long long)sizeof(MD2CompressedVertex) * a_header.num_vertices;
+	if (a_header.framesize < minFrameSize) {
+		std::cout << "MD2 frame size is too small for its vertices" << std::endl;
+		return false;
+	}
+
+	//Check that each section starts after the header and ends within the file
+	struct Section { int offset; long long length; };
+	const Section sections[] = {
+		{ a_header.offset_skins,	(long long)sizeof(MD2Skin) * a_header.num_skins },
+		{ a_header.offset_st,		(long long)sizeof(MD2TextCoord) * a_header.num_st },
+		{ a_header.offset_tris,		(long long)sizeof(MD2Triangle) * a_header.num_tris },
+		{ a_header.offset_glcmds,	(long long)sizeof(int) * a_header.num_glcmds },
+		{ a_header.offset_frames,	(long long)a_header.framesize * a_header.num_frames },
+	};
+
+	for (const Section& section : sections) {
+		if (section.offset < (int)sizeof(MD2Header) || section.offset + section.length > (long long)a_fileLength) {
+			std::cout << "MD2 section lies outside of the file" << std::endl;
 			return false;
 		}
+	}
 
-		m_pModel = new MD2Mesh();
+	return true;
+}
 
-		//Read Header
-		file.read((char*)(&m_pModel->m_header), sizeof(MD2Header));
+/// <summary>
+/// Checks that every triangle only refrences vertices and texture
+/// coordinates that exist
+/// </summary>
+/// <param name="a_header">Header of the model</param>
+/// <param name="a_pTriangles">Triangles to check</param>
+/// <returns>If all triangles are valid</returns>
+bool MD2Model::ValidateTriangles(const MD2Header& a_header, const MD2Triangle* a_pTriangles) {
 
-		if ((m_pModel->m_header.ident != 844121161) || (m_pModel->m_header.version != 8)) {
-			//Error Wrong File
-			std::cout << "This is not a valid MD2 file" << std::endl;
-			file.close();
-			return false;
+	for (int i = 0; i < a_header.num_tris; ++i) {
+		for (int j = 0; j < 3; ++j) {
+			if (a_pTriangles[i].vertex[j] >= a_header.num_vertices || a_pTriangles[i].st[j] >= a_header.num_st) {
+				std::cout << "MD2 triangle refrences data outside of the model" << std::endl;
+				return false;
+			}
 		}
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Checks that every frame vertex only refrences a normal that exists in the
+/// precalculated normal table
+/// </summary>
+/// <param name="a_header">Header of the model</param>
+/// <param name="a_pFrames">Frames to check</param>
+/// <returns>If all frame vertices are valid</returns>
+bool MD2Model::ValidateFrames(const MD2Header& a_header, const MD2Frame* a_pFrames) {
 
- 		MD2Header* header = &m_pModel->m_header;
-
-		//Allocate memory
-		m_pModel->m_pSkins = new MD2Skin[header->num_skins];
-		m_pModel->m_pTextcoords = new MD2TextCoord[header->num_st];
-		m_pModel->m_pTriangles = new MD2Triangle[header->num_tris];
-		m_pModel->m_pFrames = new MD2Frame[header->num_frames];
-		m_pModel->m_glcmds = new int[header->num_glcmds];
-
-		//Read in Model
-		file.seekg(header->offset_skins, std::ios_base::beg);
-		file.read((char*)(m_pModel->m_pSkins), sizeof(MD2Skin)*header->num_skins);
-
-		//Read in Texture Coordinate Data
-		file.seekg(header->offset_st, std::ios_base::beg);
-		file.read((char*)(m_pModel->m_pTextcoords), sizeof(MD2TextCoord) * header->num_st);
-
-		//Raed in Triangle Data
-		file.seekg(header->offset_tris, std::ios_base::beg);
-		file.read((char*)(m_pModel->m_pTriangles), sizeof(MD2Triangle) * header->num_tris);
-
-		//Read in glCmnds
-		file.seekg(header->offset_glcmds, std::ios_base::beg);
-		file.read((char*)(m_pModel->m_glcmds), sizeof(int) * header->num_glcmds);
-
-		//Raed in Frames
-		file.seekg(header->offset_frames, std::ios_base::beg);
-		for (int i = 0; i < header->num_frames; ++i) {
-			//Allocate Memory for the verticies
-			m_pModel->m_pFrames[i].verts = new MD2CompressedVertex[header->num_vertices];
-			//read frame data in to vertex
-			MD2Frame* frame = &m_pModel->m_pFrames[i];
-			file.read((char*)(&(frame->scale)), sizeof(glm::vec3));
-			file.read((char*)(&(frame->translate)), sizeof(glm::vec3));
-			file.read((char*)(frame->name), sizeof(char) * 16);
-			file.read((char*)(frame->verts), sizeof(MD2CompressedVertex) * header->num_vertices);
+	for (int i = 0; i < a_header.num_frames; ++i) {
+		for (int j = 0; j < a_header.num_vertices; ++j) {
+			if (a_pFrames[i].verts[j].normalIndex >= precalculated_normal_length) {
+				std::cout << "MD2 frame vertex refrences a normal outside of the normal table" << std::endl;
+				return false;
+			}
 		}
+	}
 
-		file.sync();
-		file.close();
-		file.clear();
+	return true;
+}
 
-		m_pModel->m_textureID = new unsigned int[header->num_skins];
+/// <summary>
+/// Checks that each section of the file is aligned so that it can be read
+/// in place from a mapping
+/// </summary>
+/// <param name="a_header">Header of the model</param>
+/// <returns>If every section is aligned for its type</returns>
+bool MD2Model::IsMappingAligned(const MD2Header& a_header) {
+	return (a_header.offset_st % alignof(MD2TextCoord)) == 0 &&
+		(a_header.offset_tris % alignof(MD2Triangle)) == 0 &&
+		(a_header.offset_glcmds % alignof(int)) == 0 &&
+		(a_header.offset_frames % alignof(MD2FileFrame)) == 0 &&
+		(a_header.framesize % alignof(MD2FileFrame)) == 0;
+}
 
-		//acquire texture manager
-		TextureManager* pTM = TextureManager::GetInstance();
-		//Load the texture for this model
-		for (int i = 0; i < header->num_skins; ++i) {
-			std::string textureName = m_pModel->m_pSkins[i].name;
-			//Remove any quoteation marks present and strip out the texture
-			textureName.erase(std::remove(textureName.begin(), textureName.end(), '\"'), textureName.end());
+/// <summary>
+/// Builds the table of unique (vertex, texture coordinate) pairs used by the
+/// triangles and an index in to that table for every triangle corner, so that
+/// corners which share a pair are only interpolated and uploaded once
+/// </summary>
+/// <param name="a_layout">Layout of the models arena</param>
+/// <returns>If every welded vertex can be refrenced by a 16 bit index</returns>
+bool MD2Model::WeldVertices(const MD2ArenaLayout& a_layout) {
 
-			//
-			if (textureName.find_last_of("\\/") != std::string::npos) {
-				textureName = textureName.substr(textureName.find_last_of("\\/"), textureName.length());
-			}
+	MD2WeldedVertex* pWeldedVerts = reinterpret_cast<MD2WeldedVertex*>(m_pArena + a_layout.weldedVerts);
+	unsigned short* pIndices = reinterpret_cast<unsigned short*>(m_pArena + a_layout.indices);
+	int* pWeldHeads = reinterpret_cast<int*>(m_pArena + a_layout.weldHeads);
+	int* pWeldChain = reinterpret_cast<int*>(m_pArena + a_layout.weldChain);
+	int iNumWelded = 0;
 
-			std::string texturePath(a_filename);
-			if (texturePath.find_last_of("\\/") != std::string::npos) {
-				texturePath = texturePath.substr(0, texturePath.find_last_of("\\/"));
+	//Each frame vertex has a list of the welded vertices that use it
+	for (int i = 0; i < m_pModel->m_header.num_vertices; ++i) {
+		pWeldHeads[i] = -1;
+	}
+
+	for (int i = 0; i < m_pModel->m_header.num_tris; ++i) {
+		const MD2Triangle& currentTri = m_pModel->m_pTriangles[i];
+		for (int j = 0; j < 3; ++j) {
+			//Look for a welded vertex with the same pair
+			int iWelded = pWeldHeads[currentTri.vertex[j]];
+			while (iWelded != -1 && pWeldedVerts[iWelded].st != currentTri.st[j]) {
+				iWelded = pWeldChain[iWelded];
 			}
-			else {
-				//We have not path
-				texturePath = "";
+
+			//Otherwise add a new one, unique vertices are kept in the order they
+			//are first used
+			if (iWelded == -1) {
+				//Indices are 16 bit so fail rather than wrap them
+				if (iNumWelded > 0xFFFF) {
+					std::cout << "MD2 model has too many unique vertices for 16 bit indices" << std::endl;
+					return false;
+				}
+				iWelded = iNumWelded++;
+				pWeldedVerts[iWelded].vertex = currentTri.vertex[j];
+				pWeldedVerts[iWelded].st = currentTri.st[j];
+				pWeldChain[iWelded] = pWeldHeads[currentTri.vertex[j]];
+				pWeldHeads[currentTri.vertex[j]] = iWelded;
 			}
 
-			texturePath = texturePath + textureName;
+			pIndices[(i * 3) + j] = (unsigned short)iWelded;
+		}
+	}
 
-			//Call TEXTURE LOAD FUNCTION HERE, have it return the texture for the model, assign it to texture ID
-			if (pTM != nullptr) // if we have a texture manager then load teh texture...
-			{
-				m_pModel->m_textureID[i] = pTM->LoadTexture(texturePath.c_str());
-			}
+	m_pModel->m_iNumWeldedVerts = iNumWelded;
+	return true;
+}
+
+/// <summary>
+/// Loads the texture for each skin of the model through the texture manager
+/// </summary>
+/// <param name="a_filename">Name of model file, skins are loaded relative to it</param>
+void MD2Model::LoadSkinTextures(const char* a_filename) {
+
+	MD2Header* header = &m_pModel->m_header;
+
+	//acquire texture manager
+	TextureManager* pTM = TextureManager::GetInstance();
+	//Load the texture for this model
+	for (int i = 0; i < header->num_skins; ++i) {
+		//Skin names are not guaranteed to be null terminated when they fill the whole field
+		const char* skinName = m_pModel->m_pSkins[i].name;
+		std::string textureName(skinName, strnlen(skinName, sizeof(MD2Skin::name)));
+		//Remove any quoteation marks present and strip out the texture
+		textureName.erase(std::remove(textureName.begin(), textureName.end(), '\"'), textureName.end());
+
+		//
+		if (textureName.find_last_of("\\/") != std::string::npos) {
+			textureName = textureName.substr(textureName.find_last_of("\\/"), textureName.length());
 		}
 
-		//Set scale
-		m_fScale = a_fScale;
+		std::string texturePath(a_filename);
+		if (texturePath.find_last_of("\\/") != std::string::npos) {
+			texturePath = texturePath.substr(0, texturePath.find_last_of("\\/"));
+		}
+		else {
+			//We have not path
+			texturePath = "";
+		}
 
-	}
-	else {
-		std::cout << "Unable to open file for reading" << std::endl;
-		return false;
-	}
+		texturePath = texturePath + textureName;
 
-	return true;
+		//Call TEXTURE LOAD FUNCTION HERE, have it return the texture for the model, assign it to texture ID
+		if (pTM != nullptr) // if we have a texture manager then load teh texture...
+		{
+			m_pModel->m_textureID[i] = pTM->LoadTexture(texturePath.c_str());
+		}
+	}
 }
 
 /// <summary>
@@ -167,7 +655,7 @@ bool MD2Model::Load(const char* a_filename, float a_fScale) {
 /// </summary>
 /// <param name="a_iSkinID">Skin ID to load</param>
 /// <returns>Texture ID of Skin Texture</returns>
-unsigned int MD2Model::GetTextureID(int a_iSkinID) {
+unsigned int MD2Model::GetTextureID(int a_iSkinID) const {
 	
 	//if we have a number that is over the number of skins then return
 	//the skin with the modulus of the number so we always return a valid 
@@ -176,115 +664,954 @@ unsigned int MD2Model::GetTextureID(int a_iSkinID) {
 }
 
 /// <summary>
-/// Gets the number of verticies in this model
+/// Gets the number of verticies in this model when every triangle corner
+/// has its own vertex
 /// </summary>
 /// <returns>Number of verts</returns>
-unsigned int MD2Model::GetNumVerts() {
+unsigned int MD2Model::GetNumVerts() const {
+	if (m_pModel != nullptr) {
+		return m_pModel->m_header.num_tris * 3;
+	}
+	return 0;
+}
+
+/// <summary>
+/// Gets the number of frames of animation in this model
+/// </summary>
+/// <returns>Number of frames</returns>
+unsigned int MD2Model::GetNumFrames() const {
+	if (m_pModel != nullptr) {
+		return m_pModel->m_header.num_frames;
+	}
+	return 0;
+}
+
+/// <summary>
+/// Gets the number of unique vertices in this model, this is the number of
+/// vertices that indexed data is interpolated for
+/// </summary>
+/// <returns>Number of unique verts</returns>
+unsigned int MD2Model::GetNumUniqueVerts() const {
+	if (m_pModel != nullptr) {
+		return m_pModel->m_iNumWeldedVerts;
+	}
+	return 0;
+}
+
+/// <summary>
+/// Gets the number of indices needed to draw the model
+/// </summary>
+/// <returns>Number of indices</returns>
+unsigned int MD2Model::GetNumIndices() const {
 	if (m_pModel != nullptr) {
 		return m_pModel->m_header.num_tris * 3;
 	}
 	return 0;
 }
 
+/// <summary>
+/// Gets the 16 bit index buffer for drawing the unique vertices as triangles
+/// </summary>
+/// <returns>Index of the unique vertex for each triangle corner</returns>
+const unsigned short* MD2Model::GetIndices() const {
+	if (m_pModel != nullptr) {
+		return m_pModel->m_pIndices;
+	}
+	return nullptr;
+}
+
 /// <summary>
 /// Gets the interpolated animation data for this model in its current frame of 
-/// animation
+/// animation, in model space
 /// </summary>
 /// <param name="a_iCurrentFrameID">Current Frame of the animation</param>
 /// <param name="a_iNextFrameID">Next Frame of the animation</param>
 /// <param name="a_fInterpAmount">Amount to interpolate between frames</param>
-/// <param name="a_pos">Position to render model at</param>
-/// <returns>Vertex Data of model interpolated between two frames</returns>
-MD2Vertex * MD2Model::GetInterpolatedData(const unsigned int a_iCurrentFrameID, const unsigned int a_iNextFrameID, const float a_fInterpAmount, const glm::vec3 a_pos)
+/// <returns>Vertex Data of model interpolated between two frames, caller must delete[] it</returns>
+MD2Vertex * MD2Model::GetInterpolatedData(const unsigned int a_iCurrentFrameID, const unsigned int a_iNextFrameID, const float a_fInterpAmount) const
 {
-
 	//Check that we actually have a model loaded in to memory
-	if (m_pModel != nullptr) {
-		//Get the data of the current frame and next frame
-		MD2Vertex* currentFrameData = GetVertexBufferData(a_iCurrentFrameID, a_pos);
-		MD2Vertex* nextFrameData = GetVertexBufferData(a_iNextFrameID, a_pos);
-
-		//Create new data to store interpolated data
-		MD2Vertex* interpolatedFrameData = new MD2Vertex[m_pModel->m_header.num_tris * 3];
-
-		//Null check data
-		if (currentFrameData != nullptr && nextFrameData != nullptr) {
-			for (int i = 0; i < m_pModel->m_header.num_tris; ++i) {
-				for (int j = 0; j < 3; ++j) {
-					int iOffset = (i * 3);
-					//Get the linear-ly interpolated data between the current and next frame for
-					//postion, normals and colour
-					interpolatedFrameData[iOffset + j].position.x = currentFrameData[iOffset + j].position.x + (a_fInterpAmount * (nextFrameData[iOffset + j].position.x - currentFrameData[iOffset + j].position.x));
-					interpolatedFrameData[iOffset + j].position.y = currentFrameData[iOffset + j].position.y + (a_fInterpAmount * (nextFrameData[iOffset + j].position.y - currentFrameData[iOffset + j].position.y));
-					interpolatedFrameData[iOffset + j].position.z = currentFrameData[iOffset + j].position.z + (a_fInterpAmount * (nextFrameData[iOffset + j].position.z - currentFrameData[iOffset + j].position.z));
-					interpolatedFrameData[iOffset + j].position.w = currentFrameData[iOffset + j].position.w + (a_fInterpAmount * (nextFrameData[iOffset + j].position.w - currentFrameData[iOffset + j].position.w));
-					interpolatedFrameData[iOffset + j].normal = currentFrameData[iOffset + j].normal + (a_fInterpAmount * (nextFrameData[iOffset + j].normal - currentFrameData[iOffset + j].normal));
-					interpolatedFrameData[iOffset + j].colour = currentFrameData[iOffset + j].colour + (a_fInterpAmount * (nextFrameData[iOffset + j].colour - currentFrameData[iOffset + j].colour));
-
-					//Get the texture cordinates
-					interpolatedFrameData[iOffset + j].texCoord1 = currentFrameData[iOffset + j].texCoord1;
-				}
-			}
-			//Free allocated memory
-			delete[] currentFrameData;
-			delete[] nextFrameData;
-
-			//Return thge data
-			return interpolatedFrameData;
-		}
-
+	if (m_pModel == nullptr) {
 		return nullptr;
 	}
 
-	return nullptr;
+	//Interpolate the unique vertices
+	MD2Vertex* uniqueFrameData = new MD2Vertex[GetNumUniqueVerts()];
+	InitialiseVertexBuffer(uniqueFrameData, GetNumUniqueVerts());
+	GetInterpolatedData(a_iCurrentFrameID, a_iNextFrameID, a_fInterpAmount, uniqueFrameData, GetNumUniqueVerts());
+
+	//Create new data to store interpolated data, expanded out to every triangle corner
+	MD2Vertex* interpolatedFrameData = new MD2Vertex[GetNumVerts()];
+	for (unsigned int i = 0; i < GetNumIndices(); ++i) {
+		interpolatedFrameData[i] = uniqueFrameData[m_pModel->m_pIndices[i]];
+	}
+	delete[] uniqueFrameData;
 
+	//Return thge data
+	return interpolatedFrameData;
 }
 
 /// <summary>
-/// Gets the raw vertex buffer data for a given frame and postion
+/// Gets the interpolated animation data for this model in its current frame of 
+/// animation, writing it in to a buffer owned by the caller. No memory is allocated.
+/// Vertices are in model space so agents in the same animation state can share them,
+/// each agent is placed in the world with its own model matrix.
+/// One vertex is written for each unique vertex, to be drawn with GetIndices().
+/// Only the position and normal of each vertex are written, the buffer must have been
+/// set up with InitialiseVertexBuffer
 /// </summary>
-/// <param name="a_frame">Key frame of aninmation to display</param>
-/// <param name="a_pos">Postion to render model at</param>
-/// <returns>Vertex data of model at given frame and pos</returns>
-MD2Vertex* MD2Model::GetVertexBufferData(const unsigned int a_frame, const glm::vec3 a_pos) {
+/// <param name="a_iCurrentFrameID">Current Frame of the animation</param>
+/// <param name="a_iNextFrameID">Next Frame of the animation</param>
+/// <param name="a_fInterpAmount">Amount to interpolate between frames</param>
+/// <param name="a_pOutVertices">Buffer to write the interpolated vertices to</param>
+/// <param name="a_iNumOutVertices">Number of vertices the buffer can hold, must be at least GetNumUniqueVerts()</param>
+/// <param name="a_pKeyframeCache">Cache to decode keyframes in to, nullptr uses the models own cache</param>
+/// <returns>If the buffer was filled</returns>
+bool MD2Model::GetInterpolatedData(const unsigned int a_iCurrentFrameID, const unsigned int a_iNextFrameID, const float a_fInterpAmount, MD2Vertex* a_pOutVertices, const unsigned int a_iNumOutVertices, MD2KeyframeCache* a_pKeyframeCache) const
+{
+	//Check that we actually have a model loaded in to memory and somewhere to put it
+	if (m_pModel == nullptr || a_pOutVertices == nullptr || a_iNumOutVertices < GetNumUniqueVerts()) {
+		return false;
+	}
 
-	if (m_pModel != nullptr) {
+	MD2VertexStream out;
+	out.position = &a_pOutVertices[0].position.x;
+	out.normal = &a_pOutVertices[0].normal.x;
+	out.stride = sizeof(MD2Vertex) / sizeof(float);
+	InterpolateToStream(a_iCurrentFrameID, a_iNextFrameID, a_fInterpAmount, out, a_pKeyframeCache);
+
+	return true;
+}
+
+/// <summary>
+/// Gets the interpolated animation data for this model in to the per frame stream
+/// of a split vertex layout. Only positions and normals are written, the colour and
+/// texture coordinates are kept in a static stream set up with InitialiseStaticVertexBuffer
+/// </summary>
+/// <param name="a_iCurrentFrameID">Current Frame of the animation</param>
+/// <param name="a_iNextFrameID">Next Frame of the animation</param>
+/// <param name="a_fInterpAmount">Amount to interpolate between frames</param>
+/// <param name="a_pOutVertices">Buffer to write the interpolated vertices to</param>
+/// <param name="a_iNumOutVertices">Number of vertices the buffer can hold, must be at least GetNumUniqueVerts()</param>
+/// <param name="a_pKeyframeCache">Cache to decode keyframes in to, nullptr uses the models own cache</param>
+/// <returns>If the buffer was filled</returns>
+bool MD2Model::GetInterpolatedData(const unsigned int a_iCurrentFrameID, const unsigned int a_iNextFrameID, const float a_fInterpAmount, MD2DynamicVertex* a_pOutVertices, const unsigned int a_iNumOutVertices, MD2KeyframeCache* a_pKeyframeCache) const
+{
+	//Check that we actually have a model loaded in to memory and somewhere to put it
+	if (m_pModel == nullptr || a_pOutVertices == nullptr || a_iNumOutVertices < GetNumUniqueVerts()) {
+		return false;
+	}
+
+	MD2VertexStream out;
+	out.position = &a_pOutVertices[0].position.x;
+	out.normal = &a_pOutVertices[0].normal.x;
+	out.stride = sizeof(MD2DynamicVertex) / sizeof(float);
+	InterpolateToStream(a_iCurrentFrameID, a_iNextFrameID, a_fInterpAmount, out, a_pKeyframeCache);
+
+	return true;
+}
+
+/// <summary>
+/// Gets the interpolated animation data for this model in to the per frame stream
+/// of a split vertex layout, with each normal packed in to 4 bytes rather than
+/// held as floats
+/// </summary>
+/// <param name="a_iCurrentFrameID">Current Frame of the animation</param>
+/// <param name="a_iNextFrameID">Next Frame of the animation</param>
+/// <param name="a_fInterpAmount">Amount to interpolate between frames</param>
+/// <param name="a_pOutVertices">Buffer to write the interpolated vertices to</param>
+/// <param name="a_iNumOutVertices">Number of vertices the buffer can hold, must be at least GetNumUniqueVerts()</param>
+/// <param name="a_eNormalFormat">How to pack the normals, MD2_NORMAL_FORMAT_FLOAT is not valid here</param>
+/// <param name="a_pKeyframeCache">Cache to decode keyframes in to, nullptr uses the models own cache</param>
+/// <returns>If the buffer was filled</returns>
+bool MD2Model::GetInterpolatedData(const unsigned int a_iCurrentFrameID, const unsigned int a_iNextFrameID, const float a_fInterpAmount, MD2PackedVertex* a_pOutVertices, const unsigned int a_iNumOutVertices, MD2_NORMAL_FORMAT a_eNormalFormat, MD2KeyframeCache* a_pKeyframeCache) const
+{
+	//Check that we actually have a model loaded in to memory and somewhere to put it
+	if (m_pModel == nullptr || a_pOutVertices == nullptr || a_iNumOutVertices < GetNumUniqueVerts() ||
+		a_eNormalFormat == MD2_NORMAL_FORMAT_FLOAT || a_eNormalFormat >= MD2_NORMAL_FORMAT_COUNT) {
+		return false;
+	}
+
+	//Positions go through the usual interpolation, normals are packed seperately
+	MD2VertexStream out;
+	out.position = &a_pOutVertices[0].position.x;
+	out.normal = nullptr;
+	out.stride = sizeof(MD2PackedVertex) / sizeof(float);
+	InterpolateToStream(a_iCurrentFrameID, a_iNextFrameID, a_fInterpAmount, out, a_pKeyframeCache);
+	PackNormals(GetFrame(a_iCurrentFrameID), GetFrame(a_iNextFrameID), a_fInterpAmount, a_eNormalFormat, a_pOutVertices);
+
+	return true;
+}
+
+/// <summary>
+/// Gets the animation data for this model part way through blending from one
+/// animation to another. Each animation is interpolated between its own pair of
+/// frames and the two are then blended, all in one pass over the vertices.
+/// Only the position and normal of each vertex are written, the buffer must have
+/// been set up with InitialiseVertexBuffer
+/// </summary>
+/// <param name="a_from">Frames of the animation being blended out</param>
+/// <param name="a_to">Frames of the animation being blended in</param>
+/// <param name="a_fBlendAmount">Amount to blend, 0 is all of the animation being blended out</param>
+/// <param name="a_pOutVertices">Buffer to write the blended vertices to</param>
+/// <param name="a_iNumOutVertices">Number of vertices the buffer can hold, must be at least GetNumUniqueVerts()</param>
+/// <param name="a_pKeyframeCache">Cache to decode keyframes in to, nullptr uses the models own cache</param>
+/// <returns>If the buffer was filled</returns>
+bool MD2Model::GetBlendedData(const MD2AnimationPose& a_from, const MD2AnimationPose& a_to, const float a_fBlendAmount, MD2Vertex* a_pOutVertices, const unsigned int a_iNumOutVertices, MD2KeyframeCache* a_pKeyframeCache) const
+{
+	//Check that we actually have a model loaded in to memory and somewhere to put it
+	if (m_pModel == nullptr || a_pOutVertices == nullptr || a_iNumOutVertices < GetNumUniqueVerts()) {
+		return false;
+	}
+
+	MD2VertexStream out;
+	out.position = &a_pOutVertices[0].position.x;
+	out.normal = &a_pOutVertices[0].normal.x;
+	out.stride = sizeof(MD2Vertex) / sizeof(float);
+	BlendToStream(a_from, a_to, a_fBlendAmount, out, a_pKeyframeCache);
+
+	return true;
+}
+
+/// <summary>
+/// Gets the animation data for this model part way through blending from one
+/// animation to another, in to the per frame stream of a split vertex layout
+/// </summary>
+/// <param name="a_from">Frames of the animation being blended out</param>
+/// <param name="a_to">Frames of the animation being blended in</param>
+/// <param name="a_fBlendAmount">Amount to blend, 0 is all of the animation being blended out</param>
+/// <param name="a_pOutVertices">Buffer to write the blended vertices to</param>
+/// <param name="a_iNumOutVertices">Number of vertices the buffer can hold, must be at least GetNumUniqueVerts()</param>
+/// <param name="a_pKeyframeCache">Cache to decode keyframes in to, nullptr uses the models own cache</param>
+/// <returns>If the buffer was filled</returns>
+bool MD2Model::GetBlendedData(const MD2AnimationPose& a_from, const MD2AnimationPose& a_to, const float a_fBlendAmount, MD2DynamicVertex* a_pOutVertices, const unsigned int a_iNumOutVertices, MD2KeyframeCache* a_pKeyframeCache) const
+{
+	//Check that we actually have a model loaded in to memory and somewhere to put it
+	if (m_pModel == nullptr || a_pOutVertices == nullptr || a_iNumOutVertices < GetNumUniqueVerts()) {
+		return false;
+	}
+
+	MD2VertexStream out;
+	out.position = &a_pOutVertices[0].position.x;
+	out.normal = &a_pOutVertices[0].normal.x;
+	out.stride = sizeof(MD2DynamicVertex) / sizeof(float);
+	BlendToStream(a_from, a_to, a_fBlendAmount, out, a_pKeyframeCache);
+
+	return true;
+}
+
+/// <summary>
+/// Gets the animation data for this model part way through blending from one
+/// animation to another, with each normal packed in to 4 bytes. Normals held as
+/// MD2_NORMAL_FORMAT_INDEX can only name two frames, so they are taken from
+/// whichever animation has the most weight
+/// </summary>
+/// <param name="a_from">Frames of the animation being blended out</param>
+/// <param name="a_to">Frames of the animation being blended in</param>
+/// <param name="a_fBlendAmount">Amount to blend, 0 is all of the animation being blended out</param>
+/// <param name="a_pOutVertices">Buffer to write the blended vertices to</param>
+/// <param name="a_iNumOutVertices">Number of vertices the buffer can hold, must be at least GetNumUniqueVerts()</param>
+/// <param name="a_eNormalFormat">How to pack the normals, MD2_NORMAL_FORMAT_FLOAT is not valid here</param>
+/// <param name="a_pKeyframeCache">Cache to decode keyframes in to, nullptr uses the models own cache</param>
+/// <returns>If the buffer was filled</returns>
+bool MD2Model::GetBlendedData(const MD2AnimationPose& a_from, const MD2AnimationPose& a_to, const float a_fBlendAmount, MD2PackedVertex* a_pOutVertices, const unsigned int a_iNumOutVertices, MD2_NORMAL_FORMAT a_eNormalFormat, MD2KeyframeCache* a_pKeyframeCache) const
+{
+	//Check that we actually have a model loaded in to memory and somewhere to put it
+	if (m_pModel == nullptr || a_pOutVertices == nullptr || a_iNumOutVertices < GetNumUniqueVerts() ||
+		a_eNormalFormat == MD2_NORMAL_FORMAT_FLOAT || a_eNormalFormat >= MD2_NORMAL_FORMAT_COUNT) {
+		return false;
+	}
+
+	//Positions go through the usual blend, normals are packed seperately
+	MD2VertexStream out;
+	out.position = &a_pOutVertices[0].position.x;
+	out.normal = nullptr;
+	out.stride = sizeof(MD2PackedVertex) / sizeof(float);
+	BlendToStream(a_from, a_to, a_fBlendAmount, out, a_pKeyframeCache);
+
+	if (a_eNormalFormat == MD2_NORMAL_FORMAT_INDEX) {
+		const MD2AnimationPose& pose = (a_fBlendAmount < 0.5f) ? a_from : a_to;
+		PackNormals(GetFrame(pose.currentFrame), GetFrame(pose.nextFrame), pose.interpolation, a_eNormalFormat, a_pOutVertices);
+	}
+	else {
+		const MD2Frame* pFrames[MD2_BLEND_FRAME_COUNT] = { GetFrame(a_from.currentFrame), GetFrame(a_from.nextFrame), GetFrame(a_to.currentFrame), GetFrame(a_to.nextFrame) };
+		PackBlendedNormals(pFrames, a_from.interpolation, a_to.interpolation, a_fBlendAmount, a_eNormalFormat, a_pOutVertices);
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Gets the bounds of a keyframe in model space
+/// </summary>
+/// <param name="a_frame">Frame to get the bounds of</param>
+/// <param name="a_outBounds">Bounds of the frame</param>
+/// <returns>If there is a model loaded to get bounds from</returns>
+bool MD2Model::GetFrameBounds(const unsigned int a_frame, MD2FrameBounds& a_outBounds) const
+{
+	if (m_pModel == nullptr) {
+		return false;
+	}
+
+	a_outBounds = GetFrame(a_frame)->bounds;
+	return true;
+}
 
-		//used in calculating UV coordinates
+/// <summary>
+/// Gets bounds that hold the model part way between two keyframes. Each
+/// interpolated vertex is the same mix of a vertex in each frame, so mixing
+/// the boxes and spheres of the frames by the same amount gives bounds that
+/// can't be smaller than the pose. They are grown slightly to cover rounding
+/// </summary>
+/// <param name="a_iCurrentFrameID">Current Frame of the animation</param>
+/// <param name="a_iNextFrameID">Next Frame of the animation</param>
+/// <param name="a_fInterpAmount">Amount to interpolate between frames</param>
+/// <param name="a_outBounds">Bounds of the interpolated pose</param>
+/// <returns>If there is a model loaded to get bounds from</returns>
+bool MD2Model::GetInterpolatedBounds(const unsigned int a_iCurrentFrameID, const unsigned int a_iNextFrameID, const float a_fInterpAmount, MD2FrameBounds& a_outBounds) const
+{
+	if (m_pModel == nullptr) {
+		return false;
+	}
+
+	const MD2FrameBounds& current = GetFrame(a_iCurrentFrameID)->bounds;
+	const MD2FrameBounds& next = GetFrame(a_iNextFrameID)->bounds;
+	const float fPadding = mc_fBoundsPadding * (1.f + m_animationBounds.radius + glm::length(m_animationBounds.centre));
+
+	a_outBounds.min = current.min + (a_fInterpAmount * (next.min - current.min)) - glm::vec3(fPadding);
+	a_outBounds.max = current.max + (a_fInterpAmount * (next.max - current.max)) + glm::vec3(fPadding);
+	a_outBounds.centre = current.centre + (a_fInterpAmount * (next.centre - current.centre));
+	a_outBounds.radius = current.radius + (a_fInterpAmount * (next.radius - current.radius)) + fPadding;
+	return true;
+}
+
+/// <summary>
+/// Gets every keyframe of this model in to one buffer so they can all be
+/// given to the GPU once and interpolated there. Frame i's vertices start at
+/// i * GetNumUniqueVerts() and use the same indices as any other frame
+/// </summary>
+/// <param name="a_pOutVertices">Buffer to write the keyframes to</param>
+/// <param name="a_iNumOutVertices">Number of vertices the buffer can hold, must be at least GetNumFrames() * GetNumUniqueVerts()</param>
+/// <param name="a_eNormalFormat">How to pack the normals, MD2_NORMAL_FORMAT_FLOAT is not valid here</param>
+/// <returns>If the buffer was filled</returns>
+bool MD2Model::GetKeyframeData(MD2PackedVertex* a_pOutVertices, const unsigned int a_iNumOutVertices, MD2_NORMAL_FORMAT a_eNormalFormat) const
+{
+	//Check that we actually have a model loaded in to memory and somewhere to put it
+	if (m_pModel == nullptr || a_pOutVertices == nullptr || a_iNumOutVertices < GetNumFrames() * GetNumUniqueVerts() ||
+		a_eNormalFormat == MD2_NORMAL_FORMAT_FLOAT || a_eNormalFormat >= MD2_NORMAL_FORMAT_COUNT) {
+		return false;
+	}
+
+	//Each frame is decoded on its own by interpolating it with itself, this
+	//skips the keyframe cache as every frame is only read once
+	const unsigned int iNumVerts = GetNumUniqueVerts();
+	for (unsigned int i = 0; i < GetNumFrames(); ++i) {
+		MD2PackedVertex* pFrameVertices = a_pOutVertices + (i * iNumVerts);
+		const MD2Frame* pFrame = GetFrame(i);
+
+		MD2VertexStream out;
+		out.position = &pFrameVertices[0].position.x;
+		out.normal = nullptr;
+		out.stride = sizeof(MD2PackedVertex) / sizeof(float);
+		InterpolateFrames(pFrame, pFrame, 0.f, out);
+		PackNormals(pFrame, pFrame, 0.f, a_eNormalFormat, pFrameVertices);
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Blends between two animations in to a stream of vertices, using the
+/// vectorised path over cached keyframes when the cache can hold all four
+/// keyframes at once
+/// </summary>
+/// <param name="a_from">Frames of the animation being blended out</param>
+/// <param name="a_to">Frames of the animation being blended in</param>
+/// <param name="a_fBlendAmount">Amount to blend, 0 is all of the animation being blended out</param>
+/// <param name="a_out">Stream of GetNumUniqueVerts() vertices to write to</param>
+/// <param name="a_pKeyframeCache">Cache to decode keyframes in to, nullptr uses the models own cache</param>
+void MD2Model::BlendToStream(const MD2AnimationPose& a_from, const MD2AnimationPose& a_to, const float a_fBlendAmount, const MD2VertexStream& a_out, MD2KeyframeCache* a_pKeyframeCache) const
+{
+	const unsigned int frameIDs[MD2_BLEND_FRAME_COUNT] = { a_from.currentFrame, a_from.nextFrame, a_to.currentFrame, a_to.nextFrame };
+
+	MD2KeyframeCache& keyframeCache = (a_pKeyframeCache != nullptr) ? *a_pKeyframeCache : m_keyframeCache;
+	if (keyframeCache.IsCreated() && keyframeCache.GetNumSlots() >= MD2_BLEND_FRAME_COUNT) {
+		//With a slot for every frame fetching the last one can't evict the first
+		MD2KeyframeSoA keyframes[MD2_BLEND_FRAME_COUNT];
+		for (int i = 0; i < MD2_BLEND_FRAME_COUNT; ++i) {
+			keyframes[i] = GetCachedKeyframe(frameIDs[i], keyframeCache);
+		}
+		MD2Interpolator::Blend(keyframes, a_from.interpolation, a_to.interpolation, a_fBlendAmount, a_out, GetNumUniqueVerts());
+	}
+	else {
+		const MD2Frame* pFrames[MD2_BLEND_FRAME_COUNT];
+		for (int i = 0; i < MD2_BLEND_FRAME_COUNT; ++i) {
+			pFrames[i] = GetFrame(frameIDs[i]);
+		}
+		BlendFrames(pFrames, a_from.interpolation, a_to.interpolation, a_fBlendAmount, a_out);
+	}
+}
+
+/// <summary>
+/// Interpolates between two frames in to a stream of vertices, using the
+/// vectorised path over cached keyframes when there is a keyframe cache
+/// </summary>
+/// <param name="a_iCurrentFrameID">Current Frame of the animation</param>
+/// <param name="a_iNextFrameID">Next Frame of the animation</param>
+/// <param name="a_fInterpAmount">Amount to interpolate between frames</param>
+/// <param name="a_out">Stream of GetNumUniqueVerts() vertices to write to</param>
+/// <param name="a_pKeyframeCache">Cache to decode keyframes in to, nullptr uses the models own cache</param>
+void MD2Model::InterpolateToStream(const unsigned int a_iCurrentFrameID, const unsigned int a_iNextFrameID, const float a_fInterpAmount, const MD2VertexStream& a_out, MD2KeyframeCache* a_pKeyframeCache) const
+{
+	MD2KeyframeCache& keyframeCache = (a_pKeyframeCache != nullptr) ? *a_pKeyframeCache : m_keyframeCache;
+	if (keyframeCache.IsCreated()) {
+		//Run the vectorised interpolation over the decoded keyframes, the current
+		//frame is the most recently used so fetching the next frame can't evict it
+		const MD2KeyframeSoA currentKeyframe = GetCachedKeyframe(a_iCurrentFrameID, keyframeCache);
+		const MD2KeyframeSoA nextKeyframe = GetCachedKeyframe(a_iNextFrameID, keyframeCache);
+		MD2Interpolator::Interpolate(currentKeyframe, nextKeyframe, a_fInterpAmount, a_out, GetNumUniqueVerts());
+	}
+	else {
+		InterpolateFrames(GetFrame(a_iCurrentFrameID), GetFrame(a_iNextFrameID), a_fInterpAmount, a_out);
+	}
+}
+
+/// <summary>
+/// Creates a cache of keyframes decoded in to model space positions and normals,
+/// stored as a structure of arrays in unique vertex order so that interpolation
+/// can be vectorised. Frames are decoded the first time they are used and the
+/// least recently used frame is dropped once the budget is full. Models that are
+/// animated should call this once after loading. Shared models are read only so
+/// their users should create their own caches instead
+/// </summary>
+/// <param name="a_iBudgetBytes">Most bytes of decoded keyframes to hold, must fit at least two frames</param>
+/// <returns>If the cache was created</returns>
+bool MD2Model::CreateKeyframeCache(const size_t a_iBudgetBytes)
+{
+	return CreateKeyframeCache(m_keyframeCache, a_iBudgetBytes);
+}
+
+/// <summary>
+/// Creates a keyframe cache for this model that is owned by the caller. Each
+/// thread animating a shared model at the same time needs a cache of its own
+/// to pass to GetInterpolatedData
+/// </summary>
+/// <param name="a_keyframeCache">Cache to create</param>
+/// <param name="a_iBudgetBytes">Most bytes of decoded keyframes to hold, must fit at least two frames</param>
+/// <returns>If the cache was created</returns>
+bool MD2Model::CreateKeyframeCache(MD2KeyframeCache& a_keyframeCache, const size_t a_iBudgetBytes) const
+{
+	if (m_pModel == nullptr) {
+		return false;
+	}
+
+	return a_keyframeCache.Create(GetNumUniqueVerts(), m_pModel->m_header.num_frames, a_iBudgetBytes);
+}
+
+/// <summary>
+/// Counts the samples where an instruction set gives different vertices to the
+/// scalar path. Each sample interpolates a frame to the next and blends it with
+/// the frames at the other end of the model, in to every vertex layout and
+/// packed normal format. The active instruction set is changed while this runs
+/// so nothing else may animate at the same time
+/// </summary>
+/// <param name="a_eISA">Instruction set to check</param>
+/// <param name="a_pInterpAmounts">Amounts to interpolate and blend by</param>
+/// <param name="a_iNumInterpAmounts">Number of amounts</param>
+/// <returns>Number of samples, out of GetNumFrames() * a_iNumInterpAmounts, that differ</returns>
+unsigned int MD2Model::CountISAMismatches(MD2Interpolator::MD2_ISA a_eISA, const float* a_pInterpAmounts, const unsigned int a_iNumInterpAmounts) const
+{
+	const unsigned int iNumFrames = GetNumFrames();
+	const unsigned int iNumVerts = GetNumUniqueVerts();
+	const unsigned int iNumSamples = iNumFrames * a_iNumInterpAmounts;
+
+	//Instruction sets are only used over cached keyframes, give the cache
+	//room for every frame of a blend
+	MD2KeyframeCache keyframeCache;
+	if (a_eISA > MD2Interpolator::GetSupportedISA() ||
+		!CreateKeyframeCache(keyframeCache, MD2KeyframeCache::GetFrameSize(iNumVerts) * MD2_BLEND_FRAME_COUNT)) {
+		return iNumSamples;
+	}
+
+	//Vertices from the scalar path and from the instruction set
+	const MD2Interpolator::MD2_ISA aeISAs[2] = { MD2Interpolator::MD2_ISA_SCALAR, a_eISA };
+	const MD2_NORMAL_FORMAT aePackedFormats[2] = { MD2_NORMAL_FORMAT_INDEX, MD2_NORMAL_FORMAT_OCTAHEDRAL };
+	std::vector<MD2Vertex> vertices[2][2];
+	std::vector<MD2DynamicVertex> dynamicVertices[2][2];
+	std::vector<MD2PackedVertex> packedVertices[2][2][2];
+	for (int iRun = 0; iRun < 2; ++iRun) {
+		for (int iBlend = 0; iBlend < 2; ++iBlend) {
+			vertices[iRun][iBlend].resize(iNumVerts);
+			dynamicVertices[iRun][iBlend].resize(iNumVerts);
+			packedVertices[iRun][iBlend][0].resize(iNumVerts);
+			packedVertices[iRun][iBlend][1].resize(iNumVerts);
+		}
+	}
+
+	const MD2Interpolator::MD2_ISA ePreviousISA = MD2Interpolator::GetActiveISA();
+	unsigned int iNumMismatches = 0;
+	for (unsigned int iFrame = 0; iFrame < iNumFrames; ++iFrame) {
+		for (unsigned int i = 0; i < a_iNumInterpAmounts; ++i) {
+			const float fInterpAmount = a_pInterpAmounts[i];
+			const MD2AnimationPose fromPose = { iFrame, iFrame + 1, fInterpAmount };
+			const MD2AnimationPose toPose = { iNumFrames - 1 - iFrame, iNumFrames - iFrame, 1.f - fInterpAmount };
+
+			bool bMade = true;
+			for (int iRun = 0; iRun < 2; ++iRun) {
+				MD2Interpolator::SetActiveISA(aeISAs[iRun]);
+				bMade &= GetInterpolatedData(iFrame, iFrame + 1, fInterpAmount, vertices[iRun][0].data(), iNumVerts, &keyframeCache);
+				bMade &= GetInterpolatedData(iFrame, iFrame + 1, fInterpAmount, dynamicVertices[iRun][0].data(), iNumVerts, &keyframeCache);
+				bMade &= GetBlendedData(fromPose, toPose, fInterpAmount, vertices[iRun][1].data(), iNumVerts, &keyframeCache);
+				bMade &= GetBlendedData(fromPose, toPose, fInterpAmount, dynamicVertices[iRun][1].data(), iNumVerts, &keyframeCache);
+				for (int iFormat = 0; iFormat < 2; ++iFormat) {
+					bMade &= GetInterpolatedData(iFrame, iFrame + 1, fInterpAmount, packedVertices[iRun][0][iFormat].data(), iNumVerts, aePackedFormats[iFormat], &keyframeCache);
+					bMade &= GetBlendedData(fromPose, toPose, fInterpAmount, packedVertices[iRun][1][iFormat].data(), iNumVerts, aePackedFormats[iFormat], &keyframeCache);
+				}
+			}
+
+			bool bMatches = bMade;
+			for (int iBlend = 0; iBlend < 2 && bMatches; ++iBlend) {
+				bMatches = memcmp(vertices[0][iBlend].data(), vertices[1][iBlend].data(), sizeof(MD2Vertex) * iNumVerts) == 0 &&
+					memcmp(dynamicVertices[0][iBlend].data(), dynamicVertices[1][iBlend].data(), sizeof(MD2DynamicVertex) * iNumVerts) == 0 &&
+					memcmp(packedVertices[0][iBlend][0].data(), packedVertices[1][iBlend][0].data(), sizeof(MD2PackedVertex) * iNumVerts) == 0 &&
+					memcmp(packedVertices[0][iBlend][1].data(), packedVertices[1][iBlend][1].data(), sizeof(MD2PackedVertex) * iNumVerts) == 0;
+			}
+			if (!bMatches) {
+				++iNumMismatches;
+			}
+		}
+	}
+
+	MD2Interpolator::SetActiveISA(ePreviousISA);
+	return iNumMismatches;
+}
+
+/// <summary>
+/// Gets a view of a decoded keyframe, wrapping frame numbers past the last frame.
+/// The frame is decoded in to the cache if it is not already there
+/// </summary>
+/// <param name="a_frame">Key frame of animation</param>
+/// <param name="a_keyframeCache">Cache to find the keyframe in</param>
+/// <returns>Structure of arrays view of the keyframe</returns>
+MD2KeyframeSoA MD2Model::GetCachedKeyframe(const unsigned int a_frame, MD2KeyframeCache& a_keyframeCache) const
+{
+	const MD2Frame* pFrame = GetFrame(a_frame);
+
+	bool bNeedsDecode = false;
+	float* pSlot = a_keyframeCache.Acquire((unsigned int)(pFrame - m_pModel->m_pFrames), bNeedsDecode);
+	if (bNeedsDecode) {
+		DecodeKeyframe(pFrame, pSlot, a_keyframeCache);
+	}
+
+	return a_keyframeCache.GetKeyframe(pSlot);
+}
+
+/// <summary>
+/// Decodes one keyframe in to a slot of the keyframe cache
+/// </summary>
+/// <param name="a_pFrame">Frame to decode</param>
+/// <param name="a_pSlot">Cache slot to write the px, py, pz, nx, ny, nz streams to</param>
+/// <param name="a_keyframeCache">Cache the slot belongs to</param>
+void MD2Model::DecodeKeyframe(const MD2Frame* a_pFrame, float* a_pSlot, const MD2KeyframeCache& a_keyframeCache) const
+{
+	float* pPX = a_keyframeCache.GetStream(a_pSlot, 0);
+	float* pPY = a_keyframeCache.GetStream(a_pSlot, 1);
+	float* pPZ = a_keyframeCache.GetStream(a_pSlot, 2);
+	float* pNX = a_keyframeCache.GetStream(a_pSlot, 3);
+	float* pNY = a_keyframeCache.GetStream(a_pSlot, 4);
+	float* pNZ = a_keyframeCache.GetStream(a_pSlot, 5);
+
+	//the y and z axis are swapped going from MD2 space to world space
+	const glm::vec3 scale = glm::vec3(a_pFrame->scale.x * m_fScale, a_pFrame->scale.z * m_fScale, a_pFrame->scale.y * m_fScale);
+	const glm::vec3 translate = glm::vec3(a_pFrame->translate.x * m_fScale, a_pFrame->translate.z * m_fScale, a_pFrame->translate.y * m_fScale);
+
+	const unsigned int iNumVerts = GetNumUniqueVerts();
+	for (unsigned int i = 0; i < iNumVerts; ++i) {
+		const MD2CompressedVertex& vertex = a_pFrame->verts[m_pModel->m_pWeldedVerts[i].vertex];
+		const glm::vec3& normal = precalculated_normals[vertex.normalIndex];
+		pPX[i] = (scale.x * vertex.v[0]) + translate.x;
+		pPY[i] = (scale.y * vertex.v[2]) + translate.y;
+		pPZ[i] = (scale.z * vertex.v[1]) + translate.z;
+		pNX[i] = normal.x;
+		pNY[i] = normal.y;
+		pNZ[i] = normal.z;
+	}
+}
+
+/// <summary>
+/// Writes the attributes that are the same in every frame (colour, texture
+/// coordinates and the w components) in to a vertex buffer. This only needs
+/// to be done once for a buffer that is then filled by GetInterpolatedData
+/// </summary>
+/// <param name="a_pOutVertices">Buffer to set up</param>
+/// <param name="a_iNumOutVertices">Number of vertices the buffer can hold, must be at least GetNumUniqueVerts()</param>
+/// <returns>If the buffer was set up</returns>
+bool MD2Model::InitialiseVertexBuffer(MD2Vertex* a_pOutVertices, const unsigned int a_iNumOutVertices) const
+{
+	if (m_pModel == nullptr || a_pOutVertices == nullptr || a_iNumOutVertices < GetNumUniqueVerts()) {
+		return false;
+	}
+
+	//used in calculating UV coordinates
+	float invSkinWidth = 1.f / m_pModel->m_header.skinwidth;
+	float invSkinHeight = 1.f / m_pModel->m_header.skinheight;
+
+	for (int i = 0; i < m_pModel->m_iNumWeldedVerts; ++i) {
+		MD2Vertex& vertex = a_pOutVertices[i];
+		vertex.position.w = 1.f;
+		vertex.normal.w = 0.f;
+		vertex.colour = glm::vec4(1.f, 1.f, 1.f, 1.f);
+
+		const MD2TextCoord& textCoord = m_pModel->m_pTextcoords[m_pModel->m_pWeldedVerts[i].st];
+		vertex.texCoord1 = glm::vec2((float)(textCoord.s * invSkinWidth), (float)(textCoord.t * invSkinHeight));
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Writes the colour and texture coordinates of each unique vertex in to the
+/// static stream of a split vertex layout. This only needs to be done once,
+/// per frame data is then written with GetInterpolatedData
+/// </summary>
+/// <param name="a_pOutVertices">Buffer to set up</param>
+/// <param name="a_iNumOutVertices">Number of vertices the buffer can hold, must be at least GetNumUniqueVerts()</param>
+/// <returns>If the buffer was set up</returns>
+bool MD2Model::InitialiseStaticVertexBuffer(MD2StaticVertex* a_pOutVertices, const unsigned int a_iNumOutVertices) const
+{
+	if (m_pModel == nullptr || a_pOutVertices == nullptr || a_iNumOutVertices < GetNumUniqueVerts()) {
+		return false;
+	}
+
+	//used in calculating UV coordinates
+	float invSkinWidth = 1.f / m_pModel->m_header.skinwidth;
+	float invSkinHeight = 1.f / m_pModel->m_header.skinheight;
+
+	for (int i = 0; i < m_pModel->m_iNumWeldedVerts; ++i) {
+		MD2StaticVertex& vertex = a_pOutVertices[i];
+		vertex.colour = glm::vec4(1.f, 1.f, 1.f, 1.f);
+
+		const MD2TextCoord& textCoord = m_pModel->m_pTextcoords[m_pModel->m_pWeldedVerts[i].st];
+		vertex.texCoord1 = glm::vec2((float)(textCoord.s * invSkinWidth), (float)(textCoord.t * invSkinHeight));
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Fused decode and interpolate kernel. Reads the compressed vertices of both
+/// frames directly and writes only the interpolated position and normal of
+/// each vertex in one pass
+/// </summary>
+/// <param name="a_pCurrentFrame">Frame to interpolate from</param>
+/// <param name="a_pNextFrame">Frame to interpolate to</param>
+/// <param name="a_fInterpAmount">Amount to interpolate between frames</param>
+/// <param name="a_out">Stream of GetNumUniqueVerts() vertices to write to</param>
+void MD2Model::InterpolateFrames(const MD2Frame* a_pCurrentFrame, const MD2Frame* a_pNextFrame, const float a_fInterpAmount, const MD2VertexStream& a_out) const
+{
+	//Scale and translation of each frame only needs working out once per frame,
+	//the y and z axis are swapped going from MD2 space to world space
+	const glm::vec3 currentScale = glm::vec3(a_pCurrentFrame->scale.x * m_fScale, a_pCurrentFrame->scale.z * m_fScale, a_pCurrentFrame->scale.y * m_fScale);
+	const glm::vec3 currentTranslate = glm::vec3(a_pCurrentFrame->translate.x * m_fScale, a_pCurrentFrame->translate.z * m_fScale, a_pCurrentFrame->translate.y * m_fScale);
+	const glm::vec3 nextScale = glm::vec3(a_pNextFrame->scale.x * m_fScale, a_pNextFrame->scale.z * m_fScale, a_pNextFrame->scale.y * m_fScale);
+	const glm::vec3 nextTranslate = glm::vec3(a_pNextFrame->translate.x * m_fScale, a_pNextFrame->translate.z * m_fScale, a_pNextFrame->translate.y * m_fScale);
+
+	const MD2CompressedVertex* pCurrentVerts = a_pCurrentFrame->verts;
+	const MD2CompressedVertex* pNextVerts = a_pNextFrame->verts;
+	const MD2WeldedVertex* pWeldedVerts = m_pModel->m_pWeldedVerts;
+	const int iNumVerts = m_pModel->m_iNumWeldedVerts;
+
+	for (int i = 0; i < iNumVerts; ++i) {
+		const unsigned short iVertex = pWeldedVerts[i].vertex;
+		const MD2CompressedVertex& currentVertex = pCurrentVerts[iVertex];
+		const MD2CompressedVertex& nextVertex = pNextVerts[iVertex];
+		float* pOutPosition = a_out.position + (i * a_out.stride);
+
+		//Decode the postion in each frame
+		const float fCurrentX = (currentScale.x * currentVertex.v[0]) + currentTranslate.x;
+		const float fCurrentY = (currentScale.y * currentVertex.v[2]) + currentTranslate.y;
+		const float fCurrentZ = (currentScale.z * currentVertex.v[1]) + currentTranslate.z;
+		const float fNextX = (nextScale.x * nextVertex.v[0]) + nextTranslate.x;
+		const float fNextY = (nextScale.y * nextVertex.v[2]) + nextTranslate.y;
+		const float fNextZ = (nextScale.z * nextVertex.v[1]) + nextTranslate.z;
+
+		//Interpolate the postion
+		pOutPosition[0] = fCurrentX + (a_fInterpAmount * (fNextX - fCurrentX));
+		pOutPosition[1] = fCurrentY + (a_fInterpAmount * (fNextY - fCurrentY));
+		pOutPosition[2] = fCurrentZ + (a_fInterpAmount * (fNextZ - fCurrentZ));
+
+		//Interpolate the normal
+		if (a_out.normal != nullptr) {
+			float* pOutNormal = a_out.normal + (i * a_out.stride);
+			const glm::vec3& currentNormal = precalculated_normals[currentVertex.normalIndex];
+			const glm::vec3& nextNormal = precalculated_normals[nextVertex.normalIndex];
+			pOutNormal[0] = currentNormal.x + (a_fInterpAmount * (nextNormal.x - currentNormal.x));
+			pOutNormal[1] = currentNormal.y + (a_fInterpAmount * (nextNormal.y - currentNormal.y));
+			pOutNormal[2] = currentNormal.z + (a_fInterpAmount * (nextNormal.z - currentNormal.z));
+		}
+	}
+}
+
+/// <summary>
+/// Fused decode and blend kernel. Reads the compressed vertices of all four
+/// frames directly and writes only the blended position and normal of each
+/// vertex in one pass
+/// </summary>
+/// <param name="a_pFrames">Frames in MD2_BLEND_FRAME order</param>
+/// <param name="a_fFromInterpAmount">Amount between the frames of the animation being blended out</param>
+/// <param name="a_fToInterpAmount">Amount between the frames of the animation being blended in</param>
+/// <param name="a_fBlendAmount">Amount to blend, 0 is all of the animation being blended out</param>
+/// <param name="a_out">Stream of GetNumUniqueVerts() vertices to write to</param>
+void MD2Model::BlendFrames(const MD2Frame* (&a_pFrames)[MD2_BLEND_FRAME_COUNT], const float a_fFromInterpAmount, const float a_fToInterpAmount, const float a_fBlendAmount, const MD2VertexStream& a_out) const
+{
+	//Scale and translation of each frame only needs working out once per frame,
+	//the y and z axis are swapped going from MD2 space to world space
+	glm::vec3 scales[MD2_BLEND_FRAME_COUNT];
+	glm::vec3 translates[MD2_BLEND_FRAME_COUNT];
+	for (int f = 0; f < MD2_BLEND_FRAME_COUNT; ++f) {
+		scales[f] = glm::vec3(a_pFrames[f]->scale.x * m_fScale, a_pFrames[f]->scale.z * m_fScale, a_pFrames[f]->scale.y * m_fScale);
+		translates[f] = glm::vec3(a_pFrames[f]->translate.x * m_fScale, a_pFrames[f]->translate.z * m_fScale, a_pFrames[f]->translate.y * m_fScale);
+	}
+
+	const MD2WeldedVertex* pWeldedVerts = m_pModel->m_pWeldedVerts;
+	const int iNumVerts = m_pModel->m_iNumWeldedVerts;
+
+	for (int i = 0; i < iNumVerts; ++i) {
+		const unsigned short iVertex = pWeldedVerts[i].vertex;
+
+		//Decode the postion and look up the normal in each frame
+		glm::vec3 positions[MD2_BLEND_FRAME_COUNT];
+		const glm::vec3* pNormals[MD2_BLEND_FRAME_COUNT];
+		for (int f = 0; f < MD2_BLEND_FRAME_COUNT; ++f) {
+			const MD2CompressedVertex& vertex = a_pFrames[f]->verts[iVertex];
+			positions[f].x = (scales[f].x * vertex.v[0]) + translates[f].x;
+			positions[f].y = (scales[f].y * vertex.v[2]) + translates[f].y;
+			positions[f].z = (scales[f].z * vertex.v[1]) + translates[f].z;
+			pNormals[f] = &precalculated_normals[vertex.normalIndex];
+		}
+
+		//Interpolate each animation then blend between them
+		float* pOutPosition = a_out.position + (i * a_out.stride);
+		for (int c = 0; c < 3; ++c) {
+			const float fFrom = positions[0][c] + (a_fFromInterpAmount * (positions[1][c] - positions[0][c]));
+			const float fTo = positions[2][c] + (a_fToInterpAmount * (positions[3][c] - positions[2][c]));
+			pOutPosition[c] = fFrom + (a_fBlendAmount * (fTo - fFrom));
+		}
+
+		if (a_out.normal != nullptr) {
+			float* pOutNormal = a_out.normal + (i * a_out.stride);
+			for (int c = 0; c < 3; ++c) {
+				const float fFrom = (*pNormals[0])[c] + (a_fFromInterpAmount * ((*pNormals[1])[c] - (*pNormals[0])[c]));
+				const float fTo = (*pNormals[2])[c] + (a_fToInterpAmount * ((*pNormals[3])[c] - (*pNormals[2])[c]));
+				pOutNormal[c] = fFrom + (a_fBlendAmount * (fTo - fFrom));
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Writes the blended normal of each unique vertex packed as octahedral
+/// values. Vertices with the same normal in all four frames are taken
+/// straight from the table
+/// </summary>
+/// <param name="a_pFrames">Frames in MD2_BLEND_FRAME order</param>
+/// <param name="a_fFromInterpAmount">Amount between the frames of the animation being blended out</param>
+/// <param name="a_fToInterpAmount">Amount between the frames of the animation being blended in</param>
+/// <param name="a_fBlendAmount">Amount to blend, 0 is all of the animation being blended out</param>
+/// <param name="a_eNormalFormat">How to pack the normals, only MD2_NORMAL_FORMAT_OCTAHEDRAL can hold a blend</param>
+/// <param name="a_pOutVertices">Buffer of GetNumUniqueVerts() vertices to write to</param>
+void MD2Model::PackBlendedNormals(const MD2Frame* (&a_pFrames)[MD2_BLEND_FRAME_COUNT], const float a_fFromInterpAmount, const float a_fToInterpAmount, const float a_fBlendAmount, MD2_NORMAL_FORMAT a_eNormalFormat, MD2PackedVertex* a_pOutVertices) const
+{
+	if (a_eNormalFormat != MD2_NORMAL_FORMAT_OCTAHEDRAL) {
+		return;
+	}
+
+	const MD2WeldedVertex* pWeldedVerts = m_pModel->m_pWeldedVerts;
+	const int iNumVerts = m_pModel->m_iNumWeldedVerts;
+	const unsigned int* pPackedNormals = GetPrecalculatedNormalsOctahedral();
+
+	for (int i = 0; i < iNumVerts; ++i) {
+		const unsigned short iVertex = pWeldedVerts[i].vertex;
+		const unsigned char iFromCurrentNormal = a_pFrames[MD2_BLEND_FRAME_FROM_CURRENT]->verts[iVertex].normalIndex;
+		const unsigned char iFromNextNormal = a_pFrames[MD2_BLEND_FRAME_FROM_NEXT]->verts[iVertex].normalIndex;
+		const unsigned char iToCurrentNormal = a_pFrames[MD2_BLEND_FRAME_TO_CURRENT]->verts[iVertex].normalIndex;
+		const unsigned char iToNextNormal = a_pFrames[MD2_BLEND_FRAME_TO_NEXT]->verts[iVertex].normalIndex;
+
+		if (iFromCurrentNormal == iFromNextNormal && iFromCurrentNormal == iToCurrentNormal && iFromCurrentNormal == iToNextNormal) {
+			a_pOutVertices[i].normal = pPackedNormals[iFromCurrentNormal];
+			continue;
+		}
+
+		//Blend the normals and put the result back on the unit sphere before packing.
+		//Normals that cancel out have no direction, so keep the current one
+		const glm::vec3 fromNormal = precalculated_normals[iFromCurrentNormal] + (a_fFromInterpAmount * (precalculated_normals[iFromNextNormal] - precalculated_normals[iFromCurrentNormal]));
+		const glm::vec3 toNormal = precalculated_normals[iToCurrentNormal] + (a_fToInterpAmount * (precalculated_normals[iToNextNormal] - precalculated_normals[iToCurrentNormal]));
+		const glm::vec3 normal = fromNormal + (a_fBlendAmount * (toNormal - fromNormal));
+		const float fLengthSquared = glm::dot(normal, normal);
+		if (fLengthSquared < 1e-6f) {
+			a_pOutVertices[i].normal = pPackedNormals[iFromCurrentNormal];
+			continue;
+		}
+		a_pOutVertices[i].normal = PackNormalOctahedral(normal * (1.f / sqrtf(fLengthSquared)));
+	}
+}
+
+/// <summary>
+/// Writes the packed normal of each unique vertex. The normal index is read
+/// straight from the compressed vertices of both frames, so the normals are
+/// never expanded to floats in the output
+/// </summary>
+/// <param name="a_pCurrentFrame">Frame to interpolate from</param>
+/// <param name="a_pNextFrame">Frame to interpolate to</param>
+/// <param name="a_fInterpAmount">Amount to interpolate between frames</param>
+/// <param name="a_eNormalFormat">How to pack the normals, must not be MD2_NORMAL_FORMAT_FLOAT</param>
+/// <param name="a_pOutVertices">Buffer of GetNumUniqueVerts() vertices to write to</param>
+void MD2Model::PackNormals(const MD2Frame* a_pCurrentFrame, const MD2Frame* a_pNextFrame, const float a_fInterpAmount, MD2_NORMAL_FORMAT a_eNormalFormat, MD2PackedVertex* a_pOutVertices) const
+{
+	const MD2CompressedVertex* pCurrentVerts = a_pCurrentFrame->verts;
+	const MD2CompressedVertex* pNextVerts = a_pNextFrame->verts;
+	const MD2WeldedVertex* pWeldedVerts = m_pModel->m_pWeldedVerts;
+	const int iNumVerts = m_pModel->m_iNumWeldedVerts;
+
+	if (a_eNormalFormat == MD2_NORMAL_FORMAT_INDEX) {
+		//Interpolating and renormalising is left to the shader
+		for (int i = 0; i < iNumVerts; ++i) {
+			const unsigned short iVertex = pWeldedVerts[i].vertex;
+			a_pOutVertices[i].normal = (unsigned int)pCurrentVerts[iVertex].normalIndex | ((unsigned int)pNextVerts[iVertex].normalIndex << 8);
+		}
+		return;
+	}
+
+	const unsigned int* pPackedNormals = GetPrecalculatedNormalsOctahedral();
+	for (int i = 0; i < iNumVerts; ++i) {
+		const unsigned short iVertex = pWeldedVerts[i].vertex;
+		const unsigned char iCurrentNormal = pCurrentVerts[iVertex].normalIndex;
+		const unsigned char iNextNormal = pNextVerts[iVertex].normalIndex;
+
+		//Most vertices keep the same normal from one frame to the next, these
+		//can be taken from the table without interpolating
+		if (iCurrentNormal == iNextNormal) {
+			a_pOutVertices[i].normal = pPackedNormals[iCurrentNormal];
+			continue;
+		}
+
+		//Interpolate the normal and put it back on the unit sphere before packing.
+		//Opposite normals half way between frames have no direction, so keep the current one
+		const glm::vec3& currentNormal = precalculated_normals[iCurrentNormal];
+		const glm::vec3& nextNormal = precalculated_normals[iNextNormal];
+		const glm::vec3 normal = currentNormal + (a_fInterpAmount * (nextNormal - currentNormal));
+		const float fLengthSquared = glm::dot(normal, normal);
+		if (fLengthSquared < 1e-6f) {
+			a_pOutVertices[i].normal = pPackedNormals[iCurrentNormal];
+			continue;
+		}
+		a_pOutVertices[i].normal = PackNormalOctahedral(normal * (1.f / sqrtf(fLengthSquared)));
+	}
+}
+
+/// <summary>
+/// Gets the raw vertex buffer data for a given frame in model space
+/// </summary>
+/// <param name="a_frame">Key frame of aninmation to display</param>
+/// <returns>Vertex data of model at given frame, caller must delete[] it</returns>
+MD2Vertex* MD2Model::GetVertexBufferData(const unsigned int a_frame) const {
+
+	if (m_pModel == nullptr) {
+		return nullptr;
+	}
+
+	MD2Vertex* pVertexBufferData = new MD2Vertex[GetNumVerts()];
+	GetVertexBufferData(a_frame, pVertexBufferData, GetNumVerts());
+
+	return pVertexBufferData;
+}
+
+/// <summary>
+/// Gets the raw vertex buffer data for a given frame in model space, writing it
+/// in to a buffer owned by the caller
+/// </summary>
+/// <param name="a_frame">Key frame of aninmation to display</param>
+/// <param name="a_pOutVertices">Buffer to write the vertices to</param>
+/// <param name="a_iNumOutVertices">Number of vertices the buffer can hold, must be at least GetNumVerts()</param>
+/// <returns>If the buffer was filled</returns>
+bool MD2Model::GetVertexBufferData(const unsigned int a_frame, MD2Vertex* a_pOutVertices, const unsigned int a_iNumOutVertices) const {
+
+	if (m_pModel == nullptr || a_pOutVertices == nullptr || a_iNumOutVertices < GetNumVerts()) {
+		return false;
+	}
+
+	if (m_keyframeCache.IsCreated()) {
+		//Expand the cached keyframe out to every triangle corner, nothing needs decoding
+		//if the frame is already in the cache
+		const MD2KeyframeSoA keyframe = GetCachedKeyframe(a_frame, m_keyframeCache);
 		float invSkinWidth = 1.f / m_pModel->m_header.skinwidth;
 		float invSkinHeight = 1.f / m_pModel->m_header.skinheight;
 
-		//Can Change 0 for ohter frame info
-		unsigned int fID = (a_frame >= m_pModel->m_header.num_frames) ? (a_frame % m_pModel->m_header.num_frames) : a_frame;
-		MD2Frame* pCurrentFrame = &m_pModel->m_pFrames[fID];
-		MD2Vertex* pVertexBufferData = new MD2Vertex[m_pModel->m_header.num_tris*3];
-
-		glm::mat4 model = glm::mat4(1.0f);
-
-		for (int i = 0; i < m_pModel->m_header.num_tris; ++i) {
-			//For each triangle in the model
-			MD2Triangle currentTri = m_pModel->m_pTriangles[i];
-			//For each vertex in the triangle
-			for (int j = 0; j < 3; ++j) {
-				MD2CompressedVertex* pV = &pCurrentFrame->verts[currentTri.vertex[j]];
-				//Calculate the real postion of the vertex
-				int iOffset = (i * 3);
-				pVertexBufferData[iOffset + j].position.x = (pCurrentFrame->scale.x * m_fScale * pV->v[0]) + (pCurrentFrame->translate.x * m_fScale) + a_pos.x;
-				pVertexBufferData[iOffset + j].position.y = (pCurrentFrame->scale.z * m_fScale * pV->v[2]) + (pCurrentFrame->translate.z * m_fScale) + a_pos.y;
-				pVertexBufferData[iOffset + j].position.z = (pCurrentFrame->scale.y * m_fScale * pV->v[1]) + (pCurrentFrame->translate.y * m_fScale) + a_pos.z;
-				pVertexBufferData[iOffset + j].position.w = 1.f;
-				pVertexBufferData[iOffset + j].normal = glm::vec4(precalculated_normals[pV->normalIndex], 0.f);
-				pVertexBufferData[iOffset + j].colour = glm::vec4(1.f, 1.f, 1.f, 1.f);
-
-				//Calculate texture coordinates
-				MD2TextCoord& textCoord = m_pModel->m_pTextcoords[currentTri.st[j]];
-				pVertexBufferData[iOffset + j].texCoord1 = glm::vec2((float)(textCoord.s * invSkinWidth), (float)(textCoord.t * invSkinHeight));
-			}
+		for (unsigned int i = 0; i < GetNumIndices(); ++i) {
+			const unsigned short iVertex = m_pModel->m_pIndices[i];
+			MD2Vertex& vertex = a_pOutVertices[i];
+			vertex.position = glm::vec4(keyframe.px[iVertex], keyframe.py[iVertex], keyframe.pz[iVertex], 1.f);
+			vertex.normal = glm::vec4(keyframe.nx[iVertex], keyframe.ny[iVertex], keyframe.nz[iVertex], 0.f);
+			vertex.colour = glm::vec4(1.f, 1.f, 1.f, 1.f);
+
+			const MD2TextCoord& textCoord = m_pModel->m_pTextcoords[m_pModel->m_pWeldedVerts[iVertex].st];
+			vertex.texCoord1 = glm::vec2((float)(textCoord.s * invSkinWidth), (float)(textCoord.t * invSkinHeight));
 		}
 
-		return pVertexBufferData;
+		return true;
 	}
 
-	return nullptr;
+	const MD2Frame* pCurrentFrame = GetFrame(a_frame);
+
+	for (int i = 0; i < m_pModel->m_header.num_tris; ++i) {
+		//For each vertex in the triangle
+		for (int j = 0; j < 3; ++j) {
+			int iOffset = (i * 3);
+			a_pOutVertices[iOffset + j] = GetVertex(pCurrentFrame, i, j);
+		}
+	}
+
+	return true;
+}
+
+/// <summary>
+/// Gets a frame of the model, wrapping frame numbers past the last frame
+/// </summary>
+/// <param name="a_frame">Key frame of animation</param>
+/// <returns>Frame data</returns>
+const MD2Frame* MD2Model::GetFrame(const unsigned int a_frame) const {
+	unsigned int fID = (a_frame >= (unsigned int)m_pModel->m_header.num_frames) ? (a_frame % m_pModel->m_header.num_frames) : a_frame;
+	return &m_pModel->m_pFrames[fID];
+}
+
+/// <summary>
+/// Decompresses the vertex at one corner of a triangle for a given frame
+/// </summary>
+/// <param name="a_pFrame">Frame to take the vertex from</param>
+/// <param name="a_iTriangle">Triangle the vertex belongs to</param>
+/// <param name="a_iCorner">Corner of the triangle (0-2)</param>
+/// <returns>Decompressed vertex</returns>
+MD2Vertex MD2Model::GetVertex(const MD2Frame* a_pFrame, const int a_iTriangle, const int a_iCorner) const {
+
+	//used in calculating UV coordinates
+	float invSkinWidth = 1.f / m_pModel->m_header.skinwidth;
+	float invSkinHeight = 1.f / m_pModel->m_header.skinheight;
+
+	const MD2Triangle& currentTri = m_pModel->m_pTriangles[a_iTriangle];
+	const MD2CompressedVertex* pV = &a_pFrame->verts[currentTri.vertex[a_iCorner]];
+
+	//Calculate the real postion of the vertex
+	MD2Vertex vertex;
+	vertex.position.x = (a_pFrame->scale.x * m_fScale * pV->v[0]) + (a_pFrame->translate.x * m_fScale);
+	vertex.position.y = (a_pFrame->scale.z * m_fScale * pV->v[2]) + (a_pFrame->translate.z * m_fScale);
+	vertex.position.z = (a_pFrame->scale.y * m_fScale * pV->v[1]) + (a_pFrame->translate.y * m_fScale);
+	vertex.position.w = 1.f;
+	vertex.normal = glm::vec4(precalculated_normals[pV->normalIndex], 0.f);
+	vertex.colour = glm::vec4(1.f, 1.f, 1.f, 1.f);
+
+	//Calculate texture coordinates
+	const MD2TextCoord& textCoord = m_pModel->m_pTextcoords[currentTri.st[a_iCorner]];
+	vertex.texCoord1 = glm::vec2((float)(textCoord.s * invSkinWidth), (float)(textCoord.t * invSkinHeight));
 
+	return vertex;
 }
@@ -0,0 +1,99 @@
+#include "md2_model_manager.h"
+
+//Project Includes
+#include "md2_loader.h"
+
+//C Includes
+#include <iostream>
+
+/// <summary>
+/// Default Empty Constructor
+/// </summary>
+MD2ModelManager::MD2ModelManager() : Manager<MD2ModelManager>()
+{
+
+}
+
+/// <summary>
+/// Destructor, unload any models that were never released
+/// </summary>
+MD2ModelManager::~MD2ModelManager()
+{
+	for (auto& dictonaryEntry : m_pModelDictonary) {
+		delete dictonaryEntry.second.pModel;
+	}
+	m_pModelDictonary.clear();
+}
+
+/// <summary>
+/// Gets a shared model, loading it if nothing is using it yet. Every call
+/// must be matched with a call to ReleaseModel
+/// </summary>
+/// <param name="a_pFilename">File name of the model</param>
+/// <param name="a_fScale">Scale to make the model at</param>
+/// <returns>Shared model, nullptr if it could not be loaded</returns>
+const MD2Model* MD2ModelManager::AcquireModel(const char* a_pFilename, float a_fScale)
+{
+	if (a_pFilename == nullptr) {
+		return nullptr;
+	}
+
+	//If the model is already in memory then share it and increase
+	//how many times it is refrenced
+	const ModelKey key(a_pFilename, a_fScale);
+	std::map<ModelKey, ModelRef>::iterator dictonaryIter = m_pModelDictonary.find(key);
+	if (dictonaryIter != m_pModelDictonary.end()) {
+		ModelRef& modelRef = dictonaryIter->second;
+		++modelRef.refCount;
+		return modelRef.pModel;
+	}
+
+	//This model is not in memory so we need to load it in
+	MD2Model* pModel = new MD2Model();
+	if (!pModel->Load(a_pFilename, a_fScale, MD2_LOAD_MODE_MAPPED)) {
+		std::cout << "Unable to load shared model " << a_pFilename << std::endl;
+		delete pModel;
+		return nullptr;
+	}
+
+	ModelRef modelRef = { pModel, 1 };
+	m_pModelDictonary[key] = modelRef;
+	return pModel;
+}
+
+/// <summary>
+/// Releases a model got from AcquireModel, once nothing refrences the model
+/// it is unloaded
+/// </summary>
+/// <param name="a_pModel">Model to release</param>
+void MD2ModelManager::ReleaseModel(const MD2Model* a_pModel)
+{
+	if (a_pModel == nullptr) {
+		return;
+	}
+
+	//Find the model in the dictonary
+	std::map<ModelKey, ModelRef>::iterator dictonaryIter = m_pModelDictonary.begin();
+	for (; dictonaryIter != m_pModelDictonary.end(); ++dictonaryIter) {
+
+		ModelRef& modelRef = dictonaryIter->second;
+		if (modelRef.pModel == a_pModel) {
+
+			//If the refrence count has reached zero completly delete the model
+			if (--modelRef.refCount == 0) {
+				delete modelRef.pModel;
+				m_pModelDictonary.erase(dictonaryIter);
+			}
+			return;
+		}
+	}
+}
+
+/// <summary>
+/// Gets the number of models currently loaded
+/// </summary>
+/// <returns>Number of unique models in memory</returns>
+unsigned int MD2ModelManager::GetNumModels() const
+{
+	return (unsigned int)m_pModelDictonary.size();
+}
@@ -5,6 +5,8 @@
 #include <GLFW/glfw3.h>
 #include <glm/ext.hpp>
 
+#include "md2_Normals.h"
+
 
 void PathfindingApp::InitBoilerplateGL()
 {
@@ -26,7 +28,7 @@ void PathfindingApp::InitBoilerplateGL()
 	m_fragmentShader = Utility::loadShader("./shaders/fragment.glsl", GL_FRAGMENT_SHADER);
 	//Define the input and output varialbes in the shaders
 	//Note: these names are taken from the glsl files
-	const char* szInputs[] = { "Position", "Normal", "Colour","Tex1" };
+	const char* szInputs[] = { "Position", "Normal", "Colour","Tex1", "NextPosition", "NextNormal", "InstanceFrames", "InstanceOffset" };
 	const char* szOutputs[] = { "FragColor" };
 	//bind the shaders to create our shader program
 	m_program = Utility::createProgram(
@@ -35,16 +37,22 @@ void PathfindingApp::InitBoilerplateGL()
 		0,
 		0,
 		m_fragmentShader,
-		4, szInputs, 1, szOutputs);
+		8, szInputs, 1, szOutputs);
 
 	//Generate our OpenGL Vertex and Index Buffers for rendering our FBX Model Data
 	// OPENGL: generate the VBO, IBO and VAO
 	glGenBuffers(1, &m_vbo);
+	glGenBuffers(1, &m_staticVbo);
+	glGenBuffers(1, &m_ibo);
+	glGenBuffers(1, &m_keyframeVbo);
 	glGenVertexArrays(1, &m_vao);
+	glGenVertexArrays(1, &m_keyframeVao);
+	glGenVertexArrays(1, &m_animationTextureVao);
 
 	// OPENGL: Bind  VAO, and then bind the VBO and IBO to the VAO
 	glBindVertexArray(m_vao);
 	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
 
 	//There is no need to populate the vbo & ibo buffers with any data at this stage
 	//this can be done when rendering each mesh component of the FBX model
@@ -55,18 +63,86 @@ void PathfindingApp::InitBoilerplateGL()
 	glEnableVertexAttribArray(2); //Colour
 	glEnableVertexAttribArray(3); //Tex1
 
-
-								  // tell our shaders where the information within our buffers lie
-	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(MD2Vertex), ((char *)0) + MD2Vertex::PositionOffset);
-	glVertexAttribPointer(1, 4, GL_FLOAT, GL_TRUE, sizeof(MD2Vertex), ((char *)0) + MD2Vertex::NormalOffset);
-	glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(MD2Vertex), ((char *)0) + MD2Vertex::ColourOffset);
-	glVertexAttribPointer(3, 2, GL_FLOAT, GL_TRUE, sizeof(MD2Vertex), ((char *)0) + MD2Vertex::TexCoord1Offset);
+	// tell our shaders where the information within our buffers lie
+	if (m_eVertexLayout == MD2_VERTEX_LAYOUT_SPLIT) {
+		//Position and normal change every frame and come from the vbo
+		if (m_eNormalFormat == MD2_NORMAL_FORMAT_INDEX) {
+			//The 2 normal indices are unpacked by the shader
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MD2PackedVertex), ((char *)0) + MD2PackedVertex::PositionOffset);
+			glVertexAttribPointer(1, 2, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(MD2PackedVertex), ((char *)0) + MD2PackedVertex::NormalOffset);
+		}
+		else if (m_eNormalFormat == MD2_NORMAL_FORMAT_OCTAHEDRAL) {
+			//The 2 octahedral values are unpacked by the shader
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MD2PackedVertex), ((char *)0) + MD2PackedVertex::PositionOffset);
+			glVertexAttribPointer(1, 2, GL_SHORT, GL_FALSE, sizeof(MD2PackedVertex), ((char *)0) + MD2PackedVertex::NormalOffset);
+		}
+		else {
+			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MD2DynamicVertex), ((char *)0) + MD2DynamicVertex::PositionOffset);
+			glVertexAttribPointer(1, 3, GL_FLOAT, GL_TRUE, sizeof(MD2DynamicVertex), ((char *)0) + MD2DynamicVertex::NormalOffset);
+		}
+
+		//Colour and UVs never change so come from the static vbo
+		glBindBuffer(GL_ARRAY_BUFFER, m_staticVbo);
+		glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(MD2StaticVertex), ((char *)0) + MD2StaticVertex::ColourOffset);
+		glVertexAttribPointer(3, 2, GL_FLOAT, GL_TRUE, sizeof(MD2StaticVertex), ((char *)0) + MD2StaticVertex::TexCoord1Offset);
+	}
+	else {
+		glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(MD2Vertex), ((char *)0) + MD2Vertex::PositionOffset);
+		glVertexAttribPointer(1, 4, GL_FLOAT, GL_TRUE, sizeof(MD2Vertex), ((char *)0) + MD2Vertex::NormalOffset);
+		glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(MD2Vertex), ((char *)0) + MD2Vertex::ColourOffset);
+		glVertexAttribPointer(3, 2, GL_FLOAT, GL_TRUE, sizeof(MD2Vertex), ((char *)0) + MD2Vertex::TexCoord1Offset);
+	}
 
 	// finally, where done describing our mesh to the shader
 	// we can describe the next mesh
 	glBindVertexArray(0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
+	//When the shader interpolates, every keyframe sits in m_keyframeVbo and the
+	//current and next frame are read through two sets of attributes. Where in
+	//the buffer they are read from is set each draw in DrawModel
+	m_eKeyframeNormalFormat = (m_eNormalFormat == MD2_NORMAL_FORMAT_INDEX) ? MD2_NORMAL_FORMAT_INDEX : MD2_NORMAL_FORMAT_OCTAHEDRAL;
+	glBindVertexArray(m_keyframeVao);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+
+	glEnableVertexAttribArray(0); //Pos
+	glEnableVertexAttribArray(1); //Norm
+	glEnableVertexAttribArray(2); //Colour
+	glEnableVertexAttribArray(3); //Tex1
+	glEnableVertexAttribArray(4); //Next Pos
+	glEnableVertexAttribArray(5); //Next Norm
+	SetKeyframeAttributes(0, 0);
+
+	//Colour and UVs are the same in every frame so come from the static vbo
+	glBindBuffer(GL_ARRAY_BUFFER, m_staticVbo);
+	glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(MD2StaticVertex), ((char *)0) + MD2StaticVertex::ColourOffset);
+	glVertexAttribPointer(3, 2, GL_FLOAT, GL_TRUE, sizeof(MD2StaticVertex), ((char *)0) + MD2StaticVertex::TexCoord1Offset);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	//When the shader samples the animation textures only colour and UVs come
+	//from a buffer. The frames and offset of each instance are read from
+	//attributes 6 and 7, left disabled so one draw uses their current value
+	glBindVertexArray(m_animationTextureVao);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+
+	glEnableVertexAttribArray(2); //Colour
+	glEnableVertexAttribArray(3); //Tex1
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_staticVbo);
+	glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(MD2StaticVertex), ((char *)0) + MD2StaticVertex::ColourOffset);
+	glVertexAttribPointer(3, 2, GL_FLOAT, GL_TRUE, sizeof(MD2StaticVertex), ((char *)0) + MD2StaticVertex::TexCoord1Offset);
+
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	//The normal table is only needed to unpack normal indices and never
+	//changes so is only sent once
+	glUseProgram(m_program);
+	glUniform3fv(glGetUniformLocation(m_program, "NormalTable"), precalculated_normal_length, glm::value_ptr(precalculated_normals[0]));
+	glUseProgram(0);
+
 	// set the clear colour and enable depth testing and backface culling
 	glClearColor(0.25f, 0.25f, 0.25f, 1.f);
 	glEnable(GL_DEPTH_TEST);
@@ -144,24 +220,59 @@ void PathfindingApp::PreDraw()
 
 }
 
-void PathfindingApp::DrawModel(unsigned int a_numVerts)
+void PathfindingApp::DrawModel(unsigned int a_numIndices, const glm::mat4& a_modelMatrix)
 {
 	//bind our shader program
 	glUseProgram(m_program);
-	//bind our vertex array object
-	glBindVertexArray(m_vao);
+
+	//Tell the shader how normals are packed and if it is interpolating keyframes
+	int iNormalFormat = (m_eVertexLayout == MD2_VERTEX_LAYOUT_SPLIT) ? m_eNormalFormat : MD2_NORMAL_FORMAT_FLOAT;
+	if (m_eInterpolationMode == MD2_INTERPOLATION_GPU) {
+		//Only the offsets of the two frames and the interpolation are sent,
+		//the vertices never change
+		glBindVertexArray(m_keyframeVao);
+		SetKeyframeAttributes(m_iKeyframeCurrentFrame, m_iKeyframeNextFrame);
+		iNormalFormat = m_eKeyframeNormalFormat;
+		glUniform1f(glGetUniformLocation(m_program, "FrameInterp"), m_fKeyframeInterpolation);
+	}
+	else if (m_eInterpolationMode == MD2_INTERPOLATION_TEXTURE) {
+		//Every vertex is read from the animation textures, only the frames
+		//are sent. Normals are always held as indices in the texture
+		glBindVertexArray(m_animationTextureVao);
+		glVertexAttrib3f(6, (float)m_iKeyframeCurrentFrame, (float)m_iKeyframeNextFrame, m_fKeyframeInterpolation);
+		glVertexAttrib3f(7, 0.f, 0.f, 0.f);
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, m_animationPositionTexture);
+		glActiveTexture(GL_TEXTURE2);
+		glBindTexture(GL_TEXTURE_2D, m_animationNormalTexture);
+		glUniform1i(glGetUniformLocation(m_program, "PositionTexture"), 1);
+		glUniform1i(glGetUniformLocation(m_program, "NormalIndexTexture"), 2);
+	}
+	else {
+		//bind our vertex array object
+		glBindVertexArray(m_vao);
+	}
+	glUniform1i(glGetUniformLocation(m_program, "InterpolateFrames"), (m_eInterpolationMode == MD2_INTERPOLATION_GPU) ? 1 : 0);
+	glUniform1i(glGetUniformLocation(m_program, "SampleAnimationTextures"), (m_eInterpolationMode == MD2_INTERPOLATION_TEXTURE) ? 1 : 0);
+	glUniform1i(glGetUniformLocation(m_program, "NormalFormat"), iNormalFormat);
+
+	//The vertex data is in model space, place it in the world
+	unsigned int modelUniform = glGetUniformLocation(m_program, "Model");
+	glUniformMatrix4fv(modelUniform, 1, false, glm::value_ptr(a_modelMatrix));
 
 	// Bind the texture to one of the ActiveTextures
 	// if your shader supported multiple textures, you would bind each texture to a new Active Texture ID here
 	//bind our textureLocation variable from the shaders and set it's value to 0 as the active texture is texture 0
 	unsigned int texUniformID = glGetUniformLocation(m_program, "DiffuseTexture");
 	glUniform1i(texUniformID, 0);
+	unsigned int normalInterpUniform = glGetUniformLocation(m_program, "NormalInterp");
+	glUniform1f(normalInterpUniform, m_fNormalInterpolation);
 	//set our active texture, and bind our loaded texture
 	glActiveTexture(GL_TEXTURE0);
 	glBindTexture(GL_TEXTURE_2D, m_currTexID);
 
 
-	glDrawArrays(GL_TRIANGLES, 0, a_numVerts);
+	glDrawElements(GL_TRIANGLES, a_numIndices, GL_UNSIGNED_SHORT, 0);
 
 
 	glBindVertexArray(0);
@@ -178,16 +289,103 @@ void PathfindingApp::SetModelTextureID(unsigned int a_TextureID)
 	m_currTexID = a_TextureID;
 }
 
-void PathfindingApp::SetModelDrawData(unsigned int a_numVertices, unsigned int a_vertexSize, void* a_vertexData)
+void PathfindingApp::SetModelDrawData(unsigned int a_numVertices, unsigned int a_vertexSize, const void* a_vertexData)
 {
 	// OPENGL: Bind  VAO, and then bind the VBO and IBO to the VAO
 	glBindVertexArray(m_vao);
 	glBindBuffer(GL_ARRAY_BUFFER, m_vbo);
 	// Send the vertex data to the VBO
-	glBufferData(GL_ARRAY_BUFFER, a_numVertices * a_vertexSize, a_vertexData, GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, a_numVertices * a_vertexSize, a_vertexData, GL_STREAM_DRAW);
 
 	// finally, where done describing our mesh to the shader
 	// we can describe the next mesh
 	glBindVertexArray(0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void PathfindingApp::SetModelStaticDrawData(unsigned int a_numVertices, const MD2StaticVertex* a_vertexData)
+{
+	// OPENGL: The static vbo is read from by the split vertex layout and whenever
+	// the shader interpolates keyframes or samples the animation textures
+	glBindBuffer(GL_ARRAY_BUFFER, m_staticVbo);
+	// Send the vertex data to the static VBO, this only needs doing once
+	glBufferData(GL_ARRAY_BUFFER, a_numVertices * sizeof(MD2StaticVertex), a_vertexData, GL_STATIC_DRAW);
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void PathfindingApp::SetModelKeyframeData(unsigned int a_numVerticesPerFrame, unsigned int a_numFrames, const MD2PackedVertex* a_vertexData)
+{
+	// OPENGL: The keyframe vbo is only read from when the shader interpolates
+	glBindBuffer(GL_ARRAY_BUFFER, m_keyframeVbo);
+	// Send every keyframe to the keyframe VBO, this only needs doing once
+	glBufferData(GL_ARRAY_BUFFER, a_numVerticesPerFrame * a_numFrames * sizeof(MD2PackedVertex), a_vertexData, GL_STATIC_DRAW);
+	m_iNumKeyframeVerts = a_numVerticesPerFrame;
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+bool PathfindingApp::SetModelAnimationTextures(const MD2AnimationTexture& a_animationTexture)
+{
+	// OPENGL: A row for each frame and a column for each vertex has to fit in
+	// one texture
+	int maxTextureSize = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+	if (!a_animationTexture.IsBaked() || a_animationTexture.GetWidth() > (unsigned int)maxTextureSize || a_animationTexture.GetHeight() > (unsigned int)maxTextureSize) {
+		return false;
+	}
+
+	// Texels are only ever fetched whole so there is no filtering, rows of
+	// normal indices are not padded to 4 bytes
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	glGenTextures(1, &m_animationPositionTexture);
+	glBindTexture(GL_TEXTURE_2D, m_animationPositionTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, a_animationTexture.GetWidth(), a_animationTexture.GetHeight(), 0, GL_RGB, GL_FLOAT, a_animationTexture.GetPositionData());
+
+	glGenTextures(1, &m_animationNormalTexture);
+	glBindTexture(GL_TEXTURE_2D, m_animationNormalTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8UI, a_animationTexture.GetWidth(), a_animationTexture.GetHeight(), 0, GL_RED_INTEGER, GL_UNSIGNED_BYTE, a_animationTexture.GetNormalIndexData());
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	return true;
+}
+
+void PathfindingApp::SetKeyframeAttributes(unsigned int a_currentFrame, unsigned int a_nextFrame)
+{
+	// OPENGL: Point the position and normal attributes of the bound VAO at the
+	// start of each frame in the keyframe VBO
+	const size_t currentOffset = (size_t)a_currentFrame * m_iNumKeyframeVerts * sizeof(MD2PackedVertex);
+	const size_t nextOffset = (size_t)a_nextFrame * m_iNumKeyframeVerts * sizeof(MD2PackedVertex);
+	const GLenum normalType = (m_eKeyframeNormalFormat == MD2_NORMAL_FORMAT_INDEX) ? GL_UNSIGNED_BYTE : GL_SHORT;
+
+	glBindBuffer(GL_ARRAY_BUFFER, m_keyframeVbo);
+	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(MD2PackedVertex), ((char *)0) + currentOffset + MD2PackedVertex::PositionOffset);
+	glVertexAttribPointer(1, 2, normalType, GL_FALSE, sizeof(MD2PackedVertex), ((char *)0) + currentOffset + MD2PackedVertex::NormalOffset);
+	glVertexAttribPointer(4, 3, GL_FLOAT, GL_FALSE, sizeof(MD2PackedVertex), ((char *)0) + nextOffset + MD2PackedVertex::PositionOffset);
+	glVertexAttribPointer(5, 2, normalType, GL_FALSE, sizeof(MD2PackedVertex), ((char *)0) + nextOffset + MD2PackedVertex::NormalOffset);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void PathfindingApp::SetModelIndexData(unsigned int a_numIndices, const unsigned short* a_indexData)
+{
+	// OPENGL: Bind the VAO so that the IBO stays bound to it
+	glBindVertexArray(m_vao);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_ibo);
+	// Send the index data to the IBO
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, a_numIndices * sizeof(unsigned short), a_indexData, GL_STATIC_DRAW);
+
+	// unbind the VAO before the IBO so the VAO keeps its IBO binding
+	glBindVertexArray(0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
\ No newline at end of file